@@ -25,7 +25,7 @@ $build_system_modules[:gtest] = {
     gtest_libs = {
       'common'   => [],
       'propedit' => [ :mtxpropedit ],
-      'merge'    => [ :mtxmerge ],
+      'merge'    => [ :mtxmerge, :mpegparser ],
     }
 
     #
@@ -569,7 +569,12 @@ parser_c::decode_adts_header(unsigned char const *buffer,
       frame.m_header.parse_program_config_element(bc);
     bc.set_bit_position(data_start_position);
 
-    if (m_copy_data) {
+    if (m_copy_data && !m_fixed_buffer && !(data_start_position % 8))
+      // The payload is byte-aligned within the accumulation buffer and
+      // can therefore be referenced instead of being copied.
+      frame.m_data = m_buffer.slice(buffer - m_buffer.get_buffer() + data_start_position / 8, frame.m_header.data_byte_size);
+
+    else if (m_copy_data) {
       frame.m_data = memory_c::alloc(frame.m_header.data_byte_size);
       bc.get_bytes(frame.m_data->get_buffer(), frame.m_header.data_byte_size);
     }
@@ -330,7 +330,7 @@ parser_c::parse(bool end_of_stream) {
         m_frames.push_back(m_current_frame);
 
       m_current_frame        = frame;
-      m_current_frame.m_data = memory_c::clone(&buffer[position], frame.m_bytes);
+      m_current_frame.m_data = m_buffer.slice(position, frame.m_bytes);
 
     } else
       m_current_frame.add_dependent_frame(frame, &buffer[position], frame.m_bytes);
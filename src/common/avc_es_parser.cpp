@@ -167,7 +167,26 @@ es_parser_c::add_bytes(unsigned char *buffer,
 }
 
 void
-es_parser_c::flush() {
+es_parser_c::add_bytes_framed(memory_cptr const &buffer,
+                              size_t nalu_size_length) {
+  // The NALUs are prefixed with their size (e.g. from AVI or other
+  // framed containers). Hand slices of the frame to handle_nalu()
+  // directly instead of converting them to start code prefixed data
+  // that would have to be scanned again. Handlers that keep a NALU
+  // around copy it with memory_c::unslice().
+  flush_unparsed_nalu();
+
+  mtx::mpeg::for_each_framed_nalu(buffer, nalu_size_length, [this](memory_cptr const &nalu, uint64_t offset) {
+    m_parsed_position = m_stream_position + offset;
+    handle_nalu(nalu, m_parsed_position);
+  });
+
+  m_stream_position += buffer->get_size();
+  m_parsed_position  = m_stream_position;
+}
+
+void
+es_parser_c::flush_unparsed_nalu() {
   if (m_unparsed_buffer && (5 <= m_unparsed_buffer->get_size())) {
     m_parsed_position += m_unparsed_buffer->get_size();
     int marker_size = get_uint32_be(m_unparsed_buffer->get_buffer()) == NALU_START_CODE ? 4 : 3;
@@ -176,6 +195,12 @@ es_parser_c::flush() {
   }
 
   m_unparsed_buffer.reset();
+}
+
+void
+es_parser_c::flush() {
+  flush_unparsed_nalu();
+
   if (m_have_incomplete_frame) {
     m_frames.push_back(m_incomplete_frame);
     m_have_incomplete_frame = false;
@@ -266,7 +291,7 @@ void
 es_parser_c::handle_slice_nalu(memory_cptr const &nalu,
                                uint64_t nalu_pos) {
   if (!m_avcc_ready) {
-    m_unhandled_nalus.emplace_back(nalu, nalu_pos);
+    m_unhandled_nalus.emplace_back(memory_c::unslice(nalu), nalu_pos);
     return;
   }
 
@@ -417,7 +442,7 @@ es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
       break;
 
   if (m_pps_info_list.size() == i) {
-    m_pps_list.push_back(nalu);
+    m_pps_list.push_back(memory_c::unslice(nalu));
     m_pps_info_list.push_back(pps_info);
     m_avcc_changed = true;
 
@@ -428,7 +453,7 @@ es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
       cleanup();
 
     m_pps_info_list[i]       = pps_info;
-    m_pps_list[i]            = nalu;
+    m_pps_list[i]            = memory_c::unslice(nalu);
     m_avcc_changed           = true;
     m_sps_or_sps_overwritten = true;
   }
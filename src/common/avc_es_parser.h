@@ -155,6 +155,7 @@ public:
   void add_bytes(memory_cptr &buf) {
     add_bytes(buf->get_buffer(), buf->get_size());
   }
+  void add_bytes_framed(memory_cptr const &buffer, size_t nalu_size_length);
 
   void flush();
 
@@ -246,6 +247,7 @@ protected:
   bool flush_decision(slice_info_t &si, slice_info_t &ref);
   void flush_incomplete_frame();
   void flush_unhandled_nalus();
+  void flush_unparsed_nalu();
   void add_sps_and_pps_to_extra_data();
   memory_cptr create_nalu_with_size(const memory_cptr &src, bool add_extra_data = false);
   void remove_trailing_zero_bytes(memory_c &memory);
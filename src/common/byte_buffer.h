@@ -43,6 +43,8 @@ public:
   };
 
   void trim() {
+    unshare();
+
     if (m_offset == 0)
       return;
 
@@ -65,6 +67,7 @@ public:
       trim();
 
     if ((m_offset + m_filled + new_size) > m_size) {
+      unshare();
       m_size = ((m_offset + m_filled + new_size) / m_chunk_size + 1) * m_chunk_size;
       m_data->resize(m_size);
       count_alloc(m_size);
@@ -73,6 +76,7 @@ public:
     if (add_where == at_back)
       std::memcpy(m_data->get_buffer() + m_offset + m_filled, new_data, new_size);
     else {
+      unshare();
       auto target = m_data->get_buffer() + m_offset;
       std::memmove(target + new_size, target, m_filled);
       std::memcpy(target, new_data, new_size);
@@ -114,6 +118,15 @@ public:
     return m_data->get_buffer() + m_offset;
   }
 
+  // Returns a part of the current content without copying it. The
+  // buffer switches to new memory before modifying or moving data in
+  // memory still referenced by slices; therefore slices stay valid
+  // after the data has been removed from the buffer.
+  memory_cptr slice(std::size_t offset, std::size_t size) const {
+    assert((offset + size) <= m_filled);
+    return memory_c::slice(m_data, m_offset + offset, size);
+  }
+
   std::size_t get_size() const {
     return m_filled;
   }
@@ -125,6 +138,19 @@ public:
 
 private:
 
+  void unshare() {
+    if (m_data.use_count() == 1)
+      return;
+
+    auto new_data = memory_c::alloc(m_size);
+    std::memcpy(new_data->get_buffer(), m_data->get_buffer() + m_offset, m_filled);
+
+    m_data   = new_data;
+    m_offset = 0;
+
+    count_alloc(m_size);
+  }
+
   void count_alloc(size_t filled) {
     ++m_num_reallocs;
     m_max_alloced_size = std::max(m_max_alloced_size, filled);
@@ -118,7 +118,7 @@ read_args_from_json_file(std::vector<std::string> &args,
   }
 }
 
-static void
+void
 read_args_from_file(std::vector<std::string> &args,
                     std::string const &filename) {
   auto path = bfs::path{filename};
@@ -22,6 +22,7 @@ extern bool g_gui_mode;
 
 void display_usage(int exit_code = 0);
 std::vector<std::string> args_in_utf8(int argc, char **argv);
+void read_args_from_file(std::vector<std::string> &args, std::string const &filename);
 bool handle_common_args(std::vector<std::string> &args, const std::string &redirect_output_short);
 
 }}
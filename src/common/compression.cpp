@@ -45,9 +45,24 @@ compressor_c::~compressor_c() {
   if (0 == items)
     return;
 
+  int64_t raw = raw_size, compressed = compressed_size, num_items = items;
+
   mxverb(2,
          boost::format("compression: Overall stats: raw size: %1%, compressed size: %2%, items: %3%, ratio: %|4$.2f|%%, avg bytes per item: %5%\n")
-         % raw_size % compressed_size % items % (compressed_size * 100.0 / raw_size) % (compressed_size / items));
+         % raw % compressed % num_items % (compressed * 100.0 / raw) % (compressed / num_items));
+}
+
+memory_cptr
+compressor_c::compress(memory_cptr const &buffer) {
+  auto start  = std::chrono::steady_clock::now();
+  auto result = do_compress(buffer);
+
+  compression_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  raw_size            += buffer->get_size();
+  compressed_size     += result->get_size();
+  ++items;
+
+  return result;
 }
 
 void
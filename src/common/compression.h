@@ -15,6 +15,9 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
+#include <chrono>
+
 #include <matroska/KaxContentEncoding.h>
 
 /* compression types */
@@ -54,11 +57,12 @@ using compressor_ptr = std::shared_ptr<compressor_c>;
 class compressor_c {
 protected:
   compression_method_e method;
-  int64_t raw_size, compressed_size, items;
+  // Compression may be run from several threads at the same time.
+  std::atomic<int64_t> raw_size, compressed_size, items, compression_time_ns;
 
 public:
   compressor_c(compression_method_e n_method):
-    method(n_method), raw_size(0), compressed_size(0), items(0) {
+    method(n_method), raw_size(0), compressed_size(0), items(0), compression_time_ns(0) {
   };
 
   virtual ~compressor_c();
@@ -67,10 +71,33 @@ public:
     return method;
   }
 
+  int64_t get_raw_size() const {
+    return raw_size;
+  }
+
+  int64_t get_compressed_size() const {
+    return compressed_size;
+  }
+
+  int64_t get_num_items() const {
+    return items;
+  }
 
-  virtual memory_cptr compress(memory_cptr const &buffer) {
-    return do_compress(buffer);
+  int64_t get_compression_time_ns() const {
+    return compression_time_ns;
   }
+
+  // Compressors for which this returns true are safe to be called from
+  // several threads at the same time and expensive enough for running them
+  // in worker threads.
+  virtual bool is_parallelizable() const {
+    return false;
+  }
+
+  virtual void set_level(int /* level */) {
+  }
+
+  virtual memory_cptr compress(memory_cptr const &buffer);
   virtual std::string compress(std::string const &buffer);
 
   virtual memory_cptr decompress(memory_cptr const &buffer) {
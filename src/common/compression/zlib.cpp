@@ -62,37 +62,61 @@ zlib_compressor_c::do_decompress(memory_cptr const &buffer) {
 
 memory_cptr
 zlib_compressor_c::do_compress(memory_cptr const &buffer) {
-  z_stream c_stream;
+  // Initializing a deflate stream allocates several hundred KB. Each thread
+  // therefore keeps its own stream and only resets it between frames.
+  struct deflate_stream_t {
+    z_stream stream;
+    int level{-1};
 
-  c_stream.zalloc = (alloc_func)0;
-  c_stream.zfree  = (free_func)0;
-  c_stream.opaque = (voidpf)0;
-  int result      = deflateInit(&c_stream, 9);
+    ~deflate_stream_t() {
+      if (-1 != level)
+        deflateEnd(&stream);
+    }
+  };
 
-  if (Z_OK != result)
-    mxerror(boost::format(Y("deflateInit() failed. Result: %1%\n")) % result);
+  thread_local deflate_stream_t s_deflate;
 
-  c_stream.next_in   = (Bytef *)buffer->get_buffer();
-  c_stream.avail_in  = buffer->get_size();
-  int n              = 0;
-  memory_cptr dst    = memory_c::alloc(0);
+  auto &c_stream = s_deflate.stream;
+  auto result    = Z_OK;
 
-  do {
-    n++;
-    dst->resize(n * 4000);
-    c_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer() + (n - 1) * 4000);
-    c_stream.avail_out = 4000;
-    result             = deflate(&c_stream, Z_FINISH);
+  if (s_deflate.level != m_level) {
+    if (-1 != s_deflate.level)
+      deflateEnd(&c_stream);
 
-    if ((Z_OK != result) && (Z_STREAM_END != result))
-      mxerror(boost::format(Y("Zlib decompression failed. Result: %1%\n")) % result);
+    c_stream.zalloc = (alloc_func)0;
+    c_stream.zfree  = (free_func)0;
+    c_stream.opaque = (voidpf)0;
+    result          = deflateInit(&c_stream, m_level);
 
-  } while ((c_stream.avail_out == 0) && (result != Z_STREAM_END));
+    if (Z_OK != result) {
+      s_deflate.level = -1;
+      throw mtx::compression_x(boost::format(Y("deflateInit() failed. Result: %1%\n")) % result);
+    }
 
-  dst->resize(c_stream.total_out);
-  deflateEnd(&c_stream);
+    s_deflate.level = m_level;
 
-  mxverb(3, boost::format("zlib_compressor_c: Compression from %1% to %2%, %3%%%\n") % buffer->get_size() % dst->get_size() % (dst->get_size() * 100 / buffer->get_size()));
+  } else
+    deflateReset(&c_stream);
+
+  // deflateBound() is large enough for the whole output so that a single
+  // call to deflate() suffices.
+  auto dst           = memory_c::alloc(deflateBound(&c_stream, buffer->get_size()));
+
+  c_stream.next_in   = (Bytef *)buffer->get_buffer();
+  c_stream.avail_in  = buffer->get_size();
+  c_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer());
+  c_stream.avail_out = dst->get_size();
+  result             = deflate(&c_stream, Z_FINISH);
+
+  if (Z_STREAM_END != result)
+    throw mtx::compression_x(boost::format(Y("Zlib compression failed. Result: %1%\n")) % result);
+
+  dst->resize(c_stream.total_out);
 
   return dst;
 }
+
+void
+zlib_compressor_c::set_level(int level) {
+  m_level = level;
+}
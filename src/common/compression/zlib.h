@@ -20,10 +20,19 @@
 #include "common/compression.h"
 
 class zlib_compressor_c: public compressor_c {
+protected:
+  int m_level{Z_BEST_COMPRESSION};
+
 public:
   zlib_compressor_c();
   virtual ~zlib_compressor_c();
 
+  virtual bool is_parallelizable() const override {
+    return true;
+  }
+
+  virtual void set_level(int level) override;
+
 protected:
   virtual memory_cptr do_decompress(memory_cptr const &buffer);
   virtual memory_cptr do_compress(memory_cptr const &buffer);
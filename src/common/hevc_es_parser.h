@@ -145,6 +145,7 @@ public:
   void add_bytes(memory_cptr &buf) {
     add_bytes(buf->get_buffer(), buf->get_size());
   }
+  void add_bytes_framed(memory_cptr const &buffer, size_t nalu_size_length);
 
   void flush();
 
@@ -233,6 +234,7 @@ protected:
   void cleanup();
   void flush_incomplete_frame();
   void flush_unhandled_nalus();
+  void flush_unparsed_nalu();
   memory_cptr create_nalu_with_size(const memory_cptr &src, bool add_extra_data = false);
   std::vector<int64_t> calculate_provided_timestamps_to_use();
   void calculate_frame_order();
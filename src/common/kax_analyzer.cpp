@@ -350,6 +350,10 @@ kax_analyzer_c::process_internal() {
     delete l1;
     l1 = nullptr;
 
+    auto next_position = m_file->getFilePointer();
+    element_found(*m_data.back());
+    m_file->setFilePointer(next_position);
+
     aborted = !show_progress_running((int)(m_file->getFilePointer() * 100 / file_size));
 
     if (!in_parent(m_segment) || aborted || (cluster_found && meta_seek_found && !parse_fully))
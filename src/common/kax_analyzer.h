@@ -155,6 +155,11 @@ public:
   }
   virtual void show_progress_done() {
   }
+  // Called for each level 1 element found while scanning the
+  // segment. Implementations may read the element; the scan continues
+  // at the right position afterwards.
+  virtual void element_found(kax_analyzer_data_c const & /* data */) {
+  }
 
   virtual void log_debug_message(const std::string &message) {
     _log_debug_message(message);
@@ -0,0 +1,453 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   lightweight Matroska cluster parser
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxBlockData.h>
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxClusterData.h>
+
+#include "common/ebml.h"
+#include "common/kax_cluster_walker.h"
+#include "common/math.h"
+#include "common/mm_io_x.h"
+#include "common/vint.h"
+
+namespace {
+
+class invalid_structure_x: public mtx::exception {
+protected:
+  std::string m_message;
+
+public:
+  invalid_structure_x(std::string const &message)
+    : m_message{message}
+  {
+  }
+
+  virtual char const *what() const throw() {
+    return m_message.c_str();
+  }
+};
+
+}
+
+kax_cluster_walker_c::kax_cluster_walker_c(mm_io_c &in)
+  : m_in(in)
+  , m_timestamp_scale{TIMESTAMP_SCALE}
+  , m_segment_end{}
+  , m_cluster_timestamp{}
+  , m_num_bytes_skipped{}
+  , m_debug{"kax_cluster_walker"}
+{
+}
+
+void
+kax_cluster_walker_c::set_timestamp_scale(int64_t timestamp_scale) {
+  m_timestamp_scale = timestamp_scale;
+}
+
+void
+kax_cluster_walker_c::set_segment_end(uint64_t segment_end) {
+  m_segment_end = segment_end;
+}
+
+void
+kax_cluster_walker_c::set_track_filter(std::function<bool(uint64_t)> const &track_filter) {
+  m_track_filter = track_filter;
+}
+
+bool
+kax_cluster_walker_c::read_cluster() {
+  auto start_pos = m_in.getFilePointer();
+  auto end_limit = m_segment_end ? m_segment_end : static_cast<uint64_t>(m_in.get_size());
+
+  m_blocks.clear();
+
+  if (start_pos >= end_limit)
+    return false;
+
+  try {
+    auto id = vint_c::read_ebml_id(m_in);
+    if (!id.is_valid() || (id.m_value != EBML_ID_VALUE(EBML_ID(KaxCluster)))) {
+      m_in.setFilePointer(start_pos);
+      return false;
+    }
+
+    auto size = vint_c::read(m_in);
+    if (!size.is_valid() || size.is_unknown())
+      throw invalid_structure_x{"invalid or unknown cluster size"};
+
+    auto end_pos = m_in.getFilePointer() + size.m_value;
+    if (end_pos > end_limit)
+      throw invalid_structure_x{"cluster extends beyond the end of the segment"};
+
+    read_cluster_internal(end_pos);
+
+    m_in.setFilePointer(end_pos);
+
+    mxdebug_if(m_debug, boost::format("read cluster at %1% with timestamp %2% and %3% blocks; payload bytes skipped so far: %4%\n") % start_pos % m_cluster_timestamp % m_blocks.size() % m_num_bytes_skipped);
+
+    return true;
+
+  } catch (mtx::exception &ex) {
+    mxdebug_if(m_debug, boost::format("cannot handle cluster at %1%, leaving it to libebml: %2%\n") % start_pos % ex.what());
+
+  } catch (...) {
+    mxdebug_if(m_debug, boost::format("cannot handle cluster at %1%, leaving it to libebml\n") % start_pos);
+  }
+
+  m_blocks.clear();
+  m_in.setFilePointer(start_pos);
+
+  return false;
+}
+
+void
+kax_cluster_walker_c::read_cluster_internal(uint64_t end_pos) {
+  auto timestamp_found = false;
+
+  while (m_in.getFilePointer() < end_pos) {
+    uint32_t id{};
+    uint64_t size{};
+
+    read_element_head(end_pos, id, size);
+
+    auto element_end = m_in.getFilePointer() + size;
+
+    if (id == EBML_ID_VALUE(EBML_ID(KaxClusterTimecode))) {
+      m_cluster_timestamp = read_uint(size);
+      timestamp_found     = true;
+
+    } else if (   (id == EBML_ID_VALUE(EBML_ID(KaxSimpleBlock)))
+               || (id == EBML_ID_VALUE(EBML_ID(KaxBlockGroup)))) {
+      // Block timestamps are relative to the cluster's.
+      if (!timestamp_found)
+        throw invalid_structure_x{"block before the cluster timestamp"};
+
+      if (id == EBML_ID_VALUE(EBML_ID(KaxBlockGroup)))
+        read_block_group(element_end);
+
+      else {
+        block_t block;
+        block.m_simple_block = true;
+
+        read_block(element_end, block);
+        m_blocks.push_back(std::move(block));
+      }
+    }
+
+    m_in.setFilePointer(element_end);
+  }
+}
+
+void
+kax_cluster_walker_c::read_block_group(uint64_t end_pos) {
+  block_t block;
+  auto block_found = false;
+
+  while (m_in.getFilePointer() < end_pos) {
+    uint32_t id{};
+    uint64_t size{};
+
+    read_element_head(end_pos, id, size);
+
+    auto element_end = m_in.getFilePointer() + size;
+
+    if ((id == EBML_ID_VALUE(EBML_ID(KaxBlock))) && !block_found) {
+      block_found = true;
+
+      // None of the other children are needed if the payload is
+      // skipped. The caller continues after the group.
+      if (!read_block(element_end, block))
+        break;
+
+    } else if ((id == EBML_ID_VALUE(EBML_ID(KaxBlockDuration))) && !block.m_duration)
+      block.m_duration = read_uint(size);
+
+    else if (id == EBML_ID_VALUE(EBML_ID(KaxReferenceBlock)))
+      block.m_references.push_back(read_int(size));
+
+    else if ((id == EBML_ID_VALUE(EBML_ID(KaxCodecState))) && !block.m_codec_state)
+      block.m_codec_state = read_data(size);
+
+    else if ((id == EBML_ID_VALUE(EBML_ID(KaxDiscardPadding))) && !block.m_discard_padding)
+      block.m_discard_padding = read_int(size);
+
+    else if (id == EBML_ID_VALUE(EBML_ID(KaxBlockAdditions)))
+      read_block_additions(element_end, block);
+
+    m_in.setFilePointer(element_end);
+  }
+
+  if (block_found)
+    m_blocks.push_back(std::move(block));
+}
+
+void
+kax_cluster_walker_c::read_block_additions(uint64_t end_pos,
+                                           block_t &block) {
+  while (m_in.getFilePointer() < end_pos) {
+    uint32_t id{};
+    uint64_t size{};
+
+    read_element_head(end_pos, id, size);
+
+    auto more_end = m_in.getFilePointer() + size;
+
+    if (id == EBML_ID_VALUE(EBML_ID(KaxBlockMore))) {
+      memory_cptr additional;
+
+      while (m_in.getFilePointer() < more_end) {
+        read_element_head(more_end, id, size);
+
+        auto element_end = m_in.getFilePointer() + size;
+
+        if ((id == EBML_ID_VALUE(EBML_ID(KaxBlockAdditional))) && !additional)
+          additional = read_data(size);
+
+        m_in.setFilePointer(element_end);
+      }
+
+      // libmatroska's GetChild() would create an empty one.
+      block.m_additions.push_back(additional ? additional : memory_c::alloc(0));
+    }
+
+    m_in.setFilePointer(more_end);
+  }
+}
+
+bool
+kax_cluster_walker_c::read_block(uint64_t end_pos,
+                                 block_t &block) {
+  auto track_number = vint_c::read(m_in);
+  if (!track_number.is_valid() || ((m_in.getFilePointer() + 3) > end_pos))
+    throw invalid_structure_x{"invalid block header"};
+
+  auto relative_timestamp = static_cast<int16_t>(m_in.read_uint16_be());
+  auto flags              = m_in.read_uint8();
+
+  block.m_track_number = track_number.m_value;
+  block.m_timestamp    = (static_cast<int64_t>(m_cluster_timestamp) + relative_timestamp) * m_timestamp_scale;
+
+  if (block.m_simple_block) {
+    block.m_key         = (flags & 0x80) == 0x80;
+    block.m_discardable = (flags & 0x01) == 0x01;
+  }
+
+  if (m_track_filter && !m_track_filter(block.m_track_number)) {
+    m_num_bytes_skipped     += end_pos - m_in.getFilePointer();
+    block.m_payload_skipped  = true;
+    m_in.setFilePointer(end_pos);
+
+    return false;
+  }
+
+  std::vector<uint64_t> frame_sizes;
+  auto lacing = (flags >> 1) & 0x03;
+
+  if (!lacing)
+    frame_sizes.push_back(end_pos - m_in.getFilePointer());
+  else
+    read_laced_frame_sizes(end_pos, lacing, frame_sizes);
+
+  for (auto frame_size : frame_sizes)
+    block.m_frames.push_back(read_data(frame_size));
+
+  return true;
+}
+
+void
+kax_cluster_walker_c::read_laced_frame_sizes(uint64_t end_pos,
+                                             unsigned int lacing,
+                                             std::vector<uint64_t> &frame_sizes) {
+  auto num_frames = m_in.read_uint8() + 1u;
+  auto total_size = uint64_t{};
+
+  if (2 == lacing) {            // fixed-size lacing
+    auto remaining = end_pos - m_in.getFilePointer();
+    if ((remaining % num_frames) != 0)
+      throw invalid_structure_x{"invalid fixed-size lacing"};
+
+    frame_sizes.resize(num_frames, remaining / num_frames);
+    return;
+  }
+
+  if (1 == lacing) {            // Xiph lacing
+    for (auto idx = 1u; idx < num_frames; ++idx) {
+      auto frame_size = uint64_t{};
+      auto byte       = 255u;
+
+      while (255 == byte) {
+        byte        = m_in.read_uint8();
+        frame_size += byte;
+      }
+
+      frame_sizes.push_back(frame_size);
+      total_size += frame_size;
+    }
+
+  } else {                      // EBML lacing
+    auto frame_size = int64_t{};
+
+    for (auto idx = 1u; idx < num_frames; ++idx) {
+      auto value = vint_c::read(m_in);
+      if (!value.is_valid())
+        throw invalid_structure_x{"invalid EBML lacing"};
+
+      // All sizes but the first one are stored as signed differences
+      // to the previous one.
+      if (1 == idx)
+        frame_size = value.m_value;
+      else
+        frame_size += value.m_value - ((int64_t{1} << (7 * value.m_coded_size - 1)) - 1);
+
+      if (0 > frame_size)
+        throw invalid_structure_x{"invalid EBML lacing"};
+
+      frame_sizes.push_back(frame_size);
+      total_size += frame_size;
+    }
+  }
+
+  auto position = m_in.getFilePointer();
+  if ((position > end_pos) || (total_size > (end_pos - position)))
+    throw invalid_structure_x{"lace sizes exceed the block size"};
+
+  frame_sizes.push_back(end_pos - position - total_size);
+}
+
+void
+kax_cluster_walker_c::read_element_head(uint64_t end_pos,
+                                        uint32_t &id,
+                                        uint64_t &size) {
+  auto id_vint   = vint_c::read_ebml_id(m_in);
+  auto size_vint = vint_c::read(m_in);
+
+  if (!id_vint.is_valid() || !size_vint.is_valid() || size_vint.is_unknown())
+    throw invalid_structure_x{"invalid element header"};
+
+  if ((m_in.getFilePointer() + size_vint.m_value) > end_pos)
+    throw invalid_structure_x{"element extends beyond its parent"};
+
+  id   = id_vint.m_value;
+  size = size_vint.m_value;
+}
+
+uint64_t
+kax_cluster_walker_c::read_uint(uint64_t size) {
+  if (8 < size)
+    throw invalid_structure_x{"integer too large"};
+
+  auto value = uint64_t{};
+  for (auto idx = 0u; idx < size; ++idx)
+    value = (value << 8) | m_in.read_uint8();
+
+  return value;
+}
+
+int64_t
+kax_cluster_walker_c::read_int(uint64_t size) {
+  auto value = read_uint(size);
+
+  if ((0 < size) && (8 > size) && (value & (uint64_t{1} << (size * 8 - 1))))
+    return static_cast<int64_t>(value) - (int64_t{1} << (size * 8));
+
+  return static_cast<int64_t>(value);
+}
+
+memory_cptr
+kax_cluster_walker_c::read_data(uint64_t size) {
+  auto data = memory_c::alloc(size);
+
+  if (m_in.read(data->get_buffer(), size) != size)
+    throw mtx::mm_io::end_of_file_x{};
+
+  return data;
+}
+
+void
+kax_cluster_walker_c::use_cluster(KaxCluster &cluster) {
+  m_blocks.clear();
+
+  m_cluster_timestamp = FindChildValue<KaxClusterTimecode>(cluster);
+  cluster.InitTimecode(m_cluster_timestamp, m_timestamp_scale);
+
+  // The frame buffers aren't copied. They're only valid as long as the
+  // cluster exists.
+  auto add_frames = [](KaxInternalBlock &kblock, block_t &block) {
+    for (auto idx = 0u, num_frames = kblock.NumberFrames(); idx < num_frames; ++idx) {
+      auto &data_buffer = kblock.GetBuffer(idx);
+      block.m_frames.push_back(std::make_shared<memory_c>(data_buffer.Buffer(), data_buffer.Size(), false));
+    }
+  };
+
+  for (auto element : cluster) {
+    block_t block;
+
+    if (Is<KaxSimpleBlock>(element)) {
+      auto simple_block = static_cast<KaxSimpleBlock *>(element);
+      simple_block->SetParent(cluster);
+
+      block.m_simple_block = true;
+      block.m_track_number = simple_block->TrackNum();
+      block.m_timestamp    = mtx::math::to_signed(simple_block->GlobalTimecode());
+      block.m_key          = simple_block->IsKeyframe();
+      block.m_discardable  = simple_block->IsDiscardable();
+
+      add_frames(*simple_block, block);
+
+    } else if (Is<KaxBlockGroup>(element)) {
+      auto block_group = static_cast<KaxBlockGroup *>(element);
+      auto kblock      = FindChild<KaxBlock>(block_group);
+      if (!kblock)
+        continue;
+
+      kblock->SetParent(cluster);
+
+      block.m_track_number = kblock->TrackNum();
+      block.m_timestamp    = mtx::math::to_signed(kblock->GlobalTimecode());
+
+      add_frames(*kblock, block);
+
+      for (auto child : *block_group) {
+        if (Is<KaxBlockDuration>(child) && !block.m_duration)
+          block.m_duration = static_cast<KaxBlockDuration *>(child)->GetValue();
+
+        else if (Is<KaxReferenceBlock>(child))
+          block.m_references.push_back(static_cast<KaxReferenceBlock *>(child)->GetValue());
+
+        else if (Is<KaxCodecState>(child) && !block.m_codec_state)
+          block.m_codec_state = memory_c::clone(static_cast<KaxCodecState *>(child)->GetBuffer(), static_cast<KaxCodecState *>(child)->GetSize());
+
+        else if (Is<KaxDiscardPadding>(child) && !block.m_discard_padding)
+          block.m_discard_padding = static_cast<KaxDiscardPadding *>(child)->GetValue();
+
+        else if (Is<KaxBlockAdditions>(child)) {
+          for (auto more : *static_cast<KaxBlockAdditions *>(child)) {
+            if (!Is<KaxBlockMore>(more))
+              continue;
+
+            auto additional = &GetChild<KaxBlockAdditional>(*static_cast<KaxBlockMore *>(more));
+            block.m_additions.push_back(std::make_shared<memory_c>(additional->GetBuffer(), additional->GetSize(), false));
+          }
+        }
+      }
+
+    } else
+      continue;
+
+    m_blocks.push_back(std::move(block));
+  }
+}
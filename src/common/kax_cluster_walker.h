@@ -0,0 +1,101 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   lightweight Matroska cluster parser
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxCluster.h>
+
+using namespace libebml;
+using namespace libmatroska;
+
+// Reads clusters directly from the file without having libebml build an
+// object tree for them. Only the elements needed for multiplexing are
+// decoded: the cluster timestamp, SimpleBlocks and BlockGroups with their
+// Block, BlockDuration, ReferenceBlock, CodecState, DiscardPadding and
+// BlockAdditions children. Everything else is skipped.
+//
+// Clusters the walker cannot handle (unknown size, damaged structure,
+// missing timestamp) are left to libebml: read_cluster() returns false
+// and restores the file position. Clusters read by libebml can be
+// converted with use_cluster() so that callers only have to deal with a
+// single representation.
+//
+// A track filter can be set in order to skip the payloads of blocks
+// belonging to tracks the caller isn't interested in. Their headers are
+// still decoded, but the frame data is skipped by seeking past it instead
+// of reading it.
+class kax_cluster_walker_c {
+public:
+  struct block_t {
+    uint64_t m_track_number{};
+    int64_t m_timestamp{};      // in ns
+    bool m_simple_block{}, m_key{}, m_discardable{}, m_payload_skipped{};
+    std::vector<memory_cptr> m_frames; // empty if m_payload_skipped is set
+
+    // Only set for BlockGroups. Durations and references are stored
+    // as they are in the file, not scaled.
+    boost::optional<uint64_t> m_duration;
+    std::vector<int64_t> m_references;
+    memory_cptr m_codec_state;
+    boost::optional<int64_t> m_discard_padding;
+    std::vector<memory_cptr> m_additions;
+  };
+
+protected:
+  mm_io_c &m_in;
+  int64_t m_timestamp_scale;
+  uint64_t m_segment_end, m_cluster_timestamp;
+  std::vector<block_t> m_blocks;
+  std::function<bool(uint64_t)> m_track_filter;
+  uint64_t m_num_bytes_skipped;
+
+  debugging_option_c m_debug;
+
+public:
+  kax_cluster_walker_c(mm_io_c &in);
+
+  void set_timestamp_scale(int64_t timestamp_scale);
+  void set_segment_end(uint64_t segment_end);
+  void set_track_filter(std::function<bool(uint64_t)> const &track_filter);
+
+  // Reads the cluster starting at the current file position.
+  bool read_cluster();
+  void use_cluster(KaxCluster &cluster);
+
+  uint64_t get_cluster_timestamp() const {
+    return m_cluster_timestamp;
+  }
+
+  std::vector<block_t> &get_blocks() {
+    return m_blocks;
+  }
+
+  uint64_t get_num_bytes_skipped() const {
+    return m_num_bytes_skipped;
+  }
+
+protected:
+  void read_cluster_internal(uint64_t end_pos);
+  void read_block_group(uint64_t end_pos);
+  void read_block_additions(uint64_t end_pos, block_t &block);
+  bool read_block(uint64_t end_pos, block_t &block);
+  void read_laced_frame_sizes(uint64_t end_pos, unsigned int lacing, std::vector<uint64_t> &frame_sizes);
+
+  void read_element_head(uint64_t end_pos, uint32_t &id, uint64_t &size);
+  uint64_t read_uint(uint64_t size);
+  int64_t read_int(uint64_t size);
+  memory_cptr read_data(uint64_t size);
+};
+using kax_cluster_walker_cptr = std::shared_ptr<kax_cluster_walker_c>;
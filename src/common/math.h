@@ -31,6 +31,13 @@ count_1_bits(uint64_t value) {
 }
 
 uint64_t round_to_nearest_pow2(uint64_t value);
+
+inline uint64_t
+round_up(uint64_t value,
+         uint64_t multiple) {
+  return ((value + multiple - 1) / multiple) * multiple;
+}
+
 int int_log2(uint64_t value);
 double int_to_double(int64_t value);
 
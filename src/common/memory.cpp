@@ -36,6 +36,7 @@ memory_c::resize(size_t new_size)
     its_counter->ptr     = tmp;
     its_counter->is_free = true;
     its_counter->size    = new_size;
+    its_counter->parent.reset();
   }
 }
 
@@ -147,8 +147,12 @@ public:
     return its_counter && its_counter->is_free;
   }
 
+  bool is_slice() const {
+    return its_counter && its_counter->parent;
+  }
+
   void grab() {
-    if (!its_counter || its_counter->is_free)
+    if (!its_counter || its_counter->is_free || its_counter->parent)
       return;
 
     its_counter->ptr      = static_cast<unsigned char *>(safememdup(get_buffer(), get_size()));
@@ -196,6 +200,34 @@ public:
     return std::make_shared<memory_c>(reinterpret_cast<unsigned char *>(&buffer[0]), buffer.length(), false);
   }
 
+  // Returns an object referencing a part of another buffer without
+  // copying it. The other buffer is kept alive for as long as the slice
+  // exists. Resizing the slice turns it into a regular, independent
+  // buffer. A buffer that doesn't own its memory has to take ownership
+  // first as its memory might be re-used by its owner.
+  static memory_cptr
+  slice(memory_cptr const &buffer,
+        size_t offset,
+        size_t size) {
+    assert(buffer && ((offset + size) <= buffer->get_size()));
+
+    buffer->grab();
+
+    auto mem = std::make_shared<memory_c>(buffer->get_buffer() + offset, size, false);
+    if (mem->its_counter)
+      mem->its_counter->parent = buffer;
+
+    return mem;
+  }
+
+  // Returns a buffer that doesn't keep another one alive: a copy for
+  // slices, the buffer itself otherwise. Use it before storing data
+  // that might have been sliced from a much larger buffer.
+  static memory_cptr
+  unslice(memory_cptr const &buffer) {
+    return buffer && buffer->is_slice() ? buffer->clone() : buffer;
+  }
+
 private:
   struct counter {
     unsigned char *ptr;
@@ -203,6 +235,7 @@ private:
     bool is_free;
     unsigned count;
     size_t offset;
+    memory_cptr parent;         // only set for slices
 
     counter(unsigned char *p = nullptr,
             size_t s = 0,
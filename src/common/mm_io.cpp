@@ -22,6 +22,12 @@
 #endif
 #include <sys/stat.h>
 #include <sys/types.h>
+#if defined(HAVE_FALLOCATE) || defined(HAVE_COPY_FILE_RANGE) || defined(HAVE_POSIX_FADVISE) || defined(HAVE_SYNC_FILE_RANGE)
+# include <fcntl.h>
+#endif
+#if defined(HAVE_LINUX_FALLOC_H)
+# include <linux/falloc.h>
+#endif
 
 #include "common/endian.h"
 #include "common/error.h"
@@ -36,6 +42,8 @@ union double_to_uint64_t {
   double d;
 };
 
+std::atomic<uint64_t> mm_file_io_c::ms_num_bytes_read{}, mm_file_io_c::ms_num_bytes_written{};
+
 #if !defined(SYS_WINDOWS)
 mm_file_io_c::mm_file_io_c(const std::string &path,
                            const open_mode mode)
@@ -95,8 +103,9 @@ mm_file_io_c::_write(const void *buffer,
   if (ferror((FILE *)m_file) != 0)
     throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
 
-  m_current_position += bwritten;
-  m_cached_size       = -1;
+  m_current_position   += bwritten;
+  m_cached_size         = -1;
+  ms_num_bytes_written += bwritten;
 
   return bwritten;
 }
@@ -107,16 +116,29 @@ mm_file_io_c::_read(void *buffer,
   int64_t bread = fread(buffer, 1, size, (FILE *)m_file);
 
   m_current_position += bread;
+  ms_num_bytes_read  += bread;
 
   return bread;
 }
 
 void
 mm_file_io_c::close() {
-  if (m_file) {
-    fclose((FILE *)m_file);
-    m_file = nullptr;
+  if (!m_file)
+    return;
+
+  if (m_preallocated) {
+    // Space reserved beyond the end of the file isn't freed
+    // automatically. Truncating to the current size releases it.
+    struct stat st;
+
+    fflush((FILE *)m_file);
+    if (fstat(fileno((FILE *)m_file), &st) == 0)
+      truncate(st.st_size);
   }
+
+  fclose((FILE *)m_file);
+  m_file         = nullptr;
+  m_preallocated = false;
 }
 
 bool
@@ -137,6 +159,118 @@ mm_file_io_c::truncate(int64_t pos) {
 
 /** \brief OS and kernel dependant setup
 */
+uint64_t
+mm_file_io_c::get_block_size() {
+  struct stat st;
+
+  if (fstat(fileno((FILE *)m_file), &st) != 0)
+    return 0;
+
+  return st.st_blksize;
+}
+
+bool
+mm_file_io_c::insert_range(uint64_t offset,
+                           uint64_t length) {
+#if defined(HAVE_FALLOCATE) && defined(FALLOC_FL_INSERT_RANGE)
+  auto position = getFilePointer();
+
+  fflush((FILE *)m_file);
+
+  if (fallocate(fileno((FILE *)m_file), FALLOC_FL_INSERT_RANGE, offset, length) != 0)
+    return false;
+
+  m_cached_size = -1;
+  setFilePointer(position);
+
+  return true;
+
+#else
+  (void)offset;
+  (void)length;
+
+  return false;
+#endif
+}
+
+bool
+mm_file_io_c::copy_range(uint64_t src_offset,
+                         uint64_t dst_offset,
+                         uint64_t length) {
+#if defined(HAVE_COPY_FILE_RANGE)
+  auto position = getFilePointer();
+  auto fd       = fileno((FILE *)m_file);
+  auto src      = static_cast<loff_t>(src_offset);
+  auto dst      = static_cast<loff_t>(dst_offset);
+
+  fflush((FILE *)m_file);
+
+  while (length) {
+    auto num_copied = copy_file_range(fd, &src, fd, &dst, length, 0);
+    if (num_copied <= 0)
+      return false;
+
+    length -= num_copied;
+  }
+
+  m_cached_size = -1;
+  setFilePointer(position);
+
+  return true;
+
+#else
+  (void)src_offset;
+  (void)dst_offset;
+  (void)length;
+
+  return false;
+#endif
+}
+
+bool
+mm_file_io_c::preallocate(uint64_t size) {
+#if defined(HAVE_FALLOCATE) && defined(FALLOC_FL_KEEP_SIZE)
+  if (fallocate(fileno((FILE *)m_file), FALLOC_FL_KEEP_SIZE, 0, size) != 0)
+    return false;
+
+  m_preallocated = true;
+
+  return true;
+
+#else
+  (void)size;
+
+  return false;
+#endif
+}
+
+bool
+mm_file_io_c::drop_cached_data(uint64_t offset,
+                               uint64_t length) {
+#if defined(HAVE_POSIX_FADVISE)
+  auto fd = fileno((FILE *)m_file);
+
+  fflush((FILE *)m_file);
+
+  // Only clean pages can be evicted; they have to be written first.
+# if defined(HAVE_SYNC_FILE_RANGE)
+  if (sync_file_range(fd, offset, length, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER) != 0)
+    return false;
+# else
+  if (fdatasync(fd) != 0)
+    return false;
+# endif
+
+  return posix_fadvise(fd, offset, length, POSIX_FADV_DONTNEED) == 0;
+
+#else
+  (void)offset;
+  (void)length;
+
+  return false;
+#endif
+}
+
 void
 mm_file_io_c::setup() {
 }
@@ -200,6 +334,102 @@ mm_file_io_c::open(const std::string &path,
   return mm_io_cptr(new mm_file_io_c(path, mode));
 }
 
+/*
+   Read-only file whose handle can be released in between accesses.
+*/
+
+mm_on_demand_file_io_c::mm_on_demand_file_io_c(std::string const &file_name)
+  : m_file_name{file_name}
+  , m_file{new mm_file_io_c{file_name}}
+  , m_pos{}
+  , m_size{static_cast<int64_t>(m_file->get_size())}
+  , m_eof{}
+{
+}
+
+mm_on_demand_file_io_c::~mm_on_demand_file_io_c() {
+  close();
+}
+
+mm_file_io_c &
+mm_on_demand_file_io_c::file() {
+  if (!m_file) {
+    m_file.reset(new mm_file_io_c{m_file_name});
+    m_file->setFilePointer(m_pos);
+  }
+
+  return *m_file;
+}
+
+uint64
+mm_on_demand_file_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_on_demand_file_io_c::setFilePointer(int64 offset,
+                                       seek_mode mode) {
+  auto new_pos = seek_beginning == mode ? offset
+               : seek_end       == mode ? m_size + offset
+               :                          m_pos  + offset;
+
+  if (0 > new_pos)
+    throw mtx::mm_io::seek_x{};
+
+  // Seeking alone doesn't require the file to be open.
+  if (m_file)
+    m_file->setFilePointer(new_pos);
+
+  m_pos = new_pos;
+  m_eof = false;
+}
+
+uint32
+mm_on_demand_file_io_c::_read(void *buffer,
+                              size_t size) {
+  auto num_read = file().read(buffer, size);
+
+  m_pos += num_read;
+  if (num_read < size)
+    m_eof = true;
+
+  return num_read;
+}
+
+size_t
+mm_on_demand_file_io_c::_write(const void *,
+                               size_t) {
+  throw mtx::mm_io::wrong_read_write_access_x();
+  return 0;
+}
+
+void
+mm_on_demand_file_io_c::close() {
+  m_file.reset();
+}
+
+bool
+mm_on_demand_file_io_c::eof() {
+  return m_eof;
+}
+
+void
+mm_on_demand_file_io_c::clear_eof() {
+  m_eof = false;
+  if (m_file)
+    m_file->clear_eof();
+}
+
+int64_t
+mm_on_demand_file_io_c::get_size() {
+  return m_size;
+}
+
+void
+mm_on_demand_file_io_c::release_file_handle() {
+  m_file.reset();
+}
+
 /*
    Abstract base class.
 */
@@ -895,6 +1125,9 @@ mm_text_io_c::mm_text_io_c(mm_io_c *in,
   , m_uses_carriage_returns(false)
   , m_uses_newlines(false)
   , m_eol_style_detected(false)
+  , m_eof(false)
+  , m_read_buffer_pos(0)
+  , m_read_buffer_fill(0)
 {
   in->setFilePointer(0, seek_beginning);
 
@@ -910,6 +1143,18 @@ mm_text_io_c::mm_text_io_c(mm_io_c *in,
   in->setFilePointer(m_bom_len, seek_beginning);
 }
 
+mm_text_io_c::~mm_text_io_c() {
+  // Leave a shared proxied I/O at the position the caller expects
+  // instead of after the data read ahead.
+  if (!m_proxy_io || m_proxy_delete_io)
+    return;
+
+  try {
+    drop_read_buffer();
+  } catch (...) {
+  }
+}
+
 void
 mm_text_io_c::detect_eol_style() {
   if (m_eol_style_detected)
@@ -1001,33 +1246,49 @@ mm_text_io_c::get_encoding(byte_order_e byte_order) {
 // 1 byte: 0xxxxxxx,
 // 2 bytes: 110xxxxx 10xxxxxx,
 // 3 bytes: 1110xxxx 10xxxxxx 10xxxxxx
+// 4 bytes: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+
+static std::size_t
+utf8_char_size(unsigned char lead_byte) {
+  return ((lead_byte & 0x80) == 0x00) ?  1
+       : ((lead_byte & 0xe0) == 0xc0) ?  2
+       : ((lead_byte & 0xf0) == 0xe0) ?  3
+       : ((lead_byte & 0xf8) == 0xf0) ?  4
+       : ((lead_byte & 0xfc) == 0xf8) ?  5
+       : ((lead_byte & 0xfe) == 0xfc) ?  6
+       :                                99;
+}
 
 int
 mm_text_io_c::read_next_char(char *buffer) {
+  std::size_t raw_size;
+  return decode_next_char(buffer, raw_size);
+}
+
+int
+mm_text_io_c::decode_next_char(char *buffer,
+                               std::size_t &raw_size) {
+  raw_size = 1;
+
   if (BO_NONE == m_byte_order)
-    return read(buffer, 1);
+    return mm_text_io_c::_read(buffer, 1);
 
   unsigned char stream[6];
   size_t size = 0;
   if (BO_UTF8 == m_byte_order) {
-    if (read(stream, 1) != 1)
+    if (mm_text_io_c::_read(stream, 1) != 1)
       return 0;
 
-    size = ((stream[0] & 0x80) == 0x00) ?  1
-         : ((stream[0] & 0xe0) == 0xc0) ?  2
-         : ((stream[0] & 0xf0) == 0xe0) ?  3
-         : ((stream[0] & 0xf8) == 0xf0) ?  4
-         : ((stream[0] & 0xfc) == 0xf8) ?  5
-         : ((stream[0] & 0xfe) == 0xfc) ?  6
-         :                                99;
+    size = utf8_char_size(stream[0]);
 
     if (99 == size)
       throw mtx::mm_io::text::invalid_utf8_char_x(stream[0]);
 
-    if ((1 < size) && (read(&stream[1], size - 1) != (size - 1)))
+    if ((1 < size) && (mm_text_io_c::_read(&stream[1], size - 1) != (size - 1)))
       return 0;
 
     memcpy(buffer, stream, size);
+    raw_size = size;
 
     return size;
 
@@ -1036,15 +1297,38 @@ mm_text_io_c::read_next_char(char *buffer) {
   else
     size = 4;
 
-  if (read(stream, size) != size)
+  auto little_endian = ((BO_UTF16_LE == m_byte_order) || (BO_UTF32_LE == m_byte_order));
+  auto read_unit     = [this, size, little_endian, &stream]() -> boost::optional<unsigned long> {
+    if (mm_text_io_c::_read(stream, size) != size)
+      return boost::none;
+
+    unsigned long data = 0;
+    auto shift         = little_endian ? 0 : 8 * (size - 1);
+    for (auto i = 0u; i < size; i++) {
+      data  |= static_cast<unsigned long>(stream[i]) << shift;
+      shift += little_endian ? 8 : -8;
+    }
+
+    return data;
+  };
+
+  auto unit = read_unit();
+  if (!unit)
     return 0;
 
-  unsigned long data = 0;
-  auto little_endian = ((BO_UTF16_LE == m_byte_order) || (BO_UTF32_LE == m_byte_order));
-  auto shift         = little_endian ? 0 : 8 * (size - 1);
-  for (auto i = 0u; i < size; i++) {
-    data  |= static_cast<unsigned long>(stream[i]) << shift;
-    shift += little_endian ? 8 : -8;
+  unsigned long data = *unit;
+  raw_size           = size;
+
+  // UTF-16 surrogate pairs
+  if ((2 == size) && (0xd800 <= data) && (0xdc00 > data)) {
+    auto low_surrogate = read_unit();
+
+    if (low_surrogate && (0xdc00 <= *low_surrogate) && (0xe000 > *low_surrogate)) {
+      data     = 0x10000 + ((data - 0xd800) << 10) + (*low_surrogate - 0xdc00);
+      raw_size = 4;
+
+    } else if (low_surrogate)
+      unread(size);
   }
 
   if (data < 0x80) {
@@ -1058,6 +1342,9 @@ mm_text_io_c::read_next_char(char *buffer) {
     return 2;
   }
 
+  if (data >= 0x110000)
+    data = 0xfffd;              // Unicode replacement character
+
   if (data < 0x10000) {
     buffer[0] = 0xe0 |  (data >> 12);
     buffer[1] = 0x80 | ((data >> 6) & 0x3f);
@@ -1065,9 +1352,11 @@ mm_text_io_c::read_next_char(char *buffer) {
     return 3;
   }
 
-  mxerror(Y("mm_text_io_c: UTF32_* is not supported at the moment.\n"));
-
-  return 0;
+  buffer[0] = 0xf0 |  (data >> 18);
+  buffer[1] = 0x80 | ((data >> 12) & 0x3f);
+  buffer[2] = 0x80 | ((data >>  6) & 0x3f);
+  buffer[3] = 0x80 |  (data        & 0x3f);
+  return 4;
 }
 
 std::string
@@ -1075,25 +1364,133 @@ mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
   if (eof())
     throw mtx::mm_io::end_of_file_x{mtx::mm_io::make_error_code()};
 
+  std::string s;
+  read_line(s, max_chars);
+
+  return s;
+}
+
+bool
+mm_text_io_c::getline2(std::string &s,
+                       boost::optional<std::size_t> max_chars) {
+  // Re-using the caller's string avoids an allocation per line.
+  s.clear();
+
+  if (eof())
+    return false;
+
+  try {
+    read_line(s, max_chars);
+  } catch (...) {
+    return false;
+  }
+
+  return true;
+}
+
+void
+mm_text_io_c::read_line(std::string &s,
+                        boost::optional<std::size_t> max_chars) {
   if (!m_eol_style_detected)
     detect_eol_style();
 
-  std::string s;
+  if ((BO_NONE == m_byte_order) || (BO_UTF8 == m_byte_order))
+    read_line_utf8(s, max_chars);
+  else
+    read_line_unicode(s, max_chars);
+}
+
+void
+mm_text_io_c::read_line_utf8(std::string &s,
+                             boost::optional<std::size_t> max_chars) {
+  // The data can be used without decoding. Only the line endings
+  // have to be found, and whole runs of bytes between them are
+  // appended at once.
+  bool previous_was_carriage_return = false;
+  std::size_t num_chars_read{}, num_continuation_bytes{};
+
+  while (true) {
+    if ((m_read_buffer_pos >= m_read_buffer_fill) && !fill_read_buffer()) {
+      m_eof = true;
+      return;
+    }
+
+    auto buffer = m_read_buffer->get_buffer();
+    auto start  = m_read_buffer_pos;
+
+    while (m_read_buffer_pos < m_read_buffer_fill) {
+      auto c = buffer[m_read_buffer_pos];
+
+      if (num_continuation_bytes) {
+        --num_continuation_bytes;
+        ++m_read_buffer_pos;
+
+      } else if ('\r' == c) {
+        s.append(reinterpret_cast<char *>(&buffer[start]), m_read_buffer_pos - start);
+
+        if (previous_was_carriage_return && !m_uses_newlines)
+          return;
+
+        previous_was_carriage_return = true;
+        start                        = ++m_read_buffer_pos;
+        continue;
+
+      } else if (('\n' == c) && (!m_uses_carriage_returns || previous_was_carriage_return)) {
+        s.append(reinterpret_cast<char *>(&buffer[start]), m_read_buffer_pos - start);
+        ++m_read_buffer_pos;
+        return;
+
+      } else if (previous_was_carriage_return) {
+        s.append(reinterpret_cast<char *>(&buffer[start]), m_read_buffer_pos - start);
+        return;
+
+      } else {
+        if (BO_UTF8 == m_byte_order) {
+          auto size = utf8_char_size(c);
+          if (99 == size)
+            throw mtx::mm_io::text::invalid_utf8_char_x(c);
+
+          num_continuation_bytes = size - 1;
+        }
+
+        if (!c) {
+          // NUL characters have never been part of the lines.
+          s.append(reinterpret_cast<char *>(&buffer[start]), m_read_buffer_pos - start);
+          start = m_read_buffer_pos + 1;
+        }
+
+        ++m_read_buffer_pos;
+        ++num_chars_read;
+      }
+
+      if (!num_continuation_bytes && max_chars && (num_chars_read >= *max_chars)) {
+        s.append(reinterpret_cast<char *>(&buffer[start]), m_read_buffer_pos - start);
+        return;
+      }
+    }
+
+    s.append(reinterpret_cast<char *>(&buffer[start]), m_read_buffer_pos - start);
+  }
+}
+
+void
+mm_text_io_c::read_line_unicode(std::string &s,
+                                boost::optional<std::size_t> max_chars) {
   char utf8char[9];
   bool previous_was_carriage_return = false;
-  std::size_t num_chars_read{};
+  std::size_t num_chars_read{}, raw_size{};
 
   while (1) {
     memset(utf8char, 0, 9);
 
-    int len = read_next_char(utf8char);
+    int len = decode_next_char(utf8char, raw_size);
     if (0 == len)
-      return s;
+      return;
 
     if ((1 == len) && (utf8char[0] == '\r')) {
       if (previous_was_carriage_return && !m_uses_newlines) {
-        setFilePointer(-1, seek_current);
-        return s;
+        unread(raw_size);
+        return;
       }
 
       previous_was_carriage_return = true;
@@ -1101,11 +1498,11 @@ mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
     }
 
     if ((1 == len) && (utf8char[0] == '\n') && (!m_uses_carriage_returns || previous_was_carriage_return))
-      return s;
+      return;
 
     if (previous_was_carriage_return) {
-      setFilePointer(-len, seek_current);
-      return s;
+      unread(raw_size);
+      return;
     }
 
     previous_was_carriage_return  = false;
@@ -1113,14 +1510,132 @@ mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
     ++num_chars_read;
 
     if (max_chars && (num_chars_read >= *max_chars))
-      return s;
+      return;
+  }
+}
+
+bool
+mm_text_io_c::fill_read_buffer() {
+  static auto const s_read_buffer_size = 64 * 1024u;
+
+  if (!m_read_buffer)
+    m_read_buffer = memory_c::alloc(s_read_buffer_size);
+
+  m_read_buffer_pos  = 0;
+  m_read_buffer_fill = m_proxy_io->read(m_read_buffer->get_buffer(), m_read_buffer->get_size());
+
+  return 0 != m_read_buffer_fill;
+}
+
+void
+mm_text_io_c::drop_read_buffer() {
+  auto num_unused = m_read_buffer_fill - m_read_buffer_pos;
+
+  m_read_buffer_pos  = 0;
+  m_read_buffer_fill = 0;
+
+  if (num_unused)
+    m_proxy_io->setFilePointer(-static_cast<int64_t>(num_unused), seek_current);
+}
+
+void
+mm_text_io_c::unread(std::size_t num_bytes) {
+  if (m_read_buffer_pos >= num_bytes)
+    m_read_buffer_pos -= num_bytes;
+  else
+    setFilePointer(-static_cast<int64_t>(num_bytes), seek_current);
+}
+
+uint32
+mm_text_io_c::_read(void *buffer,
+                    size_t size) {
+  auto destination = static_cast<unsigned char *>(buffer);
+  auto num_read    = 0u;
+
+  while (size) {
+    auto num_available = m_read_buffer_fill - m_read_buffer_pos;
+
+    if (!num_available) {
+      // Large reads go directly into the caller's buffer.
+      if (m_read_buffer && (size >= m_read_buffer->get_size())) {
+        auto num_read_directly  = m_proxy_io->read(destination, size);
+        num_read               += num_read_directly;
+        m_eof                   = num_read_directly < size;
+        break;
+      }
+
+      if (!fill_read_buffer()) {
+        m_eof = true;
+        break;
+      }
+
+      continue;
+    }
+
+    auto num_to_copy = std::min(num_available, size);
+    std::memcpy(destination, m_read_buffer->get_buffer() + m_read_buffer_pos, num_to_copy);
+
+    m_read_buffer_pos += num_to_copy;
+    destination       += num_to_copy;
+    num_read          += num_to_copy;
+    size              -= num_to_copy;
   }
+
+  return num_read;
+}
+
+size_t
+mm_text_io_c::_write(const void *buffer,
+                     size_t size) {
+  drop_read_buffer();
+
+  return mm_proxy_io_c::_write(buffer, size);
+}
+
+uint64
+mm_text_io_c::getFilePointer() {
+  return m_proxy_io->getFilePointer() - (m_read_buffer_fill - m_read_buffer_pos);
 }
 
 void
 mm_text_io_c::setFilePointer(int64 offset,
                              seek_mode mode) {
-  mm_proxy_io_c::setFilePointer(((0 == offset) && (seek_beginning == mode)) ? m_bom_len : offset, mode);
+  if ((0 == offset) && (seek_beginning == mode))
+    offset = m_bom_len;
+
+  m_eof = false;
+
+  if (m_read_buffer_fill) {
+    // Still within the data read ahead?
+    auto buffer_start = static_cast<int64_t>(m_proxy_io->getFilePointer() - m_read_buffer_fill);
+    auto new_position = seek_beginning == mode ? offset
+                      : seek_current   == mode ? buffer_start + static_cast<int64_t>(m_read_buffer_pos) + offset
+                      :                          -1;
+
+    if ((buffer_start <= new_position) && (new_position <= (buffer_start + static_cast<int64_t>(m_read_buffer_fill)))) {
+      m_read_buffer_pos = new_position - buffer_start;
+      return;
+    }
+
+    if (seek_current == mode)
+      offset -= m_read_buffer_fill - m_read_buffer_pos;
+
+    m_read_buffer_pos  = 0;
+    m_read_buffer_fill = 0;
+  }
+
+  mm_proxy_io_c::setFilePointer(offset, mode);
+}
+
+bool
+mm_text_io_c::eof() {
+  return m_eof || ((m_read_buffer_pos >= m_read_buffer_fill) && m_proxy_io->eof());
+}
+
+void
+mm_text_io_c::clear_eof() {
+  m_eof = false;
+  mm_proxy_io_c::clear_eof();
 }
 
 /*
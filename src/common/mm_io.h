@@ -15,6 +15,7 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
 #include <stack>
 
 #include <ebml/IOCallback.h>
@@ -83,6 +84,31 @@ public:
     return 0;
   }
 
+  // Optional operations for moving data around inside a file without
+  // copying it through user space. They return false if the underlying
+  // file system or operating system doesn't support them.
+  virtual uint64_t get_block_size() {
+    return 0;
+  }
+  virtual bool insert_range(uint64_t, uint64_t) {
+    return false;
+  }
+  virtual bool copy_range(uint64_t, uint64_t, uint64_t) {
+    return false;
+  }
+
+  // Optional hints for large output files. preallocate() reserves
+  // space on the storage without changing the file's size.
+  // drop_cached_data() writes the range to the storage and evicts it
+  // from the operating system's page cache. Both return false if they
+  // aren't supported.
+  virtual bool preallocate(uint64_t) {
+    return false;
+  }
+  virtual bool drop_cached_data(uint64_t, uint64_t) {
+    return false;
+  }
+
   virtual std::string get_file_name() const = 0;
 
   virtual std::string getline(boost::optional<std::size_t> max_chars = boost::none);
@@ -113,6 +139,12 @@ public:
   virtual void enable_buffering(bool /* enable */) {
   }
 
+  // Closes the underlying file handles and frees buffers until the
+  // next access. Only implemented by classes that can re-open their
+  // files transparently; a no-op for all others.
+  virtual void release_file_handle() {
+  }
+
 protected:
   virtual uint32 _read(void *buffer, size_t size) = 0;
   virtual size_t _write(const void *buffer, size_t size) = 0;
@@ -125,8 +157,13 @@ protected:
 
 #if defined(SYS_WINDOWS)
   bool m_eof;
+#else
+  bool m_preallocated{};
 #endif
 
+  // Totals over all files; used for throughput statistics.
+  static std::atomic<uint64_t> ms_num_bytes_read, ms_num_bytes_written;
+
 public:
   mm_file_io_c(const std::string &path, const open_mode mode = MODE_READ);
   virtual ~mm_file_io_c();
@@ -149,10 +186,25 @@ public:
 
   virtual int truncate(int64_t pos);
 
+#if !defined(SYS_WINDOWS)
+  virtual uint64_t get_block_size();
+  virtual bool insert_range(uint64_t offset, uint64_t length);
+  virtual bool copy_range(uint64_t src_offset, uint64_t dst_offset, uint64_t length);
+  virtual bool preallocate(uint64_t size);
+  virtual bool drop_cached_data(uint64_t offset, uint64_t length);
+#endif
+
   static void setup();
   static void cleanup();
   static mm_io_cptr open(const std::string &path, const open_mode mode = MODE_READ);
 
+  static uint64_t get_num_bytes_read() {
+    return ms_num_bytes_read;
+  }
+  static uint64_t get_num_bytes_written() {
+    return ms_num_bytes_written;
+  }
+
 protected:
   virtual uint32 _read(void *buffer, size_t size);
   virtual size_t _write(const void *buffer, size_t size);
@@ -160,6 +212,43 @@ protected:
 
 using mm_file_io_cptr = std::shared_ptr<mm_file_io_c>;
 
+// Read-only file that can give up its file handle with
+// release_file_handle(). The file is re-opened and the current
+// position restored the next time data is read from it.
+class mm_on_demand_file_io_c: public mm_io_c {
+protected:
+  std::string m_file_name;
+  std::unique_ptr<mm_file_io_c> m_file;
+  int64_t m_pos, m_size;
+  bool m_eof;
+
+public:
+  mm_on_demand_file_io_c(std::string const &file_name);
+  virtual ~mm_on_demand_file_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual void close();
+  virtual bool eof();
+  virtual void clear_eof();
+  virtual int64_t get_size();
+  virtual void release_file_handle();
+
+  virtual std::string get_file_name() const {
+    return m_file_name;
+  }
+
+  bool is_open() const {
+    return !!m_file;
+  }
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  mm_file_io_c &file();
+};
+
 class mm_proxy_io_c: public mm_io_c {
 protected:
   mm_io_c *m_proxy_io;
@@ -194,6 +283,26 @@ public:
   virtual mm_io_c *get_proxied() const {
     return m_proxy_io;
   }
+  virtual uint64_t get_block_size() {
+    return m_proxy_io->get_block_size();
+  }
+  virtual bool insert_range(uint64_t offset, uint64_t length) {
+    m_cached_size = -1;
+    return m_proxy_io->insert_range(offset, length);
+  }
+  virtual bool copy_range(uint64_t src_offset, uint64_t dst_offset, uint64_t length) {
+    m_cached_size = -1;
+    return m_proxy_io->copy_range(src_offset, dst_offset, length);
+  }
+  virtual bool preallocate(uint64_t size) {
+    return m_proxy_io->preallocate(size);
+  }
+  virtual bool drop_cached_data(uint64_t offset, uint64_t length) {
+    return m_proxy_io->drop_cached_data(offset, length);
+  }
+  virtual void release_file_handle() {
+    m_proxy_io->release_file_handle();
+  }
 
 protected:
   virtual uint32 _read(void *buffer, size_t size);
@@ -265,13 +374,24 @@ class mm_text_io_c: public mm_proxy_io_c {
 protected:
   byte_order_e m_byte_order;
   unsigned int m_bom_len;
-  bool m_uses_carriage_returns, m_uses_newlines, m_eol_style_detected;
+  bool m_uses_carriage_returns, m_uses_newlines, m_eol_style_detected, m_eof;
+
+  // Raw bytes read ahead from the proxied I/O. Lines are split and
+  // decoded on whole blocks instead of reading each character
+  // separately.
+  memory_cptr m_read_buffer;
+  std::size_t m_read_buffer_pos, m_read_buffer_fill;
 
 public:
   mm_text_io_c(mm_io_c *in, bool delete_in = true);
+  virtual ~mm_text_io_c();
 
+  virtual uint64 getFilePointer();
   virtual void setFilePointer(int64 offset, seek_mode mode=seek_beginning);
+  virtual bool eof();
+  virtual void clear_eof();
   virtual std::string getline(boost::optional<std::size_t> max_chars = boost::none);
+  virtual bool getline2(std::string &s, boost::optional<std::size_t> max_chars = boost::none);
   virtual int read_next_char(char *buffer);
   virtual byte_order_e get_byte_order() const {
     return m_byte_order;
@@ -288,6 +408,16 @@ public:
 
 protected:
   virtual void detect_eol_style();
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  void read_line(std::string &s, boost::optional<std::size_t> max_chars);
+  void read_line_utf8(std::string &s, boost::optional<std::size_t> max_chars);
+  void read_line_unicode(std::string &s, boost::optional<std::size_t> max_chars);
+  int decode_next_char(char *buffer, std::size_t &raw_size);
+  bool fill_read_buffer();
+  void unread(std::size_t num_bytes);
+  void drop_read_buffer();
 
 public:
   static bool has_byte_order_marker(const std::string &string);
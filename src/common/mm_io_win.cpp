@@ -129,6 +129,7 @@ mm_file_io_c::_read(void *buffer,
 
   m_eof               = size != bytes_read;
   m_current_position += bytes_read;
+  ms_num_bytes_read  += bytes_read;
 
   return bytes_read;
 }
@@ -147,9 +148,10 @@ mm_file_io_c::_write(const void *buffer,
     mxerror(boost::format(Y("Could not write to the destination file: %1% (%2%)\n")) % error % error_msg_utf8);
   }
 
-  m_current_position += bytes_written;
-  m_cached_size       = -1;
-  m_eof               = false;
+  m_current_position   += bytes_written;
+  m_cached_size         = -1;
+  m_eof                 = false;
+  ms_num_bytes_written += bytes_written;
 
   return bytes_written;
 }
@@ -15,6 +15,7 @@
 
 #include <sstream>
 
+#include "common/debugging.h"
 #include "common/id_info.h"
 #include "common/mm_io_x.h"
 #include "common/mm_multi_file_io.h"
@@ -22,13 +23,20 @@
 #include "common/strings/editing.h"
 #include "common/strings/parsing.h"
 
+namespace {
+debugging_option_c s_debug{"multi_file_io"};
+}
+
+uint64_t mm_multi_file_io_c::s_read_ahead_size             = 8 * 1024 * 1024;
+uint64_t const mm_multi_file_io_c::s_read_ahead_block_size = 1024 * 1024;
+uint64_t const mm_multi_file_io_c::s_no_block              = std::numeric_limits<uint64_t>::max();
+
 mm_multi_file_io_c::file_t::file_t(const bfs::path &file_name,
-                                   uint64_t global_start,
-                                   mm_file_io_cptr file)
+                                   uint64_t size,
+                                   uint64_t global_start)
   : m_file_name(file_name)
-  , m_size(file->get_size())
+  , m_size(size)
   , m_global_start(global_start)
-  , m_file(file)
 {
 }
 
@@ -37,21 +45,41 @@ mm_multi_file_io_c::mm_multi_file_io_c(const std::vector<bfs::path> &file_names,
   : m_display_file_name(display_file_name)
   , m_total_size(0)
   , m_current_pos(0)
-  , m_current_local_pos(0)
-  , m_current_file(0)
+  , m_buffering(true)
+  , m_read_ahead_wanted_block(0)
+  , m_read_ahead_in_flight(s_no_block)
+  , m_read_ahead_running(false)
+  , m_read_ahead_quit(false)
+  , m_read_ahead_failed(false)
 {
   for (auto &file_name : file_names) {
-    mm_file_io_cptr file(new mm_file_io_c(file_name.string()));
-    m_files.push_back(mm_multi_file_io_c::file_t(file_name, m_total_size, file));
+    boost::system::error_code ec;
+    auto size = bfs::file_size(file_name, ec);
+    if (ec)
+      throw mtx::mm_io::open_x{std::error_code{ec.value(), std::system_category()}};
 
-    m_total_size += file->get_size();
+    m_files.push_back(mm_multi_file_io_c::file_t(file_name, size, m_total_size));
+
+    m_total_size += size;
   }
+
+  m_handles.resize(m_files.size());
+
+  // Open the first file right away so that permission problems are
+  // still reported when the file set is opened.
+  if (!m_files.empty())
+    open_file(m_handles, 0);
 }
 
 mm_multi_file_io_c::~mm_multi_file_io_c() {
   close();
 }
 
+void
+mm_multi_file_io_c::set_read_ahead_size(uint64_t size) {
+  s_read_ahead_size = size;
+}
+
 uint64
 mm_multi_file_io_c::getFilePointer() {
   return m_current_pos;
@@ -68,51 +96,246 @@ mm_multi_file_io_c::setFilePointer(int64 offset,
   if ((0 > new_pos) || (static_cast<int64_t>(m_total_size) < new_pos))
     throw mtx::mm_io::seek_x();
 
-  m_current_file = 0;
-  for (auto &file : m_files) {
-    if ((file.m_global_start + file.m_size) < static_cast<uint64_t>(new_pos)) {
-      ++m_current_file;
-      continue;
+  m_current_pos = new_pos;
+}
+
+std::size_t
+mm_multi_file_io_c::find_file_idx(uint64_t position)
+  const {
+  // Empty files share their global start with the following file;
+  // upper_bound() skips them automatically.
+  auto itr = std::upper_bound(m_files.begin(), m_files.end(), position, [](uint64_t pos, file_t const &file) { return pos < file.m_global_start; });
+  return std::distance(m_files.begin(), itr) - 1;
+}
+
+mm_file_io_c &
+mm_multi_file_io_c::open_file(file_handles_t &handles,
+                              std::size_t file_idx) {
+  if (handles[file_idx])
+    return *handles[file_idx];
+
+  for (auto &handle : handles)
+    if (handle) {
+      handle->close();
+      handle.reset();
     }
 
-    m_current_pos       = new_pos;
-    m_current_local_pos = new_pos - file.m_global_start;
-    file.m_file->setFilePointer(m_current_local_pos, seek_beginning);
-    break;
+  mxdebug_if(s_debug, boost::format("opening %1%\n") % m_files[file_idx].m_file_name.string());
+
+  handles[file_idx] = std::make_shared<mm_file_io_c>(m_files[file_idx].m_file_name.string());
+  handles[file_idx]->enable_buffering(m_buffering);
+
+  return *handles[file_idx];
+}
+
+size_t
+mm_multi_file_io_c::read_range(file_handles_t &handles,
+                               uint64_t position,
+                               unsigned char *buffer,
+                               size_t size) {
+  size_t num_read_total = 0;
+
+  while ((num_read_total < size) && (position < m_total_size)) {
+    auto file_idx    = find_file_idx(position);
+    auto &file       = m_files[file_idx];
+    auto local_pos   = position - file.m_global_start;
+    auto num_to_read = static_cast<size_t>(std::min<uint64_t>(size - num_read_total, file.m_size - local_pos));
+    auto &handle     = open_file(handles, file_idx);
+
+    if (handle.getFilePointer() != local_pos)
+      handle.setFilePointer(local_pos, seek_beginning);
+
+    auto num_read   = handle.read(buffer + num_read_total, num_to_read);
+    num_read_total += num_read;
+    position       += num_read;
+
+    if (num_read != num_to_read)
+      break;
   }
+
+  return num_read_total;
 }
 
 uint32
 mm_multi_file_io_c::_read(void *buffer,
                           size_t size) {
+  // Only start reading ahead once the caller has moved past the first
+  // block. File type probing usually doesn't, and there's no point in
+  // spawning a thread for it.
+  if (   !m_read_ahead_running
+      && !m_read_ahead_failed
+      && (0 < s_read_ahead_size)
+      && (m_current_pos >= s_read_ahead_block_size))
+    start_read_ahead();
+
   size_t num_read_total     = 0;
   unsigned char *buffer_ptr = static_cast<unsigned char *>(buffer);
 
-  while (!eof() && (num_read_total < size)) {
-    mm_multi_file_io_c::file_t &file = m_files[m_current_file];
-    size_t num_to_read = static_cast<size_t>(std::min(static_cast<uint64_t>(size) - static_cast<uint64_t>(num_read_total), file.m_size - m_current_local_pos));
+  while ((num_read_total < size) && (m_current_pos < m_total_size)) {
+    auto num_to_read = size - num_read_total;
+    auto num_read    = size_t{};
 
-    if (0 != num_to_read) {
-      size_t num_read      = file.m_file->read(buffer_ptr, num_to_read);
-      num_read_total      += num_read;
-      buffer_ptr          += num_read;
-      m_current_local_pos += num_read;
-      m_current_pos       += num_read;
+    if (m_read_ahead_running) {
+      num_read = read_from_read_ahead(buffer_ptr, num_to_read);
 
-      if (num_read != num_to_read)
-        break;
+      // Blocks that aren't buffered are read synchronously, but only up
+      // to the end of the current block so that the next one can be
+      // taken from the read-ahead buffer again.
+      if (!num_read)
+        num_to_read = std::min<uint64_t>(num_to_read, s_read_ahead_block_size - (m_current_pos % s_read_ahead_block_size));
     }
 
-    if ((m_current_local_pos >= file.m_size) && (m_files.size() > (m_current_file + 1))) {
-      ++m_current_file;
-      m_current_local_pos = 0;
-      m_files[m_current_file].m_file->setFilePointer(0, seek_beginning);
-    }
+    if (!num_read)
+      num_read = read_range(m_handles, m_current_pos, buffer_ptr, num_to_read);
+
+    if (!num_read)
+      break;
+
+    num_read_total += num_read;
+    buffer_ptr     += num_read;
+    m_current_pos  += num_read;
   }
 
   return num_read_total;
 }
 
+size_t
+mm_multi_file_io_c::read_from_read_ahead(unsigned char *buffer,
+                                         size_t size) {
+  auto block = m_current_pos / s_read_ahead_block_size;
+
+  std::unique_lock<std::mutex> lock{m_read_ahead_mutex};
+
+  if (m_read_ahead_wanted_block != block) {
+    m_read_ahead_wanted_block = block;
+    m_read_ahead_cond.notify_all();
+  }
+
+  m_read_ahead_cond.wait(lock, [this, block]() { return m_read_ahead_in_flight != block; });
+
+  auto itr = m_read_ahead_blocks.find(block);
+  if (itr == m_read_ahead_blocks.end())
+    return 0;
+
+  auto offset = m_current_pos - block * s_read_ahead_block_size;
+  if (offset >= itr->second->get_size())
+    return 0;
+
+  auto num_copied = std::min<size_t>(size, itr->second->get_size() - offset);
+  std::memcpy(buffer, itr->second->get_buffer() + offset, num_copied);
+
+  return num_copied;
+}
+
+void
+mm_multi_file_io_c::start_read_ahead() {
+  std::string arg;
+  if (debugging_c::requested("multi_file_read_ahead", &arg)) {
+    uint64_t size_kb = 0;
+    if (parse_number(arg, size_kb))
+      s_read_ahead_size = size_kb * 1024;
+    if (!s_read_ahead_size)
+      return;
+  }
+
+  mxdebug_if(s_debug, boost::format("starting read-ahead with a window of %1% bytes at %2%\n") % s_read_ahead_size % m_current_pos);
+
+  m_read_ahead_quit         = false;
+  m_read_ahead_in_flight    = s_no_block;
+  m_read_ahead_wanted_block = m_current_pos / s_read_ahead_block_size;
+  m_read_ahead_running      = true;
+  m_read_ahead_thread       = std::thread{[this]() { run_read_ahead(); }};
+}
+
+void
+mm_multi_file_io_c::stop_read_ahead() {
+  if (!m_read_ahead_running)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock{m_read_ahead_mutex};
+    m_read_ahead_quit = true;
+  }
+
+  m_read_ahead_cond.notify_all();
+  m_read_ahead_thread.join();
+
+  m_read_ahead_running = false;
+  m_read_ahead_blocks.clear();
+}
+
+uint64_t
+mm_multi_file_io_c::find_next_read_ahead_block() {
+  // Called with m_read_ahead_mutex held. The current block itself is
+  // left to the caller's thread; only the ones following it are read
+  // ahead.
+  auto first_block = m_read_ahead_wanted_block;
+  auto last_block  = first_block + std::max<uint64_t>(s_read_ahead_size / s_read_ahead_block_size, 1);
+
+  for (auto itr = m_read_ahead_blocks.begin(); itr != m_read_ahead_blocks.end();) {
+    if ((itr->first < first_block) || (itr->first > last_block))
+      itr = m_read_ahead_blocks.erase(itr);
+    else
+      ++itr;
+  }
+
+  for (auto block = first_block + 1; (block <= last_block) && ((block * s_read_ahead_block_size) < m_total_size); ++block)
+    if (!m_read_ahead_blocks.count(block))
+      return block;
+
+  return s_no_block;
+}
+
+void
+mm_multi_file_io_c::run_read_ahead() {
+  file_handles_t handles(m_files.size());
+  std::unique_lock<std::mutex> lock{m_read_ahead_mutex};
+
+  while (true) {
+    auto block = s_no_block;
+
+    m_read_ahead_cond.wait(lock, [this, &block]() {
+      if (m_read_ahead_quit)
+        return true;
+      block = find_next_read_ahead_block();
+      return block != s_no_block;
+    });
+
+    if (m_read_ahead_quit)
+      break;
+
+    m_read_ahead_in_flight = block;
+    lock.unlock();
+
+    auto start = block * s_read_ahead_block_size;
+    auto data  = memory_c::alloc(std::min(s_read_ahead_block_size, m_total_size - start));
+
+    try {
+      data->set_size(read_range(handles, start, data->get_buffer(), data->get_size()));
+
+    } catch (...) {
+      mxdebug_if(s_debug, boost::format("read-ahead of block %1% failed\n") % block);
+      data.reset();
+    }
+
+    lock.lock();
+
+    m_read_ahead_in_flight = s_no_block;
+
+    if (data)
+      m_read_ahead_blocks[block] = data;
+    else
+      // Leave it to the caller's thread to report the error when it
+      // reaches the failing position.
+      m_read_ahead_failed = true;
+
+    m_read_ahead_cond.notify_all();
+
+    if (m_read_ahead_failed)
+      break;
+  }
+}
+
 size_t
 mm_multi_file_io_c::_write(const void *,
                            size_t) {
@@ -121,18 +344,21 @@ mm_multi_file_io_c::_write(const void *,
 
 void
 mm_multi_file_io_c::close() {
-  for (auto &file : m_files)
-    file.m_file->close();
+  stop_read_ahead();
 
+  for (auto &handle : m_handles)
+    if (handle)
+      handle->close();
+
+  m_handles.clear();
   m_files.clear();
-  m_total_size        = 0;
-  m_current_pos       = 0;
-  m_current_local_pos = 0;
+  m_total_size  = 0;
+  m_current_pos = 0;
 }
 
 bool
 mm_multi_file_io_c::eof() {
-  return m_files.empty() || ((m_current_file == (m_files.size() - 1)) && (m_current_local_pos >= m_files[m_current_file].m_size));
+  return m_current_pos >= m_total_size;
 }
 
 std::vector<bfs::path>
@@ -171,8 +397,21 @@ mm_multi_file_io_c::display_other_file_info() {
 
 void
 mm_multi_file_io_c::enable_buffering(bool enable) {
-  for (auto &file : m_files)
-    file.m_file->enable_buffering(enable);
+  m_buffering = enable;
+
+  for (auto &handle : m_handles)
+    if (handle)
+      handle->enable_buffering(enable);
+}
+
+void
+mm_multi_file_io_c::release_file_handle() {
+  // Both the read-ahead thread and the file handles are set up again
+  // by the next read.
+  stop_read_ahead();
+
+  for (auto &handle : m_handles)
+    handle.reset();
 }
 
 struct path_sorter_t {
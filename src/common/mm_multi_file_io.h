@@ -15,6 +15,10 @@
 
 #include "common/common_pch.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "common/mm_io.h"
 
 namespace mtx { namespace id {
@@ -29,16 +33,35 @@ protected:
   struct file_t {
     bfs::path m_file_name;
     uint64_t m_size, m_global_start;
-    mm_file_io_cptr m_file;
 
-    file_t(const bfs::path &file_name, uint64_t global_start, mm_file_io_cptr file);
+    file_t(const bfs::path &file_name, uint64_t size, uint64_t global_start);
   };
 
+  // Segment files are only opened while they're actually being read
+  // from. Each reader (the caller's thread and the read-ahead thread)
+  // keeps its own set of handles with at most one file open at a time.
+  using file_handles_t = std::vector<mm_file_io_cptr>;
+
 protected:
   std::string m_display_file_name;
-  uint64_t m_total_size, m_current_pos, m_current_local_pos;
-  unsigned int m_current_file;
+  uint64_t m_total_size, m_current_pos;
   std::vector<mm_multi_file_io_c::file_t> m_files;
+  file_handles_t m_handles;
+  bool m_buffering;
+
+  // Read-ahead state. Blocks are indexed by their global position
+  // divided by s_read_ahead_block_size. Everything below is protected
+  // by m_read_ahead_mutex.
+  std::thread m_read_ahead_thread;
+  std::mutex m_read_ahead_mutex;
+  std::condition_variable m_read_ahead_cond;
+  std::map<uint64_t, memory_cptr> m_read_ahead_blocks;
+  uint64_t m_read_ahead_wanted_block, m_read_ahead_in_flight;
+  bool m_read_ahead_running, m_read_ahead_quit, m_read_ahead_failed;
+
+  static uint64_t s_read_ahead_size;
+  static uint64_t const s_read_ahead_block_size;
+  static uint64_t const s_no_block;
 
 public:
   mm_multi_file_io_c(const std::vector<bfs::path> &file_names, const std::string &display_file_name);
@@ -56,10 +79,25 @@ public:
   virtual void create_verbose_identification_info(mtx::id::info_c &info);
   virtual void display_other_file_info();
   virtual void enable_buffering(bool enable);
+  virtual void release_file_handle();
 
   static mm_io_cptr open_multi(const std::string &display_file_name, bool single_only = false);
 
+  // Sets the number of bytes the background thread keeps buffered ahead
+  // of the current read position. 0 disables reading ahead.
+  static void set_read_ahead_size(uint64_t size);
+
 protected:
   virtual uint32 _read(void *buffer, size_t size);
   virtual size_t _write(const void *buffer, size_t size);
+
+  size_t read_range(file_handles_t &handles, uint64_t position, unsigned char *buffer, size_t size);
+  size_t read_from_read_ahead(unsigned char *buffer, size_t size);
+  mm_file_io_c &open_file(file_handles_t &handles, std::size_t file_idx);
+  std::size_t find_file_idx(uint64_t position) const;
+
+  void start_read_ahead();
+  void stop_read_ahead();
+  void run_read_ahead();
+  uint64_t find_next_read_ahead_block();
 };
@@ -40,6 +40,7 @@ public:
   inline virtual bool eof() { return m_eof; }
   virtual void clear_eof() { m_eof = false; }
   virtual void enable_buffering(bool enable);
+  virtual void release_file_handle();
 
 protected:
   virtual uint32 _read(void *buffer, size_t size);
@@ -16,6 +16,8 @@
 
 #include "common/mm_io_x.h"
 #include "common/mm_write_buffer_io.h"
+#include "common/profiling.h"
+#include "common/thread_pool.h"
 
 mm_write_buffer_io_c::mm_write_buffer_io_c(mm_io_c *out,
                                            size_t buffer_size,
@@ -27,6 +29,10 @@ mm_write_buffer_io_c::mm_write_buffer_io_c(mm_io_c *out,
   , m_size(buffer_size)
   , m_debug_seek{ "write_buffer_io|write_buffer_io_read"}
   , m_debug_write{"write_buffer_io|write_buffer_io_write"}
+  , m_profiling_counter{}
+  , m_drop_cached_data{}
+  , m_write_pending{}
+  , m_pending_write_end{}
 {
 }
 
@@ -42,12 +48,15 @@ mm_write_buffer_io_c::open(const std::string &file_name,
 
 uint64
 mm_write_buffer_io_c::getFilePointer() {
-  return mm_proxy_io_c::getFilePointer() + m_fill;
+  return (m_write_pending ? m_pending_write_end : mm_proxy_io_c::getFilePointer()) + m_fill;
 }
 
 void
 mm_write_buffer_io_c::setFilePointer(int64 offset,
                                      seek_mode mode) {
+  if (seek_end == mode)
+    wait_for_pending_write();
+
   int64_t new_pos
     = seek_beginning == mode ? offset
     : seek_end       == mode ? m_proxy_io->get_size() + offset // offsets from the end are negative already
@@ -57,6 +66,7 @@ mm_write_buffer_io_c::setFilePointer(int64 offset,
     return;
 
   flush_buffer();
+  wait_for_pending_write();
 
   if (m_debug_seek) {
     int64_t previous_pos = mm_proxy_io_c::getFilePointer();
@@ -69,12 +79,14 @@ mm_write_buffer_io_c::setFilePointer(int64 offset,
 void
 mm_write_buffer_io_c::flush() {
   flush_buffer();
+  wait_for_pending_write();
   mm_proxy_io_c::flush();
 }
 
 void
 mm_write_buffer_io_c::close() {
   flush_buffer();
+  wait_for_pending_write();
   mm_proxy_io_c::close();
 }
 
@@ -82,6 +94,7 @@ uint32
 mm_write_buffer_io_c::_read(void *buffer,
                             size_t size) {
   flush_buffer();
+  wait_for_pending_write();
   return mm_proxy_io_c::_read(buffer, size);
 }
 
@@ -94,9 +107,10 @@ mm_write_buffer_io_c::_write(const void *buffer,
 
   // whole blocks
   while (remain >= (avail = m_size - m_fill)) {
-    if (m_fill) {
+    if (m_fill || m_writer) {
       // Fill the buffer in an attempt to defeat potentially
-      // lousy OS I/O scheduling
+      // lousy OS I/O scheduling. With background writes all data
+      // goes through the buffers so that writing never blocks.
       memcpy(m_buffer + m_fill, buf, avail);
       m_fill = m_size;
       flush_buffer();
@@ -105,6 +119,8 @@ mm_write_buffer_io_c::_write(const void *buffer,
 
     } else {
       // write whole blocks, skipping the buffer
+      mtx::profiling::scope_c profiling{m_profiling_counter};
+
       avail = mm_proxy_io_c::_write(buf, m_size);
       if (avail != m_size)
         throw mtx::mm_io::insufficient_space_x();
@@ -129,17 +145,125 @@ mm_write_buffer_io_c::flush_buffer() {
   if (!m_fill)
     return;
 
-  size_t written = mm_proxy_io_c::_write(m_buffer, m_fill);
-  size_t fill    = m_fill;
-  m_fill         = 0;
+  wait_for_pending_write();
+
+  auto position = mm_proxy_io_c::getFilePointer();
+  auto fill     = m_fill;
+  m_fill        = 0;
+  m_cached_size = -1;
+
+  if (!m_writer) {
+    write_buffer(m_buffer, fill, position);
+    return;
+  }
+
+  std::swap(m_af_buffer, m_af_pending_buffer);
+  m_buffer = m_af_buffer->get_buffer();
+
+  auto buffer         = m_af_pending_buffer->get_buffer();
+  m_write_pending     = true;
+  m_pending_write_end = position + fill;
+  m_pending_write     = m_writer->enqueue([this, buffer, fill, position]() {
+    write_buffer(buffer, fill, position);
+  });
+}
+
+void
+mm_write_buffer_io_c::write_buffer(unsigned char const *buffer,
+                                   size_t size,
+                                   uint64_t position) {
+  // Runs in the writer thread with background writes enabled. It must
+  // therefore only access the underlying I/O, not this object's state.
+  mtx::profiling::scope_c profiling{m_profiling_counter};
+
+  size_t written = m_proxy_io->write(buffer, size);
 
-  mxdebug_if(m_debug_write, boost::format("flush_buffer() at %1% for %2% written %3%\n") % (mm_proxy_io_c::getFilePointer() - written) % fill % written);
+  mxdebug_if(m_debug_write, boost::format("flush_buffer() at %1% for %2% written %3%\n") % position % size % written);
 
-  if (written != fill)
+  if (written != size)
     throw mtx::mm_io::insufficient_space_x();
+
+  if (m_drop_cached_data)
+    m_proxy_io->drop_cached_data(position, written);
+}
+
+void
+mm_write_buffer_io_c::wait_for_pending_write() {
+  if (!m_write_pending)
+    return;
+
+  m_write_pending = false;
+
+  // Re-throws the writer's exceptions.
+  m_pending_write.get();
 }
 
 void
 mm_write_buffer_io_c::discard_buffer() {
   m_fill = 0;
+
+  // A write that has already been started cannot be discarded, but it
+  // must not outlive the buffer.
+  if (!m_write_pending)
+    return;
+
+  m_write_pending = false;
+
+  try {
+    m_pending_write.get();
+  } catch (...) {
+  }
+}
+
+bool
+mm_write_buffer_io_c::insert_range(uint64_t offset,
+                                   uint64_t length) {
+  flush_buffer();
+  wait_for_pending_write();
+  return mm_proxy_io_c::insert_range(offset, length);
+}
+
+void
+mm_write_buffer_io_c::set_profiling_counter(mtx::profiling::counter_c *counter) {
+  m_profiling_counter = counter;
+}
+
+void
+mm_write_buffer_io_c::enable_background_writes(bool enable) {
+  if (enable == !!m_writer)
+    return;
+
+  flush_buffer();
+  wait_for_pending_write();
+
+  if (enable) {
+    m_writer            = std::make_unique<mtx::thread_pool_c>(1);
+    m_af_pending_buffer = memory_c::alloc(m_size);
+
+  } else {
+    m_writer.reset();
+    m_af_pending_buffer.reset();
+  }
+}
+
+void
+mm_write_buffer_io_c::enable_dropping_cached_data(bool enable) {
+  // Data written before this call stays in the cache.
+  wait_for_pending_write();
+  m_drop_cached_data = enable;
+}
+
+bool
+mm_write_buffer_io_c::preallocate(uint64_t size) {
+  wait_for_pending_write();
+  return mm_proxy_io_c::preallocate(size);
+}
+
+bool
+mm_write_buffer_io_c::copy_range(uint64_t src_offset,
+                                 uint64_t dst_offset,
+                                 uint64_t length) {
+  flush_buffer();
+  wait_for_pending_write();
+  return mm_proxy_io_c::copy_range(src_offset, dst_offset, length);
 }
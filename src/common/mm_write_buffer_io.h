@@ -16,8 +16,17 @@
 
 #include "common/common_pch.h"
 
+#include <future>
+
 #include "common/mm_io.h"
 
+namespace mtx {
+class thread_pool_c;
+
+namespace profiling {
+class counter_c;
+}}
+
 class mm_write_buffer_io_c: public mm_proxy_io_c {
 protected:
   memory_cptr m_af_buffer;
@@ -25,6 +34,18 @@ protected:
   size_t m_fill;
   const size_t m_size;
   debugging_option_c m_debug_seek, m_debug_write;
+  mtx::profiling::counter_c *m_profiling_counter;
+  bool m_drop_cached_data;
+
+  // Background writing: while the full buffer m_af_pending_buffer is
+  // written by m_writer, the next one is filled in m_af_buffer. The
+  // underlying I/O must not be touched until m_pending_write has
+  // finished; see wait_for_pending_write().
+  std::unique_ptr<mtx::thread_pool_c> m_writer;
+  memory_cptr m_af_pending_buffer;
+  std::future<void> m_pending_write;
+  bool m_write_pending;
+  uint64_t m_pending_write_end;
 
 public:
   mm_write_buffer_io_c(mm_io_c *out, size_t buffer_size, bool delete_out = true);
@@ -35,6 +56,19 @@ public:
   virtual void flush();
   virtual void close();
   virtual void discard_buffer();
+  virtual bool insert_range(uint64_t offset, uint64_t length);
+  virtual bool copy_range(uint64_t src_offset, uint64_t dst_offset, uint64_t length);
+  virtual bool preallocate(uint64_t size);
+
+  // Times all writes to the underlying file with the counter.
+  void set_profiling_counter(mtx::profiling::counter_c *counter);
+  // Writes full buffers in a separate thread while the next buffer is
+  // being filled.
+  void enable_background_writes(bool enable);
+  // Evicts data from the operating system's page cache once it has
+  // been written so that writing huge files doesn't push everything
+  // else out of the cache.
+  void enable_dropping_cached_data(bool enable);
 
   static mm_io_cptr open(const std::string &file_name, size_t buffer_size);
 
@@ -42,5 +76,7 @@ protected:
   virtual uint32 _read(void *buffer, size_t size);
   virtual size_t _write(const void *buffer, size_t size);
   virtual void flush_buffer();
+  void write_buffer(unsigned char const *buffer, size_t size, uint64_t position);
+  void wait_for_pending_write();
 };
 using mm_write_buffer_io_cptr = std::shared_ptr<mm_write_buffer_io_c>;
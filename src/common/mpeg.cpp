@@ -133,4 +133,60 @@ remove_trailing_zero_bytes(memory_c &buffer) {
   mxdebug_if(s_debug_trailing_zero_byte_removal, boost::format("Removing trailing zero bytes from old size %1% down to new size %2%, removed %3%\n") % size % new_size % idx);
 }
 
+void
+for_each_framed_nalu(memory_cptr const &buffer,
+                     std::size_t nalu_size_length,
+                     std::function<void(memory_cptr const &, uint64_t)> const &handler) {
+  auto bytes       = buffer->get_buffer();
+  auto buffer_size = buffer->get_size();
+  auto position    = std::size_t{};
+
+  while ((position + nalu_size_length) < buffer_size) {
+    auto nalu_pos   = position;
+    auto nalu_size  = get_uint_be(&bytes[position], nalu_size_length);
+    position       += nalu_size_length;
+
+    if ((position + nalu_size) > buffer_size)
+      break;
+
+    auto nalu  = memory_c::slice(buffer, position, nalu_size);
+    position  += nalu_size;
+
+    remove_trailing_zero_bytes(*nalu);
+    if (nalu->get_size())
+      handler(nalu, nalu_pos);
+  }
+}
+
+/** \brief Find the next start code prefix (0x00 0x00 0x01)
+
+   The buffer is searched for the prefix's 0x01 byte with \c memchr,
+   which is a lot faster than shifting each byte into a 32-bit word.
+
+   \return A pointer to the first byte of the prefix or \c end if no
+   prefix is found in <tt>[start, end)</tt>.
+*/
+unsigned char const *
+find_start_code_prefix(unsigned char const *start,
+                       unsigned char const *end) {
+  if ((end - start) < 3)
+    return end;
+
+  auto current = start + 2;
+
+  while (current < end) {
+    current = static_cast<unsigned char const *>(std::memchr(current, 0x01, end - current));
+    if (!current)
+      return end;
+
+    if (!current[-1] && !current[-2])
+      return current - 2;
+
+    // The byte after a 0x01 cannot be the middle of a prefix either.
+    current += 3;
+  }
+
+  return end;
+}
+
 }}
@@ -48,4 +48,13 @@ memory_cptr create_nalu_with_size(memory_cptr const &src, std::size_t nalu_size_
 
 void remove_trailing_zero_bytes(memory_c &buffer);
 
+// Walks the NALUs in a buffer in which each NALU is prefixed with its
+// size. 'handler' is called for each non-empty NALU with a slice of
+// 'buffer' (so nothing is copied) and the offset of the NALU's size
+// field within 'buffer'. Trailing zero bytes are removed from the
+// slices. A truncated NALU at the end of the buffer is ignored.
+void for_each_framed_nalu(memory_cptr const &buffer, std::size_t nalu_size_length, std::function<void(memory_cptr const &, uint64_t)> const &handler);
+
+unsigned char const *find_start_code_prefix(unsigned char const *start, unsigned char const *end);
+
 }}
@@ -272,6 +272,11 @@ init_common_output(bool no_charset_detection) {
 #else
     set_cc_stdio(get_local_console_charset());
 #endif
+  reset_mxmsg_handlers();
+}
+
+void
+reset_mxmsg_handlers() {
   set_mxmsg_handler(MXMSG_INFO,    default_mxinfo);
   set_mxmsg_handler(MXMSG_WARNING, default_mxwarn);
   set_mxmsg_handler(MXMSG_ERROR,   default_mxerror);
@@ -27,6 +27,7 @@ using namespace libebml;
 
 using mxmsg_handler_t = std::function<void(unsigned int level, std::string const &)>;
 void set_mxmsg_handler(unsigned int level, mxmsg_handler_t const &handler);
+void reset_mxmsg_handlers();
 
 extern bool g_suppress_info, g_suppress_warnings;
 extern std::string g_stdio_charset;
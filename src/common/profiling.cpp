@@ -0,0 +1,248 @@
+/*
+   mkvtoolnix - A set of programs for manipulating Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   scoped timers for profiling the processing stages
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <mutex>
+
+#include "common/json.h"
+#include "common/mm_io_x.h"
+#include "common/mm_write_buffer_io.h"
+#include "common/profiling.h"
+
+namespace mtx { namespace profiling {
+
+namespace {
+
+struct trace_event_t {
+  counter_c *m_counter;
+  int64_t m_start_ns, m_duration_ns;
+  unsigned int m_thread;
+};
+
+// Recording stops once this many events have been collected in order to
+// keep the memory usage in check (32 bytes per event).
+std::size_t const s_max_num_trace_events = 4 * 1024 * 1024;
+
+bool s_enabled{};
+std::chrono::steady_clock::time_point s_start;
+std::string s_trace_file_name;
+
+std::mutex s_mutex;
+std::vector<std::unique_ptr<counter_c>> s_counters;
+std::map<std::pair<std::string, std::string>, counter_c *> s_counters_by_name;
+std::vector<trace_event_t> s_trace_events;
+std::size_t s_num_dropped_trace_events{};
+
+std::atomic<unsigned int> s_num_threads{};
+thread_local scope_c *t_current_scope{};
+thread_local unsigned int t_thread{};
+
+int64_t
+ns_since_start(std::chrono::steady_clock::time_point time_point) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time_point - s_start).count();
+}
+
+void
+add_trace_event(counter_c *counter,
+                std::chrono::steady_clock::time_point start,
+                int64_t duration_ns) {
+  if (!t_thread)
+    t_thread = ++s_num_threads;
+
+  std::lock_guard<std::mutex> lock{s_mutex};
+
+  if (s_trace_events.size() < s_max_num_trace_events)
+    s_trace_events.push_back({ counter, ns_since_start(start), duration_ns, t_thread });
+  else
+    ++s_num_dropped_trace_events;
+}
+
+void
+write_trace_file(int64_t wall_clock_ns) {
+  auto summary = nlohmann::json::array();
+  for (auto const &counter : s_counters) {
+    if (!counter->m_num_calls)
+      continue;
+
+    summary.push_back({
+      { "stage",    counter->m_stage                                   },
+      { "scope",    counter->m_scope                                   },
+      { "calls",    static_cast<int64_t>(counter->m_num_calls)         },
+      { "total_us", static_cast<int64_t>(counter->m_total_ns) / 1000   },
+      { "self_us",  static_cast<int64_t>(counter->m_self_ns)  / 1000   },
+    });
+  }
+
+  auto metadata = nlohmann::json{
+    { "wall_clock_us",            wall_clock_ns / 1000       },
+    { "num_dropped_trace_events", s_num_dropped_trace_events },
+    { "stages",                   summary                    },
+  };
+
+  try {
+    auto out = mm_write_buffer_io_c::open(s_trace_file_name, 128 * 1024);
+
+    // The events are written one by one instead of building one huge JSON
+    // document in memory first.
+    out->puts("{\"displayTimeUnit\":\"ms\",\"mkvmerge_profile\":");
+    out->puts(mtx::json::dump(metadata));
+    out->puts(",\"traceEvents\":[\n");
+
+    auto first = true;
+    for (auto const &event : s_trace_events) {
+      auto json = nlohmann::json{
+        { "name", event.m_counter->m_stage                        },
+        { "cat",  "mkvmerge"                                      },
+        { "ph",   "X"                                             },
+        { "pid",  1                                               },
+        { "tid",  event.m_thread                                  },
+        { "ts",   static_cast<double>(event.m_start_ns)    / 1000 },
+        { "dur",  static_cast<double>(event.m_duration_ns) / 1000 },
+      };
+
+      if (!event.m_counter->m_scope.empty())
+        json["args"] = nlohmann::json{ { "scope", event.m_counter->m_scope } };
+
+      out->puts(first ? "" : ",\n");
+      out->puts(mtx::json::dump(json));
+      first = false;
+    }
+
+    out->puts("\n]}\n");
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxwarn(boost::format(Y("The profiling trace file '%1%' could not be written: %2%.\n")) % s_trace_file_name % ex);
+  }
+}
+
+}
+
+counter_c::counter_c(std::string const &stage,
+                     std::string const &scope)
+  : m_stage{stage}
+  , m_scope{scope}
+  , m_num_calls{}
+  , m_total_ns{}
+  , m_self_ns{}
+{
+}
+
+void
+scope_c::start() {
+  m_parent        = t_current_scope;
+  m_children_ns   = 0;
+  m_recursive     = false;
+  t_current_scope = this;
+
+  // Time spent in a stage that calls itself must only be counted once
+  // towards its total time.
+  for (auto scope = m_parent; scope && !m_recursive; scope = scope->m_parent)
+    m_recursive = scope->m_counter == m_counter;
+
+  m_start = std::chrono::steady_clock::now();
+}
+
+void
+scope_c::stop() {
+  auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+
+  ++m_counter->m_num_calls;
+  m_counter->m_self_ns += elapsed_ns - m_children_ns;
+  if (!m_recursive)
+    m_counter->m_total_ns += elapsed_ns;
+
+  if (m_parent)
+    m_parent->m_children_ns += elapsed_ns;
+
+  t_current_scope = m_parent;
+
+  if (!s_trace_file_name.empty())
+    add_trace_event(m_counter, m_start, elapsed_ns);
+}
+
+void
+enable() {
+  s_enabled = true;
+  s_start   = std::chrono::steady_clock::now();
+}
+
+bool
+is_enabled() {
+  return s_enabled;
+}
+
+void
+set_trace_file_name(std::string const &file_name) {
+  s_trace_file_name = file_name;
+}
+
+counter_c *
+get_counter(std::string const &stage,
+            std::string const &scope) {
+  if (!s_enabled)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock{s_mutex};
+
+  auto key = std::make_pair(stage, scope);
+  auto itr = s_counters_by_name.find(key);
+  if (itr != s_counters_by_name.end())
+    return itr->second;
+
+  s_counters.emplace_back(new counter_c{stage, scope});
+  s_counters_by_name[key] = s_counters.back().get();
+
+  return s_counters.back().get();
+}
+
+void
+report() {
+  if (!s_enabled)
+    return;
+
+  std::lock_guard<std::mutex> lock{s_mutex};
+
+  auto wall_clock_ns = ns_since_start(std::chrono::steady_clock::now());
+  auto counters      = std::vector<counter_c *>{};
+
+  for (auto const &counter : s_counters)
+    if (counter->m_num_calls)
+      counters.push_back(counter.get());
+
+  std::stable_sort(counters.begin(), counters.end(), [](counter_c const *a, counter_c const *b) { return a->m_self_ns > b->m_self_ns; });
+
+  mxinfo(boost::format(Y("Profiling summary (wall-clock time: %|1$.3f| s; stages running in other threads may overlap):\n")) % (wall_clock_ns / 1000000000.0));
+  mxinfo(boost::format("%|1$21s| %|2$14s| %|3$12s|  %4%\n") % Y("self time") % Y("total time") % Y("calls") % Y("stage"));
+
+  for (auto const counter : counters) {
+    auto self_ns = static_cast<int64_t>(counter->m_self_ns);
+    auto name    = counter->m_scope.empty() ? counter->m_stage : counter->m_stage + " " + counter->m_scope;
+
+    mxinfo(boost::format("%|1$11.1f| ms %|2$5.1f|%% %|3$11.1f| ms %|4$12d|  %5%\n")
+           % (self_ns / 1000000.0)
+           % (wall_clock_ns ? self_ns * 100.0 / wall_clock_ns : 0.0)
+           % (static_cast<int64_t>(counter->m_total_ns) / 1000000.0)
+           % static_cast<int64_t>(counter->m_num_calls)
+           % name);
+  }
+
+  if (s_trace_file_name.empty())
+    return;
+
+  if (s_num_dropped_trace_events)
+    mxwarn(boost::format(Y("The profiling trace file only contains the first %1% events; %2% events were dropped.\n")) % s_trace_events.size() % s_num_dropped_trace_events);
+
+  write_trace_file(wall_clock_ns);
+}
+
+}}
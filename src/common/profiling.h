@@ -0,0 +1,80 @@
+/*
+   mkvtoolnix - A set of programs for manipulating Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   scoped timers for profiling the processing stages
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace mtx { namespace profiling {
+
+// Accumulates the time spent in one stage (e.g. "reader: read") for one
+// scope (e.g. a file name or a track). The total time includes the time
+// spent in nested stages; the self time doesn't.
+class counter_c {
+public:
+  std::string const m_stage, m_scope;
+  std::atomic<int64_t> m_num_calls, m_total_ns, m_self_ns;
+
+public:
+  counter_c(std::string const &stage, std::string const &scope);
+};
+
+// Measures the time between its construction and its destruction and
+// adds it to the counter. Does nothing if the counter is nullptr which
+// is the case if profiling hasn't been enabled. That way the timers are
+// cheap enough to be left in the code.
+class scope_c {
+protected:
+  counter_c *m_counter;
+  scope_c *m_parent;
+  std::chrono::steady_clock::time_point m_start;
+  int64_t m_children_ns;
+  bool m_recursive;
+
+public:
+  explicit scope_c(counter_c *counter)
+    : m_counter{counter}
+  {
+    if (m_counter)
+      start();
+  }
+
+  ~scope_c() {
+    if (m_counter)
+      stop();
+  }
+
+  scope_c(scope_c const &) = delete;
+  scope_c &operator =(scope_c const &) = delete;
+
+protected:
+  void start();
+  void stop();
+};
+
+void enable();
+bool is_enabled();
+void set_trace_file_name(std::string const &file_name);
+
+// Returns the counter for the stage/scope combination, creating it if
+// necessary. Returns nullptr if profiling is disabled. Counters are never
+// deleted; callers should look them up once and store the pointer.
+counter_c *get_counter(std::string const &stage, std::string const &scope = std::string{});
+
+// Outputs a table with all counters sorted by their self times and writes
+// the trace file if one has been requested.
+void report();
+
+}}
@@ -180,3 +180,12 @@ random_c::cleanup() {
   m_dev_urandom.reset();
 #endif
 }
+
+void
+random_c::reset() {
+#if !defined(SYS_WINDOWS)
+  m_dev_urandom.reset();
+  m_tried_dev_urandom = false;
+#endif
+  m_seeded = false;
+}
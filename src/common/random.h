@@ -73,4 +73,8 @@ public:
   static void test();
 #endif
   static void cleanup();
+  // Forgets all state. Must be called in processes forked after
+  // numbers have been generated so that they don't generate the same
+  // numbers as their parent.
+  static void reset();
 };
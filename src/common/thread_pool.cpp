@@ -0,0 +1,76 @@
+/*
+   mkvtoolnix - A set of programs for manipulating Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   a simple pool of worker threads
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/thread_pool.h"
+
+namespace mtx {
+
+thread_pool_c::thread_pool_c(unsigned int num_threads) {
+  for (auto idx = 0u; idx < std::max(num_threads, 1u); ++idx)
+    m_threads.emplace_back([this]() { run_worker(); });
+}
+
+thread_pool_c::~thread_pool_c() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stopping = true;
+  }
+
+  m_job_available.notify_all();
+
+  for (auto &thread : m_threads)
+    thread.join();
+}
+
+std::future<void>
+thread_pool_c::enqueue(std::function<void()> const &job) {
+  std::packaged_task<void()> task{job};
+  auto result = task.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_jobs.push_back(std::move(task));
+  }
+
+  m_job_available.notify_one();
+
+  return result;
+}
+
+void
+thread_pool_c::run_worker() {
+  while (true) {
+    std::packaged_task<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_job_available.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+      if (m_jobs.empty())
+        return;
+
+      task = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    task();
+  }
+}
+
+unsigned int
+thread_pool_c::get_default_num_threads() {
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+}
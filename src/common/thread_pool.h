@@ -0,0 +1,50 @@
+/*
+   mkvtoolnix - A set of programs for manipulating Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   a simple pool of worker threads
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace mtx {
+
+class thread_pool_c {
+protected:
+  std::vector<std::thread> m_threads;
+  std::deque<std::packaged_task<void()>> m_jobs;
+  std::mutex m_mutex;
+  std::condition_variable m_job_available;
+  bool m_stopping{};
+
+public:
+  thread_pool_c(unsigned int num_threads);
+  ~thread_pool_c();
+
+  // Queues the job for execution by one of the worker threads. Exceptions
+  // thrown by the job are re-thrown by the returned future's get().
+  std::future<void> enqueue(std::function<void()> const &job);
+
+  std::size_t get_num_threads() const {
+    return m_threads.size();
+  }
+
+  static unsigned int get_default_num_threads();
+
+protected:
+  void run_worker();
+};
+
+}
@@ -46,6 +46,7 @@ ebml_converter_c::limits_t::limits_t(bool p_has_min,
 }
 
 ebml_converter_c::ebml_converter_c()
+  : m_position_offset{}
 {
 }
 
@@ -163,12 +164,12 @@ void
 ebml_converter_c::parse_uint(parser_context_t &ctx) {
   uint64_t value;
   if (!::parse_number(strip_copy(ctx.content), value))
-    throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), Y("An unsigned integer was expected.") };
+    throw malformed_data_x{ ctx.name, ctx.position, Y("An unsigned integer was expected.") };
 
   if (ctx.limits.has_min && (value < static_cast<uint64_t>(ctx.limits.min)))
-    throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Minimum allowed value: %1%, actual value: %2%")) % ctx.limits.min % value).str() };
+    throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Minimum allowed value: %1%, actual value: %2%")) % ctx.limits.min % value).str() };
   if (ctx.limits.has_max && (value > static_cast<uint64_t>(ctx.limits.max)))
-    throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Maximum allowed value: %1%, actual value: %2%")) % ctx.limits.max % value).str() };
+    throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Maximum allowed value: %1%, actual value: %2%")) % ctx.limits.max % value).str() };
 
   static_cast<EbmlUInteger &>(ctx.e).SetValue(value);
 }
@@ -177,12 +178,12 @@ void
 ebml_converter_c::parse_int(parser_context_t &ctx) {
   int64_t value;
   if (!::parse_number(strip_copy(ctx.content), value))
-    throw malformed_data_x{ ctx.name, ctx.node.offset_debug() };
+    throw malformed_data_x{ ctx.name, ctx.position };
 
   if (ctx.limits.has_min && (value < ctx.limits.min))
-    throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Minimum allowed value: %1%, actual value: %2%")) % ctx.limits.min % value).str() };
+    throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Minimum allowed value: %1%, actual value: %2%")) % ctx.limits.min % value).str() };
   if (ctx.limits.has_max && (value > ctx.limits.max))
-    throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Maximum allowed value: %1%, actual value: %2%")) % ctx.limits.max % value).str() };
+    throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Maximum allowed value: %1%, actual value: %2%")) % ctx.limits.max % value).str() };
 
   static_cast<EbmlSInteger &>(ctx.e).SetValue(value);
 }
@@ -207,13 +208,13 @@ ebml_converter_c::parse_timestamp(parser_context_t &ctx) {
                                     "You may omit the hour as well. Found '%1%' instead. Additional error message: %2%"))
                     % ctx.content % timestamp_parser_error.c_str()).str();
 
-    throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), details };
+    throw malformed_data_x{ ctx.name, ctx.position, details };
   }
 
   if (ctx.limits.has_min && (value < ctx.limits.min))
-    throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Minimum allowed value: %1%, actual value: %2%")) % ctx.limits.min % value).str() };
+    throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Minimum allowed value: %1%, actual value: %2%")) % ctx.limits.min % value).str() };
   if (ctx.limits.has_max && (value > ctx.limits.max))
-    throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Maximum allowed value: %1%, actual value: %2%")) % ctx.limits.max % value).str() };
+    throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Maximum allowed value: %1%, actual value: %2%")) % ctx.limits.max % value).str() };
 
   static_cast<EbmlUInteger &>(ctx.e).SetValue(value);
 }
@@ -222,9 +223,9 @@ void
 ebml_converter_c::parse_binary(parser_context_t &ctx) {
   auto test_min_max = [&ctx](auto const &content) {
     if (ctx.limits.has_min && (content.length() < static_cast<size_t>(ctx.limits.min)))
-      throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Minimum allowed length: %1%, actual length: %2%")) % ctx.limits.min % content.length()).str() };
+      throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Minimum allowed length: %1%, actual length: %2%")) % ctx.limits.min % content.length()).str() };
     if (ctx.limits.has_max && (content.length() > static_cast<size_t>(ctx.limits.max)))
-      throw out_of_range_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Maximum allowed length: %1%, actual length: %2%")) % ctx.limits.max % content.length()).str() };
+      throw out_of_range_x{ ctx.name, ctx.position, (boost::format(Y("Maximum allowed length: %1%, actual length: %2%")) % ctx.limits.max % content.length()).str() };
   };
 
   ctx.handled_attributes["format"] = true;
@@ -233,7 +234,7 @@ ebml_converter_c::parse_binary(parser_context_t &ctx) {
 
   if (balg::starts_with(content, "@")) {
     if (content.length() == 1)
-      throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), Y("No filename found after the '@'.") };
+      throw malformed_data_x{ ctx.name, ctx.position, Y("No filename found after the '@'.") };
 
     auto file_name = content.substr(1);
     try {
@@ -249,7 +250,7 @@ ebml_converter_c::parse_binary(parser_context_t &ctx) {
       static_cast<EbmlBinary &>(ctx.e).CopyBuffer(reinterpret_cast<binary const *>(content.c_str()), size);
 
     } catch (mtx::mm_io::exception &) {
-      throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Could not open/read the file '%1%'.")) % file_name).str() };
+      throw malformed_data_x{ ctx.name, ctx.position, (boost::format(Y("Could not open/read the file '%1%'.")) % file_name).str() };
     }
 
     return;
@@ -262,10 +263,10 @@ ebml_converter_c::parse_binary(parser_context_t &ctx) {
   if (format == "hex") {
     auto hex_content = boost::regex_replace(content, boost::regex{"(0x|\\s|\\r|\\n)+", boost::regex::perl | boost::regex::icase}, "");
     if (boost::regex_search(hex_content, boost::regex{"[^\\da-f]", boost::regex::perl | boost::regex::icase}))
-      throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), Y("Non-hex digits encountered.") };
+      throw malformed_data_x{ ctx.name, ctx.position, Y("Non-hex digits encountered.") };
 
     if ((hex_content.size() % 2) == 1)
-      throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), Y("Invalid length of hexadecimal content: must be divisable by 2.") };
+      throw malformed_data_x{ ctx.name, ctx.position, Y("Invalid length of hexadecimal content: must be divisable by 2.") };
 
     content.clear();
     content.resize(hex_content.size() / 2);
@@ -278,11 +279,11 @@ ebml_converter_c::parse_binary(parser_context_t &ctx) {
       content = mtx::base64::decode(content);
 
     } catch (mtx::base64::exception &) {
-      throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), Y("Invalid data for Base64 encoding found.") };
+      throw malformed_data_x{ ctx.name, ctx.position, Y("Invalid data for Base64 encoding found.") };
     }
 
   } else if (format != "ascii")
-    throw malformed_data_x{ ctx.name, ctx.node.offset_debug(), (boost::format(Y("Invalid 'format' attribute '%1%'.")) % format).str() };
+    throw malformed_data_x{ ctx.name, ctx.position, (boost::format(Y("Invalid 'format' attribute '%1%'.")) % format).str() };
 
   test_min_max(content);
 
@@ -328,6 +329,23 @@ ebml_converter_c::to_xml_recursively(pugi::xml_node &parent,
 ebml_master_cptr
 ebml_converter_c::to_ebml(std::string const &file_name,
                           std::string const &root_name) {
+  auto in     = mm_file_io_c::open(file_name, MODE_READ);
+  auto master = element_reader_c::is_supported(*in) ? to_ebml_element_by_element(*in, root_name) : to_ebml_from_document(file_name, root_name);
+
+  if (!master)
+    return ebml_master_cptr();
+
+  fix_ebml(*master);
+
+  if (debugging_c::requested("ebml_converter"))
+    dump_ebml_elements(master.get(), true);
+
+  return master;
+}
+
+ebml_master_cptr
+ebml_converter_c::to_ebml_from_document(std::string const &file_name,
+                                        std::string const &root_name) {
   auto doc       = load_file(file_name);
   auto root_node = doc->document_element();
   if (!root_node)
@@ -338,22 +356,77 @@ ebml_converter_c::to_ebml(std::string const &file_name,
 
   ebml_master_cptr ebml_root{new KaxSegment};
 
+  m_position_offset = 0;
   to_ebml_recursively(*ebml_root, root_node);
 
-  auto master = dynamic_cast<EbmlMaster *>((*ebml_root)[0]);
-  if (!master)
-    throw conversion_x{Y("The XML root element is not a master element.")};
+  return release_converted_root(*ebml_root);
+}
 
-  fix_ebml(*master);
+ebml_master_cptr
+ebml_converter_c::to_ebml_element_by_element(mm_io_c &in,
+                                             std::string const &root_name) {
+  element_reader_c reader{in};
+  element_reader_c::piece_t piece;
+  pugi::xml_document doc;
 
-  ebml_root->Remove(0);
+  reader.read_root(piece);
 
-  if (debugging_c::requested("ebml_converter"))
-    dump_ebml_elements(master, true);
+  if (root_name != reader.get_root_name())
+    throw conversion_x{boost::format(Y("The root element must be <%1%>.")) % root_name};
+
+  // The root element is read as an empty element so that its
+  // attributes are converted the same way as they are for whole
+  // documents.
+  ebml_master_cptr ebml_root{new KaxSegment};
+
+  load_piece(doc, piece);
+  auto root_node = doc.document_element();
+  to_ebml_recursively(*ebml_root, root_node);
+
+  auto master = release_converted_root(*ebml_root);
+
+  while (reader.read_next_child(piece)) {
+    load_piece(doc, piece);
+    auto node = doc.document_element();
+    to_ebml_recursively(*master, node);
+  }
+
+  m_position_offset = 0;
+
+  return master;
+}
+
+void
+ebml_converter_c::load_piece(pugi::xml_document &doc,
+                             element_reader_c::piece_t const &piece) {
+  auto result = doc.load_buffer(piece.m_content.c_str(), piece.m_content.size(), pugi::parse_default, pugi::encoding_utf8);
+  if (!result) {
+    result.offset += piece.m_position;
+    throw xml_parser_x{result};
+  }
+
+  m_position_offset = piece.m_position;
+}
+
+ebml_master_cptr
+ebml_converter_c::release_converted_root(EbmlMaster &container)
+  const {
+  auto master = dynamic_cast<EbmlMaster *>(container[0]);
+  if (!master)
+    throw conversion_x{Y("The XML root element is not a master element.")};
+
+  container.Remove(0);
 
   return ebml_master_cptr{master};
 }
 
+ptrdiff_t
+ebml_converter_c::get_position(pugi::xml_node const &node)
+  const {
+  auto offset = node.offset_debug();
+  return 0 > offset ? offset : offset + m_position_offset;
+}
+
 void
 ebml_converter_c::to_ebml_recursively(EbmlMaster &parent,
                                       pugi::xml_node &node)
@@ -372,7 +445,7 @@ ebml_converter_c::to_ebml_recursively(EbmlMaster &parent,
       continue;
 
     if (!converted_master)
-      throw invalid_attribute_x{ node.name(), attribute->name(), node.offset_debug() };
+      throw invalid_attribute_x{ node.name(), attribute->name(), get_position(node) };
 
     convert_node_or_attribute_to_ebml(*converted_master, node, *attribute, handled_attributes);
   }
@@ -384,7 +457,7 @@ ebml_converter_c::to_ebml_recursively(EbmlMaster &parent,
     if (converted_master)
       to_ebml_recursively(*converted_master, child);
     else
-      throw invalid_child_node_x{ node.first_child().name(), node.name(), node.offset_debug() };
+      throw invalid_child_node_x{ node.first_child().name(), node.name(), get_position(node) };
   }
 }
 
@@ -399,7 +472,7 @@ ebml_converter_c::convert_node_or_attribute_to_ebml(EbmlMaster &parent,
   auto new_element  = verify_and_create_element(parent, name, node);
   auto limits       = m_limits.find(name);
 
-  parser_context_t ctx { name, value, *new_element, node, handled_attributes, limits == m_limits.end() ? limits_t{} : limits->second };
+  parser_context_t ctx { name, value, *new_element, node, handled_attributes, limits == m_limits.end() ? limits_t{} : limits->second, get_position(node) };
 
   if (dynamic_cast<EbmlUInteger *>(new_element))
     parse_value(ctx, parse_uint);
@@ -417,7 +490,7 @@ ebml_converter_c::convert_node_or_attribute_to_ebml(EbmlMaster &parent,
     parse_value(ctx, parse_binary);
 
   else if (!dynamic_cast<EbmlMaster *>(new_element))
-    throw invalid_child_node_x{ name, get_tag_name(parent), node.offset_debug() };
+    throw invalid_child_node_x{ name, get_tag_name(parent), get_position(node) };
 
   parent.PushElement(*new_element);
 
@@ -430,7 +503,7 @@ ebml_converter_c::verify_and_create_element(EbmlMaster &parent,
                                             pugi::xml_node const &node)
   const {
   if (m_invalid_elements_map.find(name) != m_invalid_elements_map.end())
-    throw invalid_child_node_x{ name, get_tag_name(parent), node.offset_debug() };
+    throw invalid_child_node_x{ name, get_tag_name(parent), get_position(node) };
 
   auto debug_name = get_debug_name(name);
   auto &context   = EBML_CONTEXT(&parent);
@@ -446,13 +519,13 @@ ebml_converter_c::verify_and_create_element(EbmlMaster &parent,
     }
 
   if (!found)
-    throw invalid_child_node_x{ name, get_tag_name(parent), node.offset_debug() };
+    throw invalid_child_node_x{ name, get_tag_name(parent), get_position(node) };
 
   auto semantic = find_ebml_semantic(EBML_INFO(KaxSegment), id);
   if (semantic && EBML_SEM_UNIQUE(*semantic))
     for (auto child : parent)
       if (EbmlId(*child) == id)
-        throw duplicate_child_node_x{ name, get_tag_name(parent), node.offset_debug() };
+        throw duplicate_child_node_x{ name, get_tag_name(parent), get_position(node) };
 
   return create_ebml_element(EBML_INFO(KaxSegment), id);
 }
@@ -16,6 +16,7 @@
 #include "common/common_pch.h"
 
 #include "common/ebml.h"
+#include "common/xml/element_reader.h"
 #include "common/xml/xml.h"
 
 namespace mtx { namespace xml {
@@ -36,6 +37,7 @@ public:
     pugi::xml_node const &node;
     std::map<std::string, bool> &handled_attributes;
     limits_t limits;
+    ptrdiff_t position;
   };
 
   using value_formatter_t = std::function<void(pugi::xml_node &, EbmlElement &)>;
@@ -47,12 +49,16 @@ protected:
   std::map<std::string, value_parser_t> m_parser_map;
   std::map<std::string, limits_t> m_limits;
   std::map<std::string, bool> m_invalid_elements_map;
+  int64_t m_position_offset;
 
 public:
   ebml_converter_c();
   virtual ~ebml_converter_c();
 
   document_cptr to_xml(EbmlElement &e, document_cptr const &destination = document_cptr{}) const;
+  // Documents in UTF-8 are converted one child element of the root at
+  // a time so that only a small part of the XML tree exists at any
+  // time. All other documents are loaded as a whole.
   ebml_master_cptr to_ebml(std::string const &file_name, std::string const &required_root_name);
 
   std::string get_tag_name(EbmlElement &e) const;
@@ -79,6 +85,12 @@ protected:
 
   void to_xml_recursively(pugi::xml_node &parent, EbmlElement &e) const;
 
+  ebml_master_cptr to_ebml_from_document(std::string const &file_name, std::string const &required_root_name);
+  ebml_master_cptr to_ebml_element_by_element(mm_io_c &in, std::string const &required_root_name);
+  void load_piece(pugi::xml_document &doc, element_reader_c::piece_t const &piece);
+  ebml_master_cptr release_converted_root(EbmlMaster &container) const;
+  ptrdiff_t get_position(pugi::xml_node const &node) const;
+
   void to_ebml_recursively(EbmlMaster &parent, pugi::xml_node &node) const;
   EbmlElement *convert_node_or_attribute_to_ebml(EbmlMaster &parent, pugi::xml_node const &node, pugi::xml_attribute const &attribute, std::map<std::string, bool> &handled_attributes) const;
   EbmlElement *verify_and_create_element(EbmlMaster &parent, std::string const &name, pugi::xml_node const &node) const;
@@ -0,0 +1,305 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   reading an XML document element by element
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+#include "common/xml/element_reader.h"
+
+namespace mtx { namespace xml {
+
+namespace {
+std::size_t const s_block_size = 64 * 1024;
+}
+
+element_reader_c::element_reader_c(mm_io_c &in)
+  : m_in(in)
+{
+  fill_to(3);
+  if (balg::starts_with(m_buffer, "\xef\xbb\xbf"))
+    m_buffer.erase(0, 3);
+}
+
+bool
+element_reader_c::is_supported(mm_io_c &in) {
+  in.save_pos();
+
+  std::string head;
+  in.read(head, s_block_size);
+
+  in.restore_pos();
+
+  auto byte_order = BO_NONE;
+  auto bom_length = 0u;
+
+  if (   mm_text_io_c::detect_byte_order_marker(reinterpret_cast<unsigned char const *>(head.c_str()), head.size(), byte_order, bom_length)
+      && (BO_UTF8 != byte_order))
+    return false;
+
+  // UTF-16 and UTF-32 without a byte order marker.
+  if (head.find('\0') != std::string::npos)
+    return false;
+
+  boost::regex encoding_re("^ \\s* "              // ignore leading whitespace
+                           "<\\?xml"              // XML declaration start
+                           "[^\\?]+"              // skip to encoding, but don't go beyond XML declaration
+                           "encoding \\s* = \\s*" // encoding attribute
+                           "[\"'] ( [^\"']+ ) [\"']",
+                           boost::regex::perl | boost::regex::mod_x | boost::regex::icase);
+
+  boost::smatch matches;
+  if (!boost::regex_search(head.cbegin() + bom_length, head.cend(), matches, encoding_re))
+    return true;
+
+  auto encoding = balg::to_lower_copy(matches[1].str());
+
+  return (encoding == "utf-8") || (encoding == "utf8") || (encoding == "us-ascii") || (encoding == "ascii");
+}
+
+bool
+element_reader_c::read_root(piece_t &piece) {
+  auto idx = m_pos;
+
+  while (true) {
+    idx = find("<", idx);
+    if (std::string::npos == idx)
+      throw_error(pugi::status_no_document_element, m_buffer.size());
+
+    auto type = markup_e::other;
+    auto end  = find_end_of_markup(idx, type);
+
+    if (markup_e::end_tag == type)
+      throw_error(pugi::status_end_element_mismatch, idx);
+
+    if (markup_e::other == type) {
+      idx = end;
+      continue;
+    }
+
+    m_root_name        = get_name_at(idx + 1);
+    m_root_open        = markup_e::start_tag == type;
+    piece.m_position   = m_buffer_position + idx;
+    piece.m_content.assign(m_buffer, idx, end - idx);
+
+    if (m_root_open)
+      piece.m_content.insert(piece.m_content.size() - 1, "/");
+
+    m_pos = end;
+    discard_consumed();
+
+    return true;
+  }
+}
+
+bool
+element_reader_c::read_next_child(piece_t &piece) {
+  if (!m_root_open)
+    return false;
+
+  auto idx  = m_pos;
+  auto type = markup_e::other;
+
+  while (true) {
+    idx = find("<", idx);
+    if (std::string::npos == idx)
+      throw_error(pugi::status_end_element_mismatch, m_buffer.size());
+
+    auto end = find_end_of_markup(idx, type);
+
+    if (markup_e::other == type) {
+      idx = end;
+      continue;
+    }
+
+    if (markup_e::end_tag == type) {
+      if (get_name_at(idx + 2) != m_root_name)
+        throw_error(pugi::status_end_element_mismatch, idx);
+
+      m_root_open = false;
+      m_pos       = end;
+      discard_consumed();
+
+      return false;
+    }
+
+    auto start = idx;
+    auto level = markup_e::start_tag == type ? 1 : 0;
+    idx        = end;
+
+    while (0 < level) {
+      idx = find("<", idx);
+      if (std::string::npos == idx)
+        throw_error(pugi::status_end_element_mismatch, m_buffer.size());
+
+      idx = find_end_of_markup(idx, type);
+
+      if (markup_e::start_tag == type)
+        ++level;
+      else if (markup_e::end_tag == type)
+        --level;
+    }
+
+    piece.m_position = m_buffer_position + start;
+    piece.m_content.assign(m_buffer, start, idx - start);
+
+    m_pos = idx;
+    discard_consumed();
+
+    return true;
+  }
+}
+
+bool
+element_reader_c::read_more() {
+  if (m_eof)
+    return false;
+
+  if (!m_in.read(m_buffer, s_block_size, m_buffer.size()))
+    m_eof = true;
+
+  return !m_eof;
+}
+
+bool
+element_reader_c::fill_to(std::size_t end) {
+  while ((m_buffer.size() < end) && read_more())
+    ;
+
+  return m_buffer.size() >= end;
+}
+
+std::size_t
+element_reader_c::find(std::string const &needle,
+                       std::size_t from) {
+  while (true) {
+    auto idx = m_buffer.find(needle, from);
+    if (std::string::npos != idx)
+      return idx;
+
+    // The needle may start within the last bytes already searched.
+    if (m_buffer.size() >= needle.size())
+      from = std::max(from, m_buffer.size() - needle.size() + 1);
+
+    if (!read_more())
+      return std::string::npos;
+  }
+}
+
+std::size_t
+element_reader_c::find_end_of_markup(std::size_t idx,
+                                     markup_e &type) {
+  fill_to(idx + 9);
+
+  auto at = [this, idx](char const *text) {
+    return m_buffer.compare(idx, std::strlen(text), text) == 0;
+  };
+
+  auto skip_to = [this, idx](char const *end_marker, pugi::xml_parse_status status) {
+    auto end = find(end_marker, idx + 2);
+    if (std::string::npos == end)
+      throw_error(status, idx);
+    return end + std::strlen(end_marker);
+  };
+
+  type = markup_e::other;
+
+  if (at("<!--"))
+    return skip_to("-->", pugi::status_bad_comment);
+
+  if (at("<![CDATA["))
+    return skip_to("]]>", pugi::status_bad_cdata);
+
+  if (at("<?"))
+    return skip_to("?>", pugi::status_bad_pi);
+
+  if (at("<!")) {
+    // Document type declarations may contain an internal subset in
+    // square brackets.
+    auto end     = find(">", idx);
+    auto bracket = m_buffer.find('[', idx);
+
+    if ((std::string::npos != end) && (std::string::npos != bracket) && (bracket < end)) {
+      bracket = find("]", bracket);
+      end     = std::string::npos != bracket ? find(">", bracket) : bracket;
+    }
+
+    if (std::string::npos == end)
+      throw_error(pugi::status_bad_doctype, idx);
+
+    return end + 1;
+  }
+
+  auto end = find_end_of_tag(idx);
+
+  type = at("</")                  ? markup_e::end_tag
+       : m_buffer[end - 2] == '/' ? markup_e::empty_element_tag
+       :                            markup_e::start_tag;
+
+  return end;
+}
+
+std::size_t
+element_reader_c::find_end_of_tag(std::size_t idx) {
+  auto is_end_tag = (idx + 1 < m_buffer.size()) && (m_buffer[idx + 1] == '/');
+  auto quote      = '\0';
+  auto pos        = idx + 1;
+
+  while (true) {
+    if (!fill_to(pos + 1))
+      throw_error(is_end_tag ? pugi::status_bad_end_element : pugi::status_bad_start_element, idx);
+
+    auto c = m_buffer[pos];
+
+    if (quote) {
+      if (c == quote)
+        quote = '\0';
+
+    } else if ((c == '"') || (c == '\''))
+      quote = c;
+
+    else if (c == '>')
+      return pos + 1;
+
+    else if (c == '<')
+      throw_error(is_end_tag ? pugi::status_bad_end_element : pugi::status_bad_start_element, idx);
+
+    ++pos;
+  }
+}
+
+std::string
+element_reader_c::get_name_at(std::size_t idx)
+  const {
+  auto end = m_buffer.find_first_of(" \t\r\n/>", idx);
+  return m_buffer.substr(idx, std::string::npos == end ? std::string::npos : end - idx);
+}
+
+void
+element_reader_c::discard_consumed() {
+  m_buffer.erase(0, m_pos);
+  m_buffer_position += m_pos;
+  m_pos              = 0;
+}
+
+void
+element_reader_c::throw_error(pugi::xml_parse_status status,
+                              std::size_t idx)
+  const {
+  pugi::xml_parse_result result;
+  result.status = status;
+  result.offset = m_buffer_position + idx;
+
+  throw xml_parser_x{result};
+}
+
+}}
@@ -0,0 +1,89 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   reading an XML document element by element
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "common/xml/xml.h"
+
+class mm_io_c;
+
+namespace mtx { namespace xml {
+
+// Splits an XML document into the root element's start tag and the
+// root's child elements without parsing the whole document at once.
+// The file is read in blocks; only the element currently being
+// returned is kept in memory. The pieces can then be parsed with
+// pugixml one after the other.
+//
+// Only documents encoded in UTF-8 or a compatible encoding can be
+// split (see is_supported()). Positions are byte offsets relative to
+// the end of the byte order marker just like the offsets pugixml
+// reports for whole documents. Errors in the document's structure are
+// reported by throwing xml_parser_x.
+class element_reader_c {
+public:
+  struct piece_t {
+    std::string m_content;
+    int64_t m_position{};
+  };
+
+protected:
+  enum class markup_e {
+    start_tag,
+    empty_element_tag,
+    end_tag,
+    other,
+  };
+
+  mm_io_c &m_in;
+  std::string m_buffer, m_root_name;
+  std::size_t m_pos{};
+  int64_t m_buffer_position{};
+  bool m_eof{}, m_root_open{};
+
+public:
+  element_reader_c(mm_io_c &in);
+
+  // Returns the root element's start tag converted to an empty element
+  // tag so that it can be parsed on its own. Returns false if the
+  // document doesn't contain any element.
+  bool read_root(piece_t &piece);
+
+  // Returns the next child element of the root element including all
+  // of its children. Returns false once the root's end tag has been
+  // reached.
+  bool read_next_child(piece_t &piece);
+
+  std::string const &get_root_name() const {
+    return m_root_name;
+  }
+
+  // Determines whether or not the document starting at the current
+  // position of 'in' can be split. The position is restored.
+  static bool is_supported(mm_io_c &in);
+
+protected:
+  bool read_more();
+  bool fill_to(std::size_t end);
+  std::size_t find(std::string const &needle, std::size_t from);
+  std::size_t find_end_of_markup(std::size_t idx, markup_e &type);
+  std::size_t find_end_of_tag(std::size_t idx);
+  std::string get_name_at(std::size_t idx) const;
+  void discard_consumed();
+
+  void throw_error(pugi::xml_parse_status status, std::size_t idx) const;
+};
+
+}}
@@ -13,8 +13,6 @@
 
 #include "common/common_pch.h"
 
-#include <sstream>
-
 #include "common/mm_io_x.h"
 #include "common/xml/xml.h"
 
@@ -85,9 +83,8 @@ load_file(std::string const &file_name,
     }
   }
 
-  std::stringstream scontent(content);
   auto doc = std::make_shared<pugi::xml_document>();
-  auto result = doc->load(scontent, options);
+  auto result = doc->load_buffer(content.c_str(), content.size(), options);
   if (!result)
     throw xml_parser_x{result};
 
@@ -31,6 +31,14 @@ console_show_element(int level,
 
 void
 console_show_error(const std::string &error) {
+  if (output_format_e::json == g_options.m_output_format)
+    mxerror(boost::format("%1%\n") % error);
+
+  if (output_format_e::json_lines == g_options.m_output_format) {
+    mxinfo(boost::format("%1%\n") % mtx::json::dump(nlohmann::json{ { "type", "error" }, { "message", error } }));
+    mxexit(2);
+  }
+
   mxinfo(boost::format("(%1%) %2%\n") % NAME % error);
   mxexit(2);
 }
@@ -40,7 +48,8 @@ void
 ui_show_element(int level,
                 const std::string &text,
                 int64_t position,
-                int64_t size) {
+                int64_t size,
+                bool /* children_on_demand */) {
   console_show_element(level, text, position, size);
 }
 
@@ -54,6 +63,11 @@ ui_show_progress(int /* percentage */,
                  const std::string &/* text */) {
 }
 
+bool
+ui_abort_requested() {
+  return false;
+}
+
 int
 ui_run(int /* argc */,
        char **/* argv */) {
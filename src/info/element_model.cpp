@@ -0,0 +1,201 @@
+/*
+   mkvinfo -- utility for gathering information about Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   item model for the element tree of the Qt GUI
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/qt.h"
+#include "info/element_model.h"
+
+element_model_c::element_model_c(QObject *parent)
+  : QAbstractItemModel{parent}
+{
+  reset(QY("no file loaded"));
+}
+
+element_model_c::~element_model_c() {
+}
+
+void
+element_model_c::reset(QString const &file_name) {
+  beginResetModel();
+
+  auto file_node      = std::make_unique<node_t>();
+  file_node->m_text   = file_name;
+  file_node->m_parent = &m_root;
+
+  m_root.m_children.clear();
+  m_root.m_children.push_back(std::move(file_node));
+  m_open_parents = { m_root.m_children.front().get() };
+  m_nodes_on_demand.clear();
+
+  endResetModel();
+}
+
+void
+element_model_c::add_elements(element_info_list_t const &elements) {
+  // Top-level elements (level 0) are children of the node for the
+  // file itself.
+  add_elements(m_open_parents, 0, elements);
+}
+
+void
+element_model_c::add_children(int64_t position,
+                              element_info_list_t const &elements,
+                              bool ok) {
+  auto itr = m_nodes_on_demand.find(position);
+  if (itr == m_nodes_on_demand.end())
+    return;
+
+  auto node = itr->second;
+
+  if (!ok || elements.isEmpty()) {
+    // Don't offer to expand the node again.
+    node->m_children_on_demand = false;
+    auto index                 = index_for(node);
+    emit dataChanged(index, index);
+  }
+
+  auto parents = std::vector<node_t *>{ node };
+  add_elements(parents, node->m_level + 1, elements);
+}
+
+void
+element_model_c::add_elements(std::vector<node_t *> &parents,
+                              int base_level,
+                              element_info_list_t const &elements) {
+  for (auto const &element : elements) {
+    // Levels may be skipped in damaged files. Attach such elements to
+    // the deepest parent available.
+    auto depth = std::min<std::size_t>(std::max(element.m_level - base_level, 0), parents.size() - 1);
+    parents.resize(depth + 1);
+
+    auto parent                = parents.back();
+    auto row                   = static_cast<int>(parent->m_children.size());
+    auto node                  = std::make_unique<node_t>();
+    node->m_text               = element.m_text;
+    node->m_position           = element.m_position;
+    node->m_level              = element.m_level;
+    node->m_parent             = parent;
+    node->m_row                = row;
+    node->m_children_on_demand = element.m_children_on_demand;
+
+    if (node->m_children_on_demand)
+      m_nodes_on_demand[node->m_position] = node.get();
+
+    parents.push_back(node.get());
+
+    beginInsertRows(index_for(parent), row, row);
+    parent->m_children.push_back(std::move(node));
+    endInsertRows();
+  }
+}
+
+element_model_c::node_t *
+element_model_c::node_for(QModelIndex const &index)
+  const {
+  if (!index.isValid())
+    return const_cast<node_t *>(&m_root);
+
+  return static_cast<node_t *>(index.internalPointer());
+}
+
+QModelIndex
+element_model_c::index_for(node_t *node)
+  const {
+  if (!node || (node == &m_root))
+    return {};
+
+  return createIndex(node->m_row, 0, node);
+}
+
+QModelIndex
+element_model_c::index(int row,
+                       int column,
+                       QModelIndex const &parent)
+  const {
+  auto node = node_for(parent);
+
+  if ((0 != column) || (0 > row) || (static_cast<int>(node->m_children.size()) <= row))
+    return {};
+
+  return createIndex(row, column, node->m_children[row].get());
+}
+
+QModelIndex
+element_model_c::parent(QModelIndex const &child)
+  const {
+  if (!child.isValid())
+    return {};
+
+  return index_for(node_for(child)->m_parent);
+}
+
+int
+element_model_c::rowCount(QModelIndex const &parent)
+  const {
+  if (0 < parent.column())
+    return 0;
+
+  return node_for(parent)->m_children.size();
+}
+
+int
+element_model_c::columnCount(QModelIndex const &)
+  const {
+  return 1;
+}
+
+bool
+element_model_c::hasChildren(QModelIndex const &parent)
+  const {
+  auto node = node_for(parent);
+  return !node->m_children.empty() || node->m_children_on_demand;
+}
+
+QVariant
+element_model_c::data(QModelIndex const &index,
+                      int role)
+  const {
+  if (!index.isValid() || (Qt::DisplayRole != role))
+    return {};
+
+  return node_for(index)->m_text;
+}
+
+QVariant
+element_model_c::headerData(int section,
+                            Qt::Orientation orientation,
+                            int role)
+  const {
+  if ((0 != section) || (Qt::Horizontal != orientation) || (Qt::DisplayRole != role))
+    return {};
+
+  return QY("Elements");
+}
+
+bool
+element_model_c::canFetchMore(QModelIndex const &parent)
+  const {
+  auto node = node_for(parent);
+  return node->m_children_on_demand && !node->m_children_requested && node->m_children.empty();
+}
+
+void
+element_model_c::fetchMore(QModelIndex const &parent) {
+  if (!canFetchMore(parent))
+    return;
+
+  auto node                  = node_for(parent);
+  node->m_children_requested = true;
+
+  emit children_requested(node->m_position);
+}
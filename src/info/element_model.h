@@ -0,0 +1,82 @@
+/*
+   mkvinfo -- utility for gathering information about Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   item model for the element tree of the Qt GUI
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <unordered_map>
+
+#include <QAbstractItemModel>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+struct element_info_t {
+  int m_level{};
+  QString m_text;
+  int64_t m_position{-1};
+  bool m_children_on_demand{};
+};
+
+using element_info_list_t = QVector<element_info_t>;
+
+Q_DECLARE_METATYPE(element_info_list_t);
+
+// Holds the elements found so far. Elements whose children are read on
+// demand (clusters) report having children without actually having
+// any. Their children are requested via children_requested() once the
+// view wants to show them and added with add_children().
+class element_model_c: public QAbstractItemModel {
+  Q_OBJECT;
+
+protected:
+  struct node_t {
+    QString m_text;
+    int64_t m_position{-1};
+    node_t *m_parent{};
+    int m_level{-1}, m_row{};
+    std::vector<std::unique_ptr<node_t>> m_children;
+    bool m_children_on_demand{}, m_children_requested{};
+  };
+
+  node_t m_root;
+  std::vector<node_t *> m_open_parents;
+  std::unordered_map<int64_t, node_t *> m_nodes_on_demand;
+
+public:
+  element_model_c(QObject *parent = nullptr);
+  virtual ~element_model_c();
+
+  void reset(QString const &file_name);
+  void add_elements(element_info_list_t const &elements);
+  void add_children(int64_t position, element_info_list_t const &elements, bool ok);
+
+  virtual QModelIndex index(int row, int column, QModelIndex const &parent = QModelIndex{}) const override;
+  virtual QModelIndex parent(QModelIndex const &child) const override;
+  virtual int rowCount(QModelIndex const &parent = QModelIndex{}) const override;
+  virtual int columnCount(QModelIndex const &parent = QModelIndex{}) const override;
+  virtual bool hasChildren(QModelIndex const &parent = QModelIndex{}) const override;
+  virtual QVariant data(QModelIndex const &index, int role = Qt::DisplayRole) const override;
+  virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+  virtual bool canFetchMore(QModelIndex const &parent) const override;
+  virtual void fetchMore(QModelIndex const &parent) override;
+
+signals:
+  void children_requested(qint64 position);
+
+protected:
+  node_t *node_for(QModelIndex const &index) const;
+  QModelIndex index_for(node_t *node) const;
+  void add_elements(std::vector<node_t *> &parents, int base_level, element_info_list_t const &elements);
+};
@@ -39,6 +39,7 @@ info_cli_parser_c::init_parser() {
   OPT("g|gui",           set_gui,           YT("Start the GUI (and open inname if it was given)."));
 #endif
   OPT("c|checksum",      set_checksum,      YT("Calculate and display checksums of frame contents."));
+  OPT("no-checksums",    set_no_checksums,  YT("Do not calculate checksums of frame contents, not even in summary mode. Unless hex dumps are requested only the frame headers are read which is much faster."));
   OPT("C|check-mode",    set_check_mode,    YT("Calculate and display checksums and use verbosity level 4."));
   OPT("s|summary",       set_summary,       YT("Only show summaries of the contents, not each element."));
   OPT("t|track-info",    set_track_info,    YT("Show statistics for each track in verbose mode."));
@@ -46,6 +47,9 @@ info_cli_parser_c::init_parser() {
   OPT("X|full-hexdump",  set_full_hexdump,  YT("Show all bytes of each frame as a hex dump."));
   OPT("p|hex-positions", set_hex_positions, YT("Show positions in hexadecimal."));
   OPT("z|size",          set_size,          YT("Show the size of each element including its header."));
+  OPT("F|output-format=<format>", set_output_format, YT("Sets the output format to 'text' (the default), 'json' (one JSON object containing the element tree) "
+                                                        "or 'json-lines' (one JSON object per element and line). Both JSON formats include statistics for each track "
+                                                        "if the clusters are parsed."));
 
   add_common_options();
 
@@ -75,6 +79,11 @@ info_cli_parser_c::set_checksum() {
   m_options.m_calc_checksums = true;
 }
 
+void
+info_cli_parser_c::set_no_checksums() {
+  m_no_checksums = true;
+}
+
 void
 info_cli_parser_c::set_check_mode() {
   m_options.m_calc_checksums = true;
@@ -124,11 +133,45 @@ info_cli_parser_c::set_hex_positions() {
   m_options.m_hex_positions = true;
 }
 
+void
+info_cli_parser_c::set_output_format() {
+  auto format = balg::to_lower_copy(m_next_arg);
+
+  if (format == "text")
+    m_options.m_output_format = output_format_e::text;
+
+  else if (format == "json")
+    m_options.m_output_format = output_format_e::json;
+
+  else if (format == "json-lines")
+    m_options.m_output_format = output_format_e::json_lines;
+
+  else
+    mxerror(boost::format(Y("Invalid output format in '%1% %2%'.\n")) % m_current_arg % m_next_arg);
+}
+
 options_c
 info_cli_parser_c::run() {
   init_parser();
   parse_args();
 
+  if (m_no_checksums)
+    m_options.m_calc_checksums = false;
+
+  if (output_format_e::text != m_options.m_output_format) {
+    if (m_options.m_show_summary)
+      mxerror(Y("The summary mode cannot be used together with the JSON output formats.\n"));
+
+    m_options.m_use_gui = false;
+
+    if (output_format_e::json == m_options.m_output_format)
+      redirect_warnings_and_errors_to_json();
+  }
+
+  // Frame contents are only needed for checksums and hex dumps. Without
+  // them only the block headers are parsed and the payload is skipped.
+  m_options.m_skip_frame_contents = !m_options.m_calc_checksums && !m_options.m_show_hexdump;
+
   m_options.m_verbose = verbose;
   verbose             = 0;
 
@@ -19,6 +19,7 @@
 class info_cli_parser_c: public mtx::cli::parser_c {
 protected:
   options_c m_options;
+  bool m_no_checksums{};
 
 public:
   info_cli_parser_c(const std::vector<std::string> &args);
@@ -31,6 +32,7 @@ protected:
   void set_gui();
   void set_no_gui();
   void set_checksum();
+  void set_no_checksums();
   void set_check_mode();
   void set_summary();
   void set_hexdump();
@@ -39,4 +41,5 @@ protected:
   void set_file_name();
   void set_track_info();
   void set_hex_positions();
+  void set_output_format();
 };
@@ -66,6 +66,7 @@
 #include "common/fourcc.h"
 #include "common/hevc.h"
 #include "common/hevcc.h"
+#include "common/json.h"
 #include "common/kax_file.h"
 #include "common/math.h"
 #include "common/mm_io.h"
@@ -177,6 +178,9 @@ size_t s_mkvmerge_track_id = 0;
 #define BF_SIZE                              BF_DO(32)
 #define BF_BLOCK_GROUP_DISCARD_PADDING       BF_DO(33)
 #define BF_AT_HEX                            BF_DO(34)
+#define BF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_ADLER BF_DO(35)
+#define BF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_ADLER   BF_DO(36)
+#define BF_SIMPLE_BLOCK_SUMMARY_NO_ADLER     BF_DO(37)
 
 void
 init_common_boost_formats() {
@@ -216,6 +220,9 @@ init_common_boost_formats() {
   BF_ADD(Y(" size %1%"));                                                                                        // 32 -- BF_SIZE
   BF_ADD(Y("Discard padding: %|1$.3f|ms (%2%ns)"));                                                              // 33 -- BF_BLOCK_GROUP_DISCARD_PADDING
   BF_ADD(Y(" at 0x%|1$x|"));                                                                                     // 34 -- BF_AT_HEX
+  BF_ADD(Y("%1% frame, track %2%, timestamp %3% (%4%), duration %|5$.3f|, size %6%%7%%8%\n"));                   // 35 -- BF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_ADLER
+  BF_ADD(Y("%1% frame, track %2%, timestamp %3% (%4%), size %5%%6%%7%\n"));                                      // 36 -- BF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_ADLER
+  BF_ADD(Y("%1% frame, track %2%, timestamp %3% (%4%), size %5%%6%\n"));                                         // 37 -- BF_SIMPLE_BLOCK_SUMMARY_NO_ADLER
 }
 
 std::string
@@ -270,6 +277,119 @@ _show_unknown_element(EbmlStream *es,
   _show_element(e, es, true, level, s);
 }
 
+static nlohmann::json s_json_root;
+static std::vector<nlohmann::json *> s_json_children;
+
+static void
+json_reset() {
+  s_json_root     = nlohmann::json{ { "elements", nlohmann::json::array() }, { "track_statistics", nlohmann::json::array() } };
+  s_json_children = { &s_json_root["elements"] };
+}
+
+static nlohmann::json
+json_element_value(EbmlElement *e) {
+  if (dynamic_cast<KaxInternalBlock *>(e)) {
+    auto &block      = *static_cast<KaxInternalBlock *>(e);
+    auto frame_sizes = nlohmann::json::array();
+
+    for (auto idx = 0u; idx < block.NumberFrames(); ++idx)
+      frame_sizes.push_back(g_options.m_skip_frame_contents ? block.GetFrameSize(idx) : block.GetBuffer(idx).Size());
+
+    auto value = nlohmann::json{
+      { "track_number", block.TrackNum()       },
+      { "timestamp",    block.GlobalTimecode() },
+      { "frame_sizes",  frame_sizes            },
+    };
+
+    if (Is<KaxSimpleBlock>(e)) {
+      value["key"]         = static_cast<KaxSimpleBlock *>(e)->IsKeyframe();
+      value["discardable"] = static_cast<KaxSimpleBlock *>(e)->IsDiscardable();
+    }
+
+    return value;
+  }
+
+  if (dynamic_cast<EbmlUInteger *>(e))
+    return static_cast<EbmlUInteger *>(e)->GetValue();
+
+  if (dynamic_cast<EbmlSInteger *>(e))
+    return static_cast<EbmlSInteger *>(e)->GetValue();
+
+  if (dynamic_cast<EbmlFloat *>(e))
+    return static_cast<EbmlFloat *>(e)->GetValue();
+
+  if (dynamic_cast<EbmlUnicodeString *>(e))
+    return static_cast<EbmlUnicodeString *>(e)->GetValueUTF8();
+
+  if (dynamic_cast<EbmlString *>(e))
+    return std::string(*static_cast<EbmlString *>(e));
+
+  if (dynamic_cast<EbmlDate *>(e))
+    return static_cast<EbmlDate *>(e)->GetEpochDate();
+
+  return nullptr;
+}
+
+static void
+json_show_element(EbmlElement *l,
+                  int level,
+                  std::string const &info) {
+  auto element = nlohmann::json{ { "text", info } };
+
+  if (l) {
+    element["id"]       = EBML_ID_VALUE(static_cast<const EbmlId &>(*l));
+    element["name"]     = EBML_NAME(l);
+    element["position"] = l->GetElementPosition();
+    element["size"]     = l->IsFiniteSize() ? nlohmann::json(l->HeadSize() + l->GetSize()) : nlohmann::json();
+
+    auto value = json_element_value(l);
+    if (!value.is_null())
+      element["value"] = value;
+  }
+
+  if (output_format_e::json_lines == g_options.m_output_format) {
+    element["type"]  = "element";
+    element["level"] = level;
+    mxinfo(boost::format("%1%\n") % mtx::json::dump(element));
+    return;
+  }
+
+  // Elements are attached to the most recent element one level up. The
+  // vector contains the "children" arrays for all currently open levels.
+  level = std::max(std::min<int>(level, s_json_children.size() - 1), 0);
+  s_json_children.resize(level + 1);
+
+  auto &siblings = *s_json_children[level];
+  siblings.push_back(element);
+
+  auto &added       = siblings.back();
+  added["children"] = nlohmann::json::array();
+  s_json_children.push_back(&added["children"]);
+}
+
+static void
+json_remove_empty_children(nlohmann::json &elements) {
+  for (auto &element : elements) {
+    auto &children = element["children"];
+
+    if (children.empty())
+      element.erase("children");
+    else
+      json_remove_empty_children(children);
+  }
+}
+
+static void
+json_finish(std::string const &file_name) {
+  if (output_format_e::json != g_options.m_output_format)
+    return;
+
+  json_remove_empty_children(s_json_root["elements"]);
+  s_json_root["file_name"] = file_name;
+
+  display_json_output(s_json_root);
+}
+
 static void
 _show_element(EbmlElement *l,
               EbmlStream *es,
@@ -279,7 +399,11 @@ _show_element(EbmlElement *l,
   if (g_options.m_show_summary)
     return;
 
-  ui_show_element(level, info,
+  if (output_format_e::text != g_options.m_output_format)
+    json_show_element(l, level, info);
+
+  else
+    ui_show_element(level, info,
                     !l                 ? -1
                   :                      static_cast<int64_t>(l->GetElementPosition()),
                     !l                 ? -1
@@ -402,6 +526,50 @@ read_master(EbmlMaster *m,
   brng::sort(m->GetElementList(), [](EbmlElement const *a, EbmlElement const *b) { return a->GetElementPosition() < b->GetElementPosition(); });
 }
 
+// Reads a finite-sized master element the same way read_master() does
+// but only parses the headers of (Simple)Blocks: track number, timestamp,
+// flags and the lacing information. The frame contents are skipped.
+void
+read_master_frame_headers_only(EbmlMaster *m,
+                               EbmlStream *es) {
+  auto &in     = es->I_O();
+  auto end_pos = m->GetElementPosition() + m->HeadSize() + m->GetSize();
+
+  in.setFilePointer(m->GetElementPosition() + m->HeadSize());
+
+  while (in.getFilePointer() < end_pos) {
+    auto upper_lvl_el = 0;
+    auto l2           = es->FindNextElement(EBML_CONTEXT(m), upper_lvl_el, end_pos - in.getFilePointer(), true);
+
+    if (!l2)
+      break;
+
+    if ((0 != upper_lvl_el) || !l2->IsFiniteSize()) {
+      delete l2;
+      break;
+    }
+
+    auto next_pos = l2->GetElementPosition() + l2->ElementSize();
+
+    if (Is<KaxSimpleBlock, KaxBlock>(l2))
+      static_cast<KaxInternalBlock *>(l2)->ReadData(in, SCOPE_PARTIAL_DATA);
+
+    else if (Is<KaxBlockGroup>(l2))
+      read_master_frame_headers_only(static_cast<EbmlMaster *>(l2), es);
+
+    else if (dynamic_cast<EbmlMaster *>(l2)) {
+      EbmlElement *l3 = nullptr;
+      static_cast<EbmlMaster *>(l2)->Read(*es, EBML_CONTEXT(l2), upper_lvl_el, l3, true);
+      delete l3;
+
+    } else
+      l2->ReadData(in);
+
+    m->PushElement(*l2);
+    in.setFilePointer(next_pos);
+  }
+}
+
 std::string
 format_binary(EbmlBinary &bin,
               size_t max_len = 16) {
@@ -1288,23 +1456,32 @@ handle_block_group(EbmlStream *&es,
                    % format_timestamp(lf_timestamp, 3));
 
       for (size_t i = 0; i < block.NumberFrames(); ++i) {
-        auto &data = block.GetBuffer(i);
-        auto adler = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, data.Buffer(), data.Size());
+        auto frame_size = 0;
+        auto adler      = 0u;
+        std::string adler_str, hex;
 
-        std::string adler_str;
-        if (g_options.m_calc_checksums)
-          adler_str = (BF_BLOCK_GROUP_BLOCK_ADLER % adler).str();
+        if (g_options.m_skip_frame_contents)
+          frame_size = block.GetFrameSize(i);
 
-        std::string hex;
-        if (g_options.m_show_hexdump)
-          hex = create_hexdump(data.Buffer(), data.Size());
+        else {
+          auto &data = block.GetBuffer(i);
+          frame_size = data.Size();
 
-        show_element(nullptr, 4, BF_BLOCK_GROUP_BLOCK_FRAME % data.Size() % adler_str % hex);
+          if (g_options.m_calc_checksums) {
+            adler     = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, data.Buffer(), data.Size());
+            adler_str = (BF_BLOCK_GROUP_BLOCK_ADLER % adler).str();
+          }
 
-        frame_sizes.push_back(data.Size());
+          if (g_options.m_show_hexdump)
+            hex = create_hexdump(data.Buffer(), data.Size());
+        }
+
+        show_element(nullptr, 4, BF_BLOCK_GROUP_BLOCK_FRAME % frame_size % adler_str % hex);
+
+        frame_sizes.push_back(frame_size);
         frame_adlers.push_back(adler);
         frame_hexdumps.push_back(hex);
-        frame_pos -= data.Size();
+        frame_pos -= frame_size;
       }
 
     } else if (Is<KaxBlockDuration>(l3)) {
@@ -1404,7 +1581,26 @@ handle_block_group(EbmlStream *&es,
         frame_pos += frame_sizes[fidx];
       }
 
-      if (bduration != -1.0)
+      if (!g_options.m_calc_checksums && (bduration != -1.0))
+        mxinfo(BF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_ADLER
+               % (num_references >= 2 ? 'B' : num_references == 1 ? 'P' : 'I')
+               % lf_tnum
+               % std::llround(lf_timestamp / 1000000.0)
+               % format_timestamp(lf_timestamp, 3)
+               % bduration
+               % frame_sizes[fidx]
+               % frame_hexdumps[fidx]
+               % position);
+      else if (!g_options.m_calc_checksums)
+        mxinfo(BF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_ADLER
+               % (num_references >= 2 ? 'B' : num_references == 1 ? 'P' : 'I')
+               % lf_tnum
+               % std::llround(lf_timestamp / 1000000.0)
+               % format_timestamp(lf_timestamp, 3)
+               % frame_sizes[fidx]
+               % frame_hexdumps[fidx]
+               % position);
+      else if (bduration != -1.0)
         mxinfo(BF_BLOCK_GROUP_SUMMARY_WITH_DURATION
                % (num_references >= 2 ? 'B' : num_references == 1 ? 'P' : 'I')
                % lf_tnum
@@ -1485,22 +1681,31 @@ handle_simple_block(EbmlStream *&es,
 
   int i;
   for (i = 0; i < (int)block.NumberFrames(); i++) {
-    DataBuffer &data = block.GetBuffer(i);
-    uint32_t adler   = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, data.Buffer(), data.Size());
+    auto frame_size = 0;
+    uint32_t adler  = 0;
+    std::string adler_str, hex;
 
-    std::string adler_str;
-    if (g_options.m_calc_checksums)
-      adler_str = (BF_SIMPLE_BLOCK_ADLER % adler).str();
+    if (g_options.m_skip_frame_contents)
+      frame_size = block.GetFrameSize(i);
 
-    std::string hex;
-    if (g_options.m_show_hexdump)
-      hex = create_hexdump(data.Buffer(), data.Size());
+    else {
+      DataBuffer &data = block.GetBuffer(i);
+      frame_size       = data.Size();
 
-    show_element(nullptr, 3, BF_SIMPLE_BLOCK_FRAME % data.Size() % adler_str % hex);
+      if (g_options.m_calc_checksums) {
+        adler     = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, data.Buffer(), data.Size());
+        adler_str = (BF_SIMPLE_BLOCK_ADLER % adler).str();
+      }
+
+      if (g_options.m_show_hexdump)
+        hex = create_hexdump(data.Buffer(), data.Size());
+    }
 
-    frame_sizes.push_back(data.Size());
+    show_element(nullptr, 3, BF_SIMPLE_BLOCK_FRAME % frame_size % adler_str % hex);
+
+    frame_sizes.push_back(frame_size);
     frame_adlers.push_back(adler);
-    frame_pos -= data.Size();
+    frame_pos -= frame_size;
   }
 
   if (g_options.m_show_summary) {
@@ -1513,14 +1718,23 @@ handle_simple_block(EbmlStream *&es,
         frame_pos += frame_sizes[fidx];
       }
 
-      mxinfo(BF_SIMPLE_BLOCK_SUMMARY
-             % (block.IsKeyframe() ? 'I' : block.IsDiscardable() ? 'B' : 'P')
-             % block.TrackNum()
-             % timestamp_ms
-             % format_timestamp(timestamp_ns, 3)
-             % frame_sizes[fidx]
-             % frame_adlers[fidx]
-             % position);
+      if (!g_options.m_calc_checksums)
+        mxinfo(BF_SIMPLE_BLOCK_SUMMARY_NO_ADLER
+               % (block.IsKeyframe() ? 'I' : block.IsDiscardable() ? 'B' : 'P')
+               % block.TrackNum()
+               % timestamp_ms
+               % format_timestamp(timestamp_ns, 3)
+               % frame_sizes[fidx]
+               % position);
+      else
+        mxinfo(BF_SIMPLE_BLOCK_SUMMARY
+               % (block.IsKeyframe() ? 'I' : block.IsDiscardable() ? 'B' : 'P')
+               % block.TrackNum()
+               % timestamp_ms
+               % format_timestamp(timestamp_ns, 3)
+               % frame_sizes[fidx]
+               % frame_adlers[fidx]
+               % position);
     }
 
   } else if (g_options.m_verbose > 2)
@@ -1545,13 +1759,17 @@ handle_cluster(EbmlStream *&es,
                int64_t file_size) {
   auto cluster = static_cast<KaxCluster *>(l1);
 
-  if (g_options.m_use_gui)
+  if (g_options.m_use_gui && file_size)
     ui_show_progress(100 * cluster->GetElementPosition() / file_size, Y("Parsing file"));
 
   upper_lvl_el               = 0;
   EbmlElement *element_found = nullptr;
   auto m1                    = static_cast<EbmlMaster *>(l1);
-  read_master(m1, es, EBML_CONTEXT(l1), upper_lvl_el, element_found);
+
+  if (g_options.m_skip_frame_contents && cluster->IsFiniteSize())
+    read_master_frame_headers_only(m1, es);
+  else
+    read_master(m1, es, EBML_CONTEXT(l1), upper_lvl_el, element_found);
 
   cluster->InitTimecode(FindChildValue<KaxClusterTimecode>(m1), s_ts_scale);
 
@@ -1691,6 +1909,38 @@ handle_ebml_head(EbmlElement *l0,
   }
 }
 
+// Reads only the head of the next element if it is a cluster with a
+// known size. The GUI lists such clusters without reading their
+// content. Returns nullptr and leaves the file position unchanged
+// otherwise.
+static ebml_element_cptr
+read_cluster_head(mm_io_c &in,
+                  EbmlStream *es) {
+  auto position = in.getFilePointer();
+  auto id       = vint_c::read_ebml_id(in);
+
+  in.setFilePointer(position);
+
+  if (!id.is_valid() || (id.m_value != EBML_ID_VALUE(EBML_ID(KaxCluster))))
+    return {};
+
+  auto upper_lvl_el = 0;
+  auto cluster      = ebml_element_cptr{ es->FindNextElement(EBML_CLASS_CONTEXT(KaxSegment), upper_lvl_el, 0xFFFFFFFFL, true) };
+
+  if (cluster && Is<KaxCluster>(*cluster) && cluster->IsFiniteSize())
+    return cluster;
+
+  in.setFilePointer(position);
+  return {};
+}
+
+static void
+show_cluster_on_demand(EbmlElement *l1,
+                       int64_t file_size) {
+  ui_show_progress(file_size ? 100 * l1->GetElementPosition() / file_size : 0, Y("Parsing file"));
+  ui_show_element(1, Y("Cluster"), l1->GetElementPosition(), l1->IsFiniteSize() ? static_cast<int64_t>(kax_file_c::get_element_size(l1)) : -2, true);
+}
+
 void
 handle_segment(EbmlElement *l0,
                mm_io_cptr &in,
@@ -1710,7 +1960,25 @@ handle_segment(EbmlElement *l0,
   // Prevent reporting "first timestamp after resync":
   kax_file->set_timestamp_scale(-1);
 
-  while ((l1 = kax_file->read_next_level1_element())) {
+  while (!ui_abort_requested()) {
+    // The GUI only builds an index of the clusters here and decodes
+    // their content once the user expands them.
+    auto cluster = g_options.m_use_gui ? read_cluster_head(*in, es) : ebml_element_cptr{};
+    if (cluster) {
+      show_cluster_on_demand(cluster.get(), file_size);
+
+      if (!in->setFilePointer2(cluster->GetElementPosition() + kax_file_c::get_element_size(cluster.get())))
+        break;
+      if (!in_parent(l0))
+        break;
+
+      continue;
+    }
+
+    l1 = kax_file->read_next_level1_element();
+    if (!l1)
+      break;
+
     std::shared_ptr<EbmlElement> af_l1(l1);
 
     if (Is<KaxInfo>(l1))
@@ -1722,6 +1990,9 @@ handle_segment(EbmlElement *l0,
     else if (Is<KaxSeekHead>(l1))
       handle_seek_head(es, upper_lvl_el, l1);
 
+    else if (Is<KaxCluster>(l1) && g_options.m_use_gui)
+      show_cluster_on_demand(l1, file_size);
+
     else if (Is<KaxCluster>(l1)) {
       show_element(l1, 1, Y("Cluster"));
       if ((g_options.m_verbose == 0) && !g_options.m_show_summary)
@@ -1754,7 +2025,9 @@ handle_segment(EbmlElement *l0,
 
 void
 display_track_info() {
-  if (!g_options.m_show_track_info)
+  // Statistics are only available if the clusters have been parsed.
+  if (  ( (output_format_e::text == g_options.m_output_format) && !g_options.m_show_track_info)
+     || ( (output_format_e::text != g_options.m_output_format) && (0 == g_options.m_verbose)))
     return;
 
   for (auto &track : s_tracks) {
@@ -1767,13 +2040,38 @@ display_track_info() {
 
     int64_t duration  = tinfo.m_max_timestamp - tinfo.m_min_timestamp;
     duration         += tinfo.m_add_duration_for_n_packets * track->default_duration;
+    auto bitrate      = static_cast<uint64_t>(duration == 0 ? 0 : tinfo.m_size * 8000000000.0 / duration);
+
+    if (output_format_e::text == g_options.m_output_format) {
+      mxinfo(boost::format(Y("Statistics for track number %1%: number of blocks: %2%; size in bytes: %3%; duration in seconds: %4%; approximate bitrate in bits/second: %5%\n"))
+             % track->tnum
+             % tinfo.m_blocks
+             % tinfo.m_size
+             % (duration / 1000000000.0)
+             % bitrate);
+      continue;
+    }
 
-    mxinfo(boost::format(Y("Statistics for track number %1%: number of blocks: %2%; size in bytes: %3%; duration in seconds: %4%; approximate bitrate in bits/second: %5%\n"))
-           % track->tnum
-           % tinfo.m_blocks
-           % tinfo.m_size
-           % (duration / 1000000000.0)
-           % static_cast<uint64_t>(duration == 0 ? 0 : tinfo.m_size * 8000000000.0 / duration));
+    auto statistics = nlohmann::json{
+      { "track_number",  track->tnum                    },
+      { "blocks",        tinfo.m_blocks                 },
+      { "i_frames",      tinfo.m_blocks_by_ref_num[0]   },
+      { "p_frames",      tinfo.m_blocks_by_ref_num[1]   },
+      { "b_frames",      tinfo.m_blocks_by_ref_num[2]   },
+      { "size",          tinfo.m_size                   },
+      { "min_timestamp", tinfo.m_min_timestamp          },
+      { "max_timestamp", tinfo.m_max_timestamp          },
+      { "duration",      duration                       },
+      { "bitrate",       bitrate                        },
+    };
+
+    if (output_format_e::json == g_options.m_output_format)
+      s_json_root["track_statistics"].push_back(statistics);
+
+    else {
+      statistics["type"] = "track_statistics";
+      mxinfo(boost::format("%1%\n") % mtx::json::dump(statistics));
+    }
   }
 }
 
@@ -1785,6 +2083,7 @@ process_file(const std::string &file_name) {
   s_tracks.clear();
   s_tracks_by_number.clear();
   s_track_info.clear();
+  json_reset();
 
   // open input file
   mm_io_cptr in;
@@ -1826,14 +2125,55 @@ process_file(const std::string &file_name) {
 
       l0->SkipData(*es, EBML_CONTEXT(l0));
 
-      if ((g_options.m_verbose == 0) && !g_options.m_show_summary)
+      if ((g_options.m_verbose == 0) && !g_options.m_show_summary && !g_options.m_use_gui)
         break;
     }
 
-    if (!g_options.m_use_gui && g_options.m_show_track_info)
+    if (!g_options.m_use_gui) {
       display_track_info();
+      json_finish(file_name);
+    }
+
+    return true;
+  } catch (...) {
+    show_error(Y("Caught exception"));
+    return false;
+  }
+}
+
+// Shows the content of the cluster located at "position". Only used by
+// the GUI which requires the file to have been processed with
+// process_file() before as the track headers and the timestamp scale
+// are needed for decoding the blocks.
+bool
+process_cluster(std::string const &file_name,
+                int64_t position) {
+  try {
+    auto in       = mm_file_io_c::open(file_name);
+    auto es_ptr   = std::make_shared<EbmlStream>(*in);
+    auto es       = es_ptr.get();
+    auto kax_file = std::make_shared<kax_file_c>(*in);
+
+    kax_file->set_timestamp_scale(-1);
+    in->setFilePointer(position);
+
+    auto af_l1 = std::shared_ptr<EbmlElement>{ kax_file->read_next_level1_element(EBML_ID_VALUE(EBML_ID(KaxCluster))) };
+    if (!af_l1 || (static_cast<int64_t>(af_l1->GetElementPosition()) != position)) {
+      show_error((boost::format(Y("No cluster found at position %1%.")) % position).str());
+      return false;
+    }
+
+    auto l1           = af_l1.get();
+    auto upper_lvl_el = 0;
+
+    handle_cluster(es, upper_lvl_el, l1, 0);
 
     return true;
+
+  } catch (mtx::mm_io::exception &ex) {
+    show_error((boost::format(Y("Error: Couldn't open source file %1% (%2%).")) % file_name % ex).str());
+    return false;
+
   } catch (...) {
     show_error(Y("Caught exception"));
     return false;
@@ -23,13 +23,15 @@ extern options_c g_options;
 
 int console_main();
 bool process_file(const std::string &file_name);
+bool process_cluster(std::string const &file_name, int64_t position);
 void setup(char const *argv0, const std::string &locale = "");
 void cleanup();
 
 std::string create_element_text(const std::string &text, int64_t position, int64_t size);
 void ui_show_error(const std::string &error);
-void ui_show_element(int level, const std::string &text, int64_t position, int64_t size);
+void ui_show_element(int level, const std::string &text, int64_t position, int64_t size, bool children_on_demand = false);
 void ui_show_progress(int percentage, const std::string &text);
+bool ui_abort_requested();
 int ui_run(int argc, char **argv);
 bool ui_graphical_available();
 
@@ -21,7 +21,9 @@ options_c::options_c()
   , m_show_size(false)
   , m_show_track_info(false)
   , m_hex_positions{}
+  , m_skip_frame_contents{}
   , m_hexdump_max_size(16)
   , m_verbose(0)
+  , m_output_format{output_format_e::text}
 {
 }
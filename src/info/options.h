@@ -12,11 +12,18 @@
 
 #include "common/common_pch.h"
 
+enum class output_format_e {
+  text,
+  json,
+  json_lines,
+};
+
 class options_c {
 public:
   std::string m_file_name;
-  bool m_use_gui, m_calc_checksums, m_show_summary, m_show_hexdump, m_show_size, m_show_track_info, m_hex_positions;
+  bool m_use_gui, m_calc_checksums, m_show_summary, m_show_hexdump, m_show_size, m_show_track_info, m_hex_positions, m_skip_frame_contents;
   int m_hexdump_max_size, m_verbose;
+  output_format_e m_output_format;
 public:
   options_c();
 };
@@ -36,10 +36,109 @@
 using namespace libebml;
 using namespace libmatroska;
 
-main_window_c::main_window_c():
-  last_percent(-1), num_elements(0),
-  root(nullptr) {
+element_reader_c::element_reader_c()
+  : m_generation{}
+  , m_running_generation{}
+  , m_cluster_position{-1}
+  , m_last_percentage{-1}
+{
+}
+
+quint64
+element_reader_c::start_new_generation() {
+  return ++m_generation;
+}
+
+bool
+element_reader_c::is_obsolete()
+  const {
+  return m_running_generation != m_generation;
+}
+
+void
+element_reader_c::read_file(QString const &file_name,
+                            quint64 generation,
+                            int verbosity) {
+  m_running_generation = generation;
+  if (is_obsolete())
+    return;
+
+  g_options.m_verbose = verbosity;
+  m_cluster_position  = -1;
+  m_last_percentage   = -1;
+  m_pending.clear();
+  m_last_flush.start();
+
+  auto ok = process_file(to_utf8(file_name));
+
+  flush();
+  emit file_read(generation, ok && !is_obsolete());
+}
+
+void
+element_reader_c::read_cluster(QString const &file_name,
+                               quint64 generation,
+                               qint64 position) {
+  m_running_generation = generation;
+  if (is_obsolete())
+    return;
+
+  m_cluster_position = position;
+  m_pending.clear();
+
+  auto ok = process_cluster(to_utf8(file_name), position);
+
+  emit cluster_read(generation, position, m_pending, ok);
+
+  m_cluster_position = -1;
+  m_pending.clear();
+}
 
+void
+element_reader_c::add_element(int level,
+                              QString const &text,
+                              int64_t position,
+                              bool children_on_demand) {
+  m_pending.push_back({ level, text, position, children_on_demand });
+
+  // The children of a cluster are sent all at once.
+  if (   (-1 == m_cluster_position)
+      && ((1000 <= m_pending.size()) || (200 <= m_last_flush.elapsed())))
+    flush();
+}
+
+void
+element_reader_c::flush() {
+  if (!m_pending.isEmpty() && !is_obsolete())
+    emit elements_read(m_running_generation, m_pending);
+
+  m_pending.clear();
+  m_last_flush.restart();
+}
+
+void
+element_reader_c::report_progress(int percentage,
+                                  QString const &text) {
+  if ((-1 != m_cluster_position) || ((percentage / 5) == (m_last_percentage / 5)))
+    return;
+
+  m_last_percentage = percentage;
+  emit progress_changed(percentage, text);
+}
+
+void
+element_reader_c::report_error(QString const &message) {
+  if (!is_obsolete())
+    emit error_found(message);
+}
+
+// ------------------------------------------------------------
+
+main_window_c::main_window_c()
+  : m_generation{}
+  , m_expansion_pending{}
+  , m_model{new element_model_c{this}}
+{
   setupUi(this);
 
   QIcon icon;
@@ -65,15 +164,39 @@ main_window_c::main_window_c():
   action_Expand_important->setCheckable(true);
   action_Expand_important->setChecked(true);
 
-  tree->setHeaderLabels(QStringList(QY("Elements")));
+  tree->setModel(m_model);
   tree->setRootIsDecorated(true);
+  tree->setUniformRowHeights(true);
+
+  m_reader.moveToThread(&m_reader_thread);
+
+  connect(this,      &main_window_c::file_requested,        &m_reader, &element_reader_c::read_file);
+  connect(this,      &main_window_c::cluster_requested,     &m_reader, &element_reader_c::read_cluster);
+  connect(&m_reader, &element_reader_c::elements_read,      this,      &main_window_c::add_elements);
+  connect(&m_reader, &element_reader_c::file_read,          this,      &main_window_c::finish_file);
+  connect(&m_reader, &element_reader_c::cluster_read,       this,      &main_window_c::add_cluster_children);
+  connect(&m_reader, &element_reader_c::progress_changed,   this,      &main_window_c::show_progress);
+  connect(&m_reader, &element_reader_c::error_found,        this,      &main_window_c::show_error);
+  connect(m_model,   &element_model_c::children_requested,  this,      &main_window_c::request_cluster_children);
 
-  root = new QTreeWidgetItem(tree);
-  root->setText(0, QY("no file loaded"));
+  m_reader_thread.start();
 
   setAcceptDrops(true);
 }
 
+main_window_c::~main_window_c() {
+  // Make a running parser stop at the next level 1 element.
+  m_reader.start_new_generation();
+
+  m_reader_thread.quit();
+  m_reader_thread.wait();
+}
+
+element_reader_c &
+main_window_c::reader() {
+  return m_reader;
+}
+
 void
 main_window_c::open() {
   auto matroska_extensions = Q("*.mkv *.mka *.mks *.mk3d");
@@ -101,19 +224,19 @@ main_window_c::save_text_file() {
     return;
   }
 
-  write_tree(file, root, 0);
+  // Only the content of clusters that have been expanded so far is
+  // written.
+  write_tree(file, m_model->index(0, 0), 0);
 
   file.close();
 }
 
 void
 main_window_c::write_tree(QFile &file,
-                          QTreeWidgetItem *item,
+                          QModelIndex const &parent,
                           int level) {
-  int i;
-
-  for (i = 0; item->childCount() > i; ++i) {
-    QTreeWidgetItem *child = item->child(i);
+  for (int row = 0, num_rows = m_model->rowCount(parent); row < num_rows; ++row) {
+    auto child = m_model->index(row, 0, parent);
 
     char *level_buffer = new char[level + 1];
     level_buffer[0] = '|';
@@ -121,14 +244,15 @@ main_window_c::write_tree(QFile &file,
     level_buffer[level] = 0;
 
     file.write(level_buffer, level);
-    file.write(QString("+ %1\n").arg(child->text(0)).toUtf8());
+    file.write(QString("+ %1\n").arg(child.data().toString()).toUtf8());
     write_tree(file, child, level + 1);
+
+    delete []level_buffer;
   }
 }
 
 void
 main_window_c::show_all() {
-  g_options.m_verbose = action_Show_all->isChecked() ? 2 : 0;
   if (!current_file.isEmpty())
     parse_file(current_file);
 }
@@ -158,95 +282,129 @@ main_window_c::parse_file(const QString &file_name) {
   auto title = Q("%1 – mkvinfo").arg(QFileInfo{file_name}.fileName());
   setWindowTitle(title);
 
-  tree->setEnabled(false);
-  tree->clear();
-
-  root = new QTreeWidgetItem(tree);
-  root->setText(0, file_name);
+  m_model->reset(file_name);
 
-  last_percent = -1;
-  num_elements = 0;
+  current_file        = file_name;
+  m_generation        = m_reader.start_new_generation();
+  m_expansion_pending = action_Expand_important->isChecked();
   action_Save_text_file->setEnabled(false);
 
-  parent_items.clear();
-  parent_items.append(root);
+  tree->expand(m_model->index(0, 0));
+  statusBar()->showMessage(QY("Parsing file"));
+
+  // The parser runs on the reader thread. Only the level 1 elements are
+  // read right away; the content of clusters is read once they are
+  // expanded.
+  emit file_requested(file_name, m_generation, action_Show_all->isChecked() ? 2 : 0);
+}
+
+void
+main_window_c::add_elements(quint64 generation,
+                            element_info_list_t const &elements) {
+  if (generation != m_generation)
+    return;
 
-  if (process_file(file_name.toUtf8().data())) {
+  m_model->add_elements(elements);
+
+  // Expand the important elements as soon as they're available instead
+  // of waiting for the whole file to be indexed.
+  if (m_expansion_pending && expand_elements())
+    m_expansion_pending = false;
+}
+
+void
+main_window_c::finish_file(quint64 generation,
+                           bool ok) {
+  if (generation != m_generation)
+    return;
+
+  if (ok) {
     action_Save_text_file->setEnabled(true);
-    current_file = file_name;
-    if (action_Expand_important->isChecked())
+    if (m_expansion_pending)
       expand_elements();
   }
 
+  m_expansion_pending = false;
+
   statusBar()->showMessage(QY("Ready"), 5000);
+}
 
-  tree->setEnabled(true);
+void
+main_window_c::request_cluster_children(qint64 position) {
+  emit cluster_requested(current_file, m_generation, position);
 }
 
 void
-main_window_c::expand_all_elements(QTreeWidgetItem *item,
-                                   bool expand) {
-  int i;
+main_window_c::add_cluster_children(quint64 generation,
+                                    qint64 position,
+                                    element_info_list_t const &elements,
+                                    bool ok) {
+  if (generation == m_generation)
+    m_model->add_children(position, elements, ok);
+}
+
+void
+main_window_c::expand_all_elements(QModelIndex const &index,
+                                   bool expand,
+                                   bool fetch_children) {
+  // Expanding an element whose children haven't been read yet would
+  // trigger reading them, e.g. reading all clusters when expanding the
+  // segment.
+  if (expand && !fetch_children && m_model->canFetchMore(index))
+    return;
 
   if (expand)
-    tree->expandItem(item);
+    tree->expand(index);
   else
-    tree->collapseItem(item);
-  for (i = 0; item->childCount() > i; ++i)
-    expand_all_elements(item->child(i), expand);
+    tree->collapse(index);
+
+  for (int row = 0, num_rows = m_model->rowCount(index); row < num_rows; ++row)
+    expand_all_elements(m_model->index(row, 0, index), expand, false);
 }
 
-void
+// Returns whether or not the segment tracks have been found.
+bool
 main_window_c::expand_elements() {
-  int l0, l1, c0, c1;
-  QTreeWidgetItem *i0, *i1;
   const QString s_segment(QY("Segment"));
   const QString s_info(QY("Segment information"));
   const QString s_tracks(QY("Segment tracks"));
+  auto found_tracks = false;
+  auto file_index   = m_model->index(0, 0);
 
   setUpdatesEnabled(false);
 
-  expand_all_elements(root, false);
-  tree->expandItem(root);
-
-  c0 = root->childCount();
-  for (l0 = 0; l0 < c0; ++l0) {
-    i0 = root->child(l0);
-    tree->expandItem(i0);
-    if (i0->text(0).left(7) == s_segment) {
-      c1 = i0->childCount();
-      for (l1 = 0; l1 < c1; ++l1) {
-        i1 = i0->child(l1);
-        if ((i1->text(0).left(19) == s_info) ||
-            (i1->text(0).left(14) == s_tracks))
-          expand_all_elements(i1, true);
+  tree->expand(file_index);
+
+  for (int l0 = 0, c0 = m_model->rowCount(file_index); l0 < c0; ++l0) {
+    auto i0 = m_model->index(l0, 0, file_index);
+    tree->expand(i0);
+
+    if (i0.data().toString().left(7) != s_segment)
+      continue;
+
+    for (int l1 = 0, c1 = m_model->rowCount(i0); l1 < c1; ++l1) {
+      auto i1   = m_model->index(l1, 0, i0);
+      auto text = i1.data().toString();
+
+      if (text.left(19) == s_info)
+        expand_all_elements(i1, true, false);
+
+      else if (text.left(14) == s_tracks) {
+        expand_all_elements(i1, true, false);
+        found_tracks = true;
       }
     }
   }
 
   setUpdatesEnabled(true);
-}
 
-void
-main_window_c::add_item(int level,
-                        const QString &text) {
-  ++level;
-
-  while (parent_items.count() > level)
-    parent_items.erase(parent_items.end() - 1);
-  QTreeWidgetItem *item = new QTreeWidgetItem(parent_items.last());
-  item->setText(0, text);
-  parent_items.append(item);
+  return found_tracks;
 }
 
 void
 main_window_c::show_progress(int percentage,
                              const QString &text) {
-  if ((percentage / 5) != (last_percent / 5)) {
-    statusBar()->showMessage(QString("%1: %2%").arg(text).arg(percentage));
-    last_percent = percentage;
-    QCoreApplication::processEvents();
-  }
+  statusBar()->showMessage(QString("%1: %2%").arg(text).arg(percentage));
 }
 
 void
@@ -277,26 +435,29 @@ main_window_c::dropEvent(QDropEvent *event) {
 static main_window_c *gui;
 
 rightclick_tree_widget::rightclick_tree_widget(QWidget *parent):
-  QTreeWidget(parent) {
+  QTreeView(parent) {
 }
 
 void
 rightclick_tree_widget::mousePressEvent(QMouseEvent *event) {
   if (event->button() != Qt::RightButton) {
-    QTreeWidget::mousePressEvent(event);
+    QTreeView::mousePressEvent(event);
     return;
   }
 
-  QTreeWidgetItem *item = itemAt(event->pos());
-  if (item) {
-    gui->expand_all_elements(item, !item->isExpanded());
+  auto index = indexAt(event->pos());
+  if (index.isValid()) {
+    gui->expand_all_elements(index, !isExpanded(index));
   }
 }
 
+// The following functions are called by the parser. In GUI mode the
+// parser runs on the reader thread and must not access any widget.
+
 void
 ui_show_error(const std::string &error) {
   if (g_options.m_use_gui)
-    gui->show_error(Q(error));
+    gui->reader().report_error(Q(error));
   else
     console_show_error(error);
 }
@@ -305,21 +466,27 @@ void
 ui_show_element(int level,
                 const std::string &text,
                 int64_t position,
-                int64_t size) {
+                int64_t size,
+                bool children_on_demand) {
   if (!g_options.m_use_gui)
     console_show_element(level, text, position, size);
 
   else if (0 <= position)
-    gui->add_item(level, Q(create_element_text(text, position, size)));
+    gui->reader().add_element(level, Q(create_element_text(text, position, size)), position, children_on_demand);
 
   else
-    gui->add_item(level, Q(text));
+    gui->reader().add_element(level, Q(text), position, children_on_demand);
 }
 
 void
 ui_show_progress(int percentage,
                  const std::string &text) {
-  gui->show_progress(percentage, Q(text));
+  gui->reader().report_progress(percentage, Q(text));
+}
+
+bool
+ui_abort_requested() {
+  return g_options.m_use_gui && gui->reader().is_obsolete();
 }
 
 int
@@ -339,6 +506,8 @@ ui_run(int argc,
   QApplication::setStyle(Q("windowsvista"));
 #endif
 
+  qRegisterMetaType<element_info_list_t>("element_info_list_t");
+
   main_window_c main_window;
   gui = &main_window;
   main_window.show();
@@ -14,15 +14,61 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
+
+#include <QElapsedTimer>
 #include <QFile>
 #include <QMainWindow>
+#include <QModelIndex>
 #include <QString>
-#include <QTreeWidgetItem>
-#include <QVector>
+#include <QThread>
 
 #include "common/qt.h"
+#include "info/element_model.h"
 #include "info/ui/mainwindow.h"
 
+// Runs the parser on a background thread. The elements found are
+// collected and handed over to the GUI thread in batches. Each request
+// carries a generation number; requests for an older generation are
+// skipped, and a running parse is aborted as soon as a new generation
+// has been started.
+class element_reader_c: public QObject {
+  Q_OBJECT;
+
+protected:
+  std::atomic<quint64> m_generation;
+  quint64 m_running_generation;
+  qint64 m_cluster_position;
+  int m_last_percentage;
+  element_info_list_t m_pending;
+  QElapsedTimer m_last_flush;
+
+public:
+  element_reader_c();
+
+  quint64 start_new_generation();
+  bool is_obsolete() const;
+
+  // Called from the parser on the reader thread.
+  void add_element(int level, QString const &text, int64_t position, bool children_on_demand);
+  void report_progress(int percentage, QString const &text);
+  void report_error(QString const &message);
+
+public slots:
+  void read_file(QString const &file_name, quint64 generation, int verbosity);
+  void read_cluster(QString const &file_name, quint64 generation, qint64 position);
+
+signals:
+  void elements_read(quint64 generation, element_info_list_t const &elements);
+  void file_read(quint64 generation, bool ok);
+  void cluster_read(quint64 generation, qint64 position, element_info_list_t const &elements, bool ok);
+  void progress_changed(int percentage, QString const &text);
+  void error_found(QString const &message);
+
+protected:
+  void flush();
+};
+
 class main_window_c: public QMainWindow, public Ui_main_window {
   Q_OBJECT;
 
@@ -34,25 +80,37 @@ private slots:
 
   void about();
 
-private:
-  int last_percent, num_elements;
+  void add_elements(quint64 generation, element_info_list_t const &elements);
+  void finish_file(quint64 generation, bool ok);
+  void add_cluster_children(quint64 generation, qint64 position, element_info_list_t const &elements, bool ok);
+  void request_cluster_children(qint64 position);
+
+signals:
+  void file_requested(QString const &file_name, quint64 generation, int verbosity);
+  void cluster_requested(QString const &file_name, quint64 generation, qint64 position);
 
-  QVector<QTreeWidgetItem *> parent_items;
+private:
   QString current_file;
-  QTreeWidgetItem *root;
+  quint64 m_generation;
+  bool m_expansion_pending;
+
+  element_model_c *m_model;
+  element_reader_c m_reader;
+  QThread m_reader_thread;
 
-  void expand_elements();
-  void write_tree(QFile &file, QTreeWidgetItem *item, int level);
+  bool expand_elements();
+  void write_tree(QFile &file, QModelIndex const &parent, int level);
 
 public:
   main_window_c();
+  virtual ~main_window_c();
+
+  element_reader_c &reader();
 
   void show_error(const QString &message);
   void show_progress(int percentage, const QString &text);
 
-  void add_item(int level, const QString &text);
-
-  void expand_all_elements(QTreeWidgetItem *item, bool expand);
+  void expand_all_elements(QModelIndex const &index, bool expand, bool fetch_children = true);
 
   void parse_file(const QString &file_name);
 
@@ -14,9 +14,9 @@
 
 #include "common/common_pch.h"
 
-#include <QTreeWidget>
+#include <QTreeView>
 
-class rightclick_tree_widget: public QTreeWidget {
+class rightclick_tree_widget: public QTreeView {
   Q_OBJECT;
 
 public slots:
@@ -656,6 +656,11 @@ avi_reader_c::set_avc_nal_size_size(avc_es_video_packetizer_c *ptzr) {
   }
 
   AVI_set_video_position(m_avi, 0);
+
+  // AVC with framed packets (without NALU start codes but with length
+  // fields): the packetizer splits the frames itself.
+  if (0 < m_avc_nal_size_size)
+    ptzr->set_source_nalu_size_length(m_avc_nal_size_size);
 }
 
 file_status_e
@@ -708,30 +713,7 @@ avi_reader_c::read_video() {
 
   m_dropped_video_frames += dropped_frames_here;
 
-  // AVC with framed packets (without NALU start codes but with length fields)
-  // or non-AVC video track?
-  if (0 >= m_avc_nal_size_size)
-    PTZR(m_vptzr)->process(new packet_t(chunk, timestamp, duration, key ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
-
-  else {
-    // AVC video track without NALU start codes. Re-frame with NALU start codes.
-    int offset = 0;
-
-    while ((offset + m_avc_nal_size_size) < num_read) {
-      int nalu_size  = get_uint_be(chunk->get_buffer() + offset, m_avc_nal_size_size);
-      offset        += m_avc_nal_size_size;
-
-      if ((offset + nalu_size) > num_read)
-        break;
-
-      memory_cptr nalu = memory_c::alloc(4 + nalu_size);
-      put_uint32_be(nalu->get_buffer(), NALU_START_CODE);
-      memcpy(nalu->get_buffer() + 4, chunk->get_buffer() + offset, nalu_size);
-      offset += nalu_size;
-
-      PTZR(m_vptzr)->process(new packet_t(nalu, timestamp, duration, key ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
-    }
-  }
+  PTZR(m_vptzr)->process(new packet_t(chunk, timestamp, duration, key ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
 
   m_bytes_processed += num_read;
 
@@ -925,7 +907,7 @@ avi_reader_c::identify_attachments() {
   }
 
   for (auto const &attachment : g_attachments)
-    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->data->get_size(), attachment->name, attachment->description);
+    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->get_data_size(), attachment->name, attachment->description);
 }
 
 void
@@ -361,7 +361,7 @@ flac_reader_c::identify() {
   id_result_container();
   id_result_track(0, ID_RESULT_TRACK_AUDIO, "FLAC", info.get());
   for (auto &attachment : g_attachments)
-    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->data->get_size(), attachment->name, attachment->description, attachment->id);
+    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->get_data_size(), attachment->name, attachment->description, attachment->id);
 }
 
 #else  // HAVE_FLAC_FORMAT_H
@@ -2220,17 +2220,39 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
       return FILE_STATUS_HOLDING;
   }
 
+  if (!m_cluster_walker) {
+    m_cluster_walker = std::make_shared<kax_cluster_walker_c>(*m_in);
+    m_cluster_walker->set_timestamp_scale(m_tc_scale);
+    m_cluster_walker->set_segment_end(m_in_file->get_segment_end());
+
+    // Blocks of tracks that aren't multiplexed are only needed for their
+    // timestamps. Blocks of unknown tracks are kept so that the usual
+    // warning is still shown.
+    m_cluster_walker->set_track_filter([this](uint64_t track_number) -> bool {
+      auto track = find_track_by_num(track_number);
+      return !track || (-1 != track->ptzr);
+    });
+  }
+
   try {
-    KaxCluster *cluster = m_in_file->read_next_cluster();
-    if (!cluster) {
-      flush_packetizers();
+    // Clusters are normally parsed by the cluster walker. libebml is
+    // only used for those it cannot handle as its resync logic copes
+    // with damaged files.
+    auto cluster = std::unique_ptr<KaxCluster>{};
+
+    if (!m_cluster_walker->read_cluster()) {
+      cluster.reset(m_in_file->read_next_cluster());
+      if (!cluster) {
+        flush_packetizers();
+
+        m_file_status = FILE_STATUS_DONE;
+        return FILE_STATUS_DONE;
+      }
 
-      m_file_status = FILE_STATUS_DONE;
-      return FILE_STATUS_DONE;
+      m_cluster_walker->use_cluster(*cluster);
     }
 
-    auto cluster_ts = FindChildValue<KaxClusterTimecode>(cluster);
-    cluster->InitTimecode(cluster_ts, m_tc_scale);
+    auto cluster_ts = m_cluster_walker->get_cluster_timestamp();
 
     if (-1 == m_first_timestamp) {
       m_first_timestamp = cluster_ts * m_tc_scale;
@@ -2241,19 +2263,13 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
         mtx::chapters::adjust_timestamps(*m_chapters, -m_first_timestamp);
     }
 
-    size_t bgidx;
-    for (bgidx = 0; bgidx < cluster->ListSize(); bgidx++) {
-      EbmlElement *element = (*cluster)[bgidx];
-
-      if (Is<KaxSimpleBlock>(element))
-        process_simple_block(cluster, static_cast<KaxSimpleBlock *>(element));
-
-      else if (Is<KaxBlockGroup>(element))
-        process_block_group(cluster, static_cast<KaxBlockGroup *>(element));
+    for (auto &block : m_cluster_walker->get_blocks()) {
+      if (block.m_simple_block)
+        process_simple_block(block);
+      else
+        process_block_group(block);
     }
 
-    delete cluster;
-
   } catch (...) {
     mxwarn(boost::format("%1% %2% %3%\n")
            % (boost::format(Y("%1%: an unknown exception occurred.")) % "kax_reader_c::read()")
@@ -2266,20 +2282,19 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
 }
 
 void
-kax_reader_c::process_simple_block(KaxCluster *cluster,
-                                   KaxSimpleBlock *block_simple) {
+kax_reader_c::process_simple_block(kax_cluster_walker_c::block_t &block) {
   int64_t block_duration = -1;
   int64_t block_bref     = VFT_IFRAME;
   int64_t block_fref     = VFT_NOBFRAME;
 
-  block_simple->SetParent(*cluster);
-  auto block_track     = find_track_by_num(block_simple->TrackNum());
-  auto block_timestamp = mtx::math::to_signed(block_simple->GlobalTimecode()) + m_global_timestamp_offset;
+  auto block_track     = find_track_by_num(block.m_track_number);
+  auto block_timestamp = block.m_timestamp + m_global_timestamp_offset;
+  auto num_frames      = block.m_frames.size();
 
   if (!block_track) {
     mxwarn_fn(m_ti.m_fname,
               boost::format(Y("A block was found at timestamp %1% for track number %2%. However, no headers where found for that track number. "
-                              "The block will be skipped.\n")) % format_timestamp(block_timestamp) % block_simple->TrackNum());
+                              "The block will be skipped.\n")) % format_timestamp(block_timestamp) % block.m_track_number);
     return;
   }
 
@@ -2296,8 +2311,8 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
       block_duration = 0;
   }
 
-  auto key_flag         = block_simple->IsKeyframe();
-  auto discardable_flag = block_simple->IsDiscardable();
+  auto key_flag         = block.m_key;
+  auto discardable_flag = block.m_discardable;
 
   if (!key_flag) {
     if (discardable_flag)
@@ -2307,8 +2322,8 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
   }
 
   m_last_timestamp = block_timestamp;
-  if (0 < block_simple->NumberFrames())
-    m_in_file->set_last_timestamp(m_last_timestamp + (block_simple->NumberFrames() - 1) * frame_duration);
+  if (0 < num_frames)
+    m_in_file->set_last_timestamp(m_last_timestamp + (num_frames - 1) * frame_duration);
 
   // If we're appending this file to another one then the core
   // needs the timestamps shifted to zero.
@@ -2320,9 +2335,8 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
     // any special cases, e.g. 0 terminating a string for the subs
     // and stuff. Just pass everything through as it is.
     size_t i;
-    for (i = 0; block_simple->NumberFrames() > i; ++i) {
-      DataBuffer &data_buffer = block_simple->GetBuffer(i);
-      memory_cptr data(new memory_c(data_buffer.Buffer(), data_buffer.Size(), false));
+    for (i = 0; num_frames > i; ++i) {
+      auto &data = block.m_frames[i];
       block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
 
       packet_cptr packet(new packet_t(data, m_last_timestamp + i * frame_duration, block_duration, block_bref, block_fref));
@@ -2334,9 +2348,8 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
 
   } else if (-1 != block_track->ptzr) {
     size_t i;
-    for (i = 0; i < block_simple->NumberFrames(); i++) {
-      DataBuffer &data_buffer = block_simple->GetBuffer(i);
-      memory_cptr data(new memory_c(data_buffer.Buffer(), data_buffer.Size(), false));
+    for (i = 0; i < num_frames; i++) {
+      auto &data = block.m_frames[i];
       block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
 
       if (('s' == block_track->type) && ('t' == block_track->sub_type)) {
@@ -2358,33 +2371,21 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
   }
 
   block_track->previous_timestamp  = m_last_timestamp;
-  block_track->units_processed    += block_simple->NumberFrames();
+  block_track->units_processed    += num_frames;
 }
 
 void
-kax_reader_c::process_block_group_common(KaxBlockGroup *block_group,
+kax_reader_c::process_block_group_common(kax_cluster_walker_c::block_t &block,
                                          packet_t *packet,
                                          kax_track_t &block_track) {
-  auto codec_state     = FindChild<KaxCodecState>(block_group);
-  auto discard_padding = FindChild<KaxDiscardPadding>(block_group);
-  auto blockadd        = FindChild<KaxBlockAdditions>(block_group);
+  if (block.m_codec_state)
+    packet->codec_state = block.m_codec_state;
 
-  if (codec_state)
-    packet->codec_state = memory_c::clone(codec_state->GetBuffer(), codec_state->GetSize());
+  if (block.m_discard_padding)
+    packet->discard_padding = timestamp_c::ns(*block.m_discard_padding);
 
-  if (discard_padding)
-    packet->discard_padding = timestamp_c::ns(discard_padding->GetValue());
-
-  if (!blockadd)
-    return;
-
-  for (auto &child : *blockadd) {
-    if (!(Is<KaxBlockMore>(child)))
-      continue;
-
-    auto blockmore     = static_cast<KaxBlockMore *>(child);
-    auto blockadd_data = &GetChild<KaxBlockAdditional>(*blockmore);
-    auto blockadded    = std::make_shared<memory_c>(blockadd_data->GetBuffer(), blockadd_data->GetSize(), false);
+  for (auto const &addition : block.m_additions) {
+    auto blockadded = addition;
     block_track.content_decoder.reverse(blockadded, CONTENT_ENCODING_SCOPE_BLOCK);
 
     packet->data_adds.push_back(blockadded);
@@ -2392,32 +2393,27 @@ kax_reader_c::process_block_group_common(KaxBlockGroup *block_group,
 }
 
 void
-kax_reader_c::process_block_group(KaxCluster *cluster,
-                                  KaxBlockGroup *block_group) {
-  auto block = FindChild<KaxBlock>(block_group);
-  if (!block)
-    return;
-
-  block->SetParent(*cluster);
-  auto block_track     = find_track_by_num(block->TrackNum());
-  auto block_timestamp = mtx::math::to_signed(block->GlobalTimecode()) + m_global_timestamp_offset;
+kax_reader_c::process_block_group(kax_cluster_walker_c::block_t &block) {
+  auto block_track     = find_track_by_num(block.m_track_number);
+  auto block_timestamp = block.m_timestamp + m_global_timestamp_offset;
+  auto num_frames      = block.m_frames.size();
 
   if (!block_track) {
     mxwarn_fn(m_ti.m_fname,
               boost::format(Y("A block was found at timestamp %1% for track number %2%. However, no headers where found for that track number. "
-                              "The block will be skipped.\n")) % format_timestamp(block_timestamp) % block->TrackNum());
+                              "The block will be skipped.\n")) % format_timestamp(block_timestamp) % block.m_track_number);
     return;
   }
 
-  auto duration       = FindChild<KaxBlockDuration>(block_group);
-  auto block_duration = duration             ? static_cast<int64_t>(duration->GetValue() * m_tc_scale / block->NumberFrames())
-                      : block_track->v_frate ? static_cast<int64_t>(1000000000.0 / block_track->v_frate)
-                      :                        int64_t{-1};
+  auto &duration      = block.m_duration;
+  auto block_duration = duration && num_frames ? static_cast<int64_t>(*duration * m_tc_scale / num_frames)
+                      : block_track->v_frate   ? static_cast<int64_t>(1000000000.0 / block_track->v_frate)
+                      :                          int64_t{-1};
   auto frame_duration = -1 == block_duration ? int64_t{0} : block_duration;
   m_last_timestamp     = block_timestamp;
 
-  if (0 < block->NumberFrames())
-    m_in_file->set_last_timestamp(m_last_timestamp + (block->NumberFrames() - 1) * frame_duration);
+  if (0 < num_frames)
+    m_in_file->set_last_timestamp(m_last_timestamp + (num_frames - 1) * frame_duration);
 
   // If we're appending this file to another one then the core
   // needs the timestamps shifted to zero.
@@ -2431,18 +2427,15 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
   auto block_fref = int64_t{VFT_NOBFRAME};
   bool bref_found = false;
   bool fref_found = false;
-  auto ref_block  = FindChild<KaxReferenceBlock>(block_group);
 
-  while (ref_block) {
-    if (0 >= ref_block->GetValue()) {
-      block_bref = ref_block->GetValue() * m_tc_scale;
+  for (auto reference : block.m_references) {
+    if (0 >= reference) {
+      block_bref = reference * m_tc_scale;
       bref_found = true;
     } else {
-      block_fref = ref_block->GetValue() * m_tc_scale;
+      block_fref = reference * m_tc_scale;
       fref_found = true;
     }
-
-    ref_block = FindNextChild(*block_group, *ref_block);
   }
 
   if (('s' == block_track->type) && (-1 == block_duration))
@@ -2464,15 +2457,14 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
       block_fref += m_last_timestamp;
 
     size_t i;
-    for (i = 0; i < block->NumberFrames(); i++) {
-      auto &data_buffer = block->GetBuffer(i);
-      auto data         = std::make_shared<memory_c>(data_buffer.Buffer(), data_buffer.Size(), false);
+    for (i = 0; i < num_frames; i++) {
+      auto &data = block.m_frames[i];
       block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
 
       auto packet                = std::make_shared<packet_t>(data, m_last_timestamp + i * frame_duration, block_duration, block_bref, block_fref);
-      packet->duration_mandatory = duration;
+      packet->duration_mandatory = !!duration;
 
-      process_block_group_common(block_group, packet.get(), *block_track);
+      process_block_group_common(block, packet.get(), *block_track);
 
       static_cast<passthrough_packetizer_c *>(PTZR(block_track->ptzr))->process(packet);
     }
@@ -2485,16 +2477,15 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
   if (fref_found)
     block_fref += m_last_timestamp;
 
-  for (auto block_idx = 0u, num_frames = block->NumberFrames(); block_idx < num_frames; ++block_idx) {
-    auto &data_buffer = block->GetBuffer(block_idx);
-    auto data         = std::make_shared<memory_c>(data_buffer.Buffer(), data_buffer.Size(), false);
+  for (auto block_idx = 0u; block_idx < num_frames; ++block_idx) {
+    auto &data = block.m_frames[block_idx];
     block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
 
     if (('s' == block_track->type) && ('t' == block_track->sub_type)) {
       if ((2 < data->get_size()) || ((0 < data->get_size()) && (' ' != *data->get_buffer()) && (0 != *data->get_buffer()) && !iscr(*data->get_buffer()))) {
         auto packet = std::make_shared<packet_t>(data, m_last_timestamp, block_duration, block_bref, block_fref);
 
-        process_block_group_common(block_group, packet.get(), *block_track);
+        process_block_group_common(block, packet.get(), *block_track);
 
         PTZR(block_track->ptzr)->process(packet);
       }
@@ -2502,17 +2493,17 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
     } else {
       auto packet = std::make_shared<packet_t>(data, m_last_timestamp + block_idx * frame_duration, block_duration, block_bref, block_fref);
 
-      if ((duration) && !duration->GetValue())
+      if (duration && !*duration)
         packet->duration_mandatory = true;
 
-      process_block_group_common(block_group, packet.get(), *block_track);
+      process_block_group_common(block, packet.get(), *block_track);
 
       PTZR(block_track->ptzr)->process(packet);
     }
   }
 
   block_track->previous_timestamp  = m_last_timestamp;
-  block_track->units_processed    += block->NumberFrames();
+  block_track->units_processed    += num_frames;
 }
 
 int
@@ -2549,37 +2540,27 @@ kax_reader_c::determine_minimum_timestamps() {
   for (auto &track : m_tracks)
     tracks_by_number[track->track_number] = track;
 
+  // Only the block headers are needed here.
+  kax_cluster_walker_c walker{*m_in};
+  walker.set_timestamp_scale(m_tc_scale);
+  walker.set_segment_end(m_in_file->get_segment_end());
+  walker.set_track_filter([](uint64_t) { return false; });
+
   while (true) {
     try {
-      auto cluster = std::shared_ptr<KaxCluster>(m_in_file->read_next_cluster());
-      if (!cluster)
-        return;
-
-      auto cluster_ts = FindChildValue<KaxClusterTimecode>(*cluster);
-      cluster->InitTimecode(cluster_ts, m_tc_scale);
-
-      for (auto const &element : *cluster) {
-        uint64_t track_number{};
-
-        if (Is<KaxSimpleBlock>(element)) {
-          auto block = static_cast<KaxSimpleBlock *>(element);
-          block->SetParent(*cluster);
-
-          last_timestamp = timestamp_c::ns(mtx::math::to_signed(block->GlobalTimecode()));
-          track_number   = block->TrackNum();
+      auto cluster = std::unique_ptr<KaxCluster>{};
 
-        } else if (Is<KaxBlockGroup>(element)) {
-          auto block = FindChild<KaxBlock>(static_cast<KaxBlockGroup *>(element));
-          if (!block)
-            continue;
-
-          block->SetParent(*cluster);
+      if (!walker.read_cluster()) {
+        cluster.reset(m_in_file->read_next_cluster());
+        if (!cluster)
+          return;
 
-          last_timestamp = timestamp_c::ns(mtx::math::to_signed(block->GlobalTimecode()));
-          track_number   = block->TrackNum();
+        walker.use_cluster(*cluster);
+      }
 
-        } else
-          continue;
+      for (auto const &block : walker.get_blocks()) {
+        auto track_number = block.m_track_number;
+        last_timestamp    = timestamp_c::ns(block.m_timestamp);
 
         if (!first_timestamp.valid())
           first_timestamp = last_timestamp;
@@ -2736,7 +2717,7 @@ kax_reader_c::identify() {
   }
 
   for (auto &attachment : g_attachments)
-    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->data->get_size(), attachment->name, attachment->description, attachment->id);
+    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->get_data_size(), attachment->name, attachment->description, attachment->id);
 
   if (m_chapters)
     id_result_chapters(mtx::chapters::count_atoms(*m_chapters));
@@ -20,7 +20,9 @@
 #include "common/error.h"
 #include "common/id_info.h"
 #include "common/math.h"
+#include "common/mm_read_buffer_io.h"
 #include "common/mp3.h"
+#include "common/mpeg.h"
 #include "common/mpeg1_2.h"
 #include "common/mpeg4_p2.h"
 #include "common/strings/formatting.h"
@@ -88,6 +90,7 @@ mpeg_ps_reader_c::mpeg_ps_reader_c(const track_info_c &ti,
   : generic_reader_c(ti, in)
   , file_done(false)
   , m_probe_range{}
+  , m_use_probe_index{}
   , m_debug_timestamps{"mpeg_ps|mpeg_ps_timestamps"}
   , m_debug_headers{   "mpeg_ps|mpeg_ps_headers"}
   , m_debug_packets{   "mpeg_ps|mpeg_ps_packets"}
@@ -98,18 +101,58 @@ mpeg_ps_reader_c::mpeg_ps_reader_c(const track_info_c &ti,
 void
 mpeg_ps_reader_c::read_headers() {
   try {
-    uint8_t byte;
-
     if (!m_ti.m_disable_multi_file && boost::regex_search(bfs::path{m_ti.m_fname}.filename().string(), boost::regex{"^vts_\\d+_\\d+", boost::regex::icase | boost::regex::perl})) {
       m_in.reset();               // Close the source file first before opening it a second time.
-      m_in = mm_multi_file_io_c::open_multi(m_ti.m_fname, false);
+      m_multi_file_in = mm_multi_file_io_c::open_multi(m_ti.m_fname, false);
+      m_in            = std::make_shared<mm_read_buffer_io_c>(m_multi_file_in.get(), 1 << 17, false);
     }
 
-    m_size          = m_in->get_size();
-    m_probe_range   = calculate_probe_range(m_size, 10 * 1024 * 1024);
+    m_size        = m_in->get_size();
+    m_probe_range = calculate_probe_range(m_size, 10 * 1024 * 1024);
+    version       = -1;
+
+    index_packets_in_probe_range();
+
+    // Probe the streams with the help of the index so that each
+    // stream's probing doesn't have to re-scan the file from the
+    // start.
+    m_use_probe_index = true;
+    m_in->clear_eof();
+
+    for (auto const &probe_packet : m_probe_packets) {
+      m_in->setFilePointer(probe_packet.first + 4);
+      found_new_stream(probe_packet.second);
+    }
+
+  } catch (...) {
+  }
+
+  m_use_probe_index = false;
+  m_probe_packets.clear();
+  m_probe_packet_positions.clear();
+
+  sort_tracks();
+  calculate_global_timestamp_offset();
+
+  m_in->setFilePointer(0, seek_beginning);
+
+  if (verbose) {
+    show_demuxer_info();
+    auto multi_in = dynamic_cast<mm_multi_file_io_c *>(get_underlying_input());
+    if (multi_in)
+      multi_in->display_other_file_info();
+  }
+}
+
+mpeg_ps_reader_c::~mpeg_ps_reader_c() {
+}
+
+void
+mpeg_ps_reader_c::index_packets_in_probe_range() {
+  try {
+    uint8_t byte;
     uint32_t header = m_in->read_uint32_be();
     bool done       = m_in->eof();
-    version         = -1;
 
     while (!done) {
       uint8_t stream_id;
@@ -167,9 +210,9 @@ mpeg_ps_reader_c::read_headers() {
           }
 
           stream_id = header & 0xff;
-          m_in->save_pos();
-          found_new_stream(stream_id);
-          m_in->restore_pos();
+          m_probe_packets.emplace_back(m_in->getFilePointer() - 4, stream_id);
+          m_probe_packet_positions[stream_id].push_back(m_in->getFilePointer() - 4);
+
           pes_packet_length = m_in->read_uint16_be();
 
           mxdebug_if(m_debug_headers, boost::format("mpeg_ps: id 0x%|1$02x| len %2% at %3%\n") % static_cast<unsigned int>(stream_id) % pes_packet_length % (m_in->getFilePointer() - 4 - 2));
@@ -187,20 +230,7 @@ mpeg_ps_reader_c::read_headers() {
   } catch (...) {
   }
 
-  sort_tracks();
-  calculate_global_timestamp_offset();
-
-  m_in->setFilePointer(0, seek_beginning);
-
-  if (verbose) {
-    show_demuxer_info();
-    auto multi_in = dynamic_cast<mm_multi_file_io_c *>(get_underlying_input());
-    if (multi_in)
-      multi_in->display_other_file_info();
-  }
-}
-
-mpeg_ps_reader_c::~mpeg_ps_reader_c() {
+  mxdebug_if(m_debug_headers, boost::format("mpeg_ps: indexed %1% packets of %2% streams in the probe range\n") % m_probe_packets.size() % m_probe_packet_positions.size());
 }
 
 void
@@ -1185,9 +1215,27 @@ mpeg_ps_reader_c::find_next_packet(mpeg_ps_id_t &id,
   }
 }
 
+bool
+mpeg_ps_reader_c::find_next_indexed_packet_for_id(mpeg_ps_id_t id,
+                                                  int64_t max_file_pos) {
+  auto &positions = m_probe_packet_positions[id.id];
+  auto itr        = std::lower_bound(positions.begin(), positions.end(), static_cast<int64_t>(m_in->getFilePointer()));
+
+  if (   (positions.end() == itr)
+      || ((-1 != max_file_pos) && ((*itr + 4) > max_file_pos)))
+    return false;
+
+  m_in->setFilePointer(*itr + 4);
+
+  return true;
+}
+
 bool
 mpeg_ps_reader_c::find_next_packet_for_id(mpeg_ps_id_t id,
                                           int64_t max_file_pos) {
+  if (m_use_probe_index)
+    return find_next_indexed_packet_for_id(id, max_file_pos);
+
   try {
     mpeg_ps_id_t new_id;
     while (find_next_packet(new_id, max_file_pos)) {
@@ -1204,22 +1252,47 @@ bool
 mpeg_ps_reader_c::resync_stream(uint32_t &header) {
   mxdebug_if(m_debug_resync, boost::format("MPEG PS: synchronisation lost at %1%; looking for start code\n") % m_in->getFilePointer());
 
-  try {
-    while (1) {
-      header <<= 8;
-      header  |= m_in->read_uint8();
-      if (mpeg_is_start_code(header))
-        break;
-    }
+  static auto const s_chunk_size = 64 * 1024u;
 
-    mxdebug_if(m_debug_resync, boost::format("resync succeeded at %1%, header 0x%|2$08x|\n") % (m_in->getFilePointer() - 4) % header);
+  if (!m_resync_buffer)
+    m_resync_buffer = memory_c::alloc(s_chunk_size + 3);
 
-    return true;
+  // Search the file chunk by chunk. The last three bytes of the
+  // current header are kept in front of the chunk as they might be
+  // the beginning of a start code prefix.
+  auto buffer       = m_resync_buffer->get_buffer();
+  auto num_carried  = 3u;
+  auto buffer_start = static_cast<int64_t>(m_in->getFilePointer()) - 3;
 
-  } catch (...) {
-    mxdebug_if(m_debug_resync, "resync failed: exception caught\n");
-    return false;
+  buffer[0] = (header >> 16) & 0xff;
+  buffer[1] = (header >>  8) & 0xff;
+  buffer[2] =  header        & 0xff;
+
+  while (true) {
+    auto num_read = m_in->read(&buffer[num_carried], s_chunk_size);
+    if (!num_read)
+      break;
+
+    auto end    = buffer + num_carried + num_read;
+    auto prefix = mtx::mpeg::find_start_code_prefix(buffer, end);
+
+    if ((prefix + 3) < end) {
+      header = get_uint32_be(prefix);
+      m_in->setFilePointer(buffer_start + (prefix - buffer) + 4);
+
+      mxdebug_if(m_debug_resync, boost::format("resync succeeded at %1%, header 0x%|2$08x|\n") % (m_in->getFilePointer() - 4) % header);
+
+      return true;
+    }
+
+    std::memmove(buffer, end - 3, 3);
+    buffer_start += (end - buffer) - 3;
+    num_carried   = 3;
   }
+
+  mxdebug_if(m_debug_resync, "resync failed: end of file reached\n");
+
+  return false;
 }
 
 void
@@ -205,6 +205,17 @@ private:
 
   uint64_t m_probe_range;
 
+  // Positions of all PES packets within the probe range, collected
+  // in a single pass before the streams are probed.
+  std::vector<std::pair<int64_t, int> > m_probe_packets;
+  std::map<int, std::vector<int64_t> > m_probe_packet_positions;
+  bool m_use_probe_index;
+
+  memory_cptr m_resync_buffer;
+
+  // The unbuffered multi file I/O for VOB sets; m_in buffers it.
+  mm_io_cptr m_multi_file_in;
+
   debugging_option_c m_debug_timestamps, m_debug_headers, m_debug_packets, m_debug_resync;
 
 public:
@@ -246,6 +257,8 @@ private:
   virtual void new_stream_a_truehd(mpeg_ps_id_t id, unsigned char *buf, unsigned int length, mpeg_ps_track_ptr &track);
   virtual bool resync_stream(uint32_t &header);
   virtual file_status_e finish();
+  void index_packets_in_probe_range();
+  bool find_next_indexed_packet_for_id(mpeg_ps_id_t id, int64_t max_file_pos);
   void sort_tracks();
   void calculate_global_timestamp_offset();
 };
@@ -935,6 +935,7 @@ track_c::reset_processing_state() {
 file_t::file_t(mm_io_cptr const &in)
   : m_in{in}
   , m_pat_found{}
+  , m_sdt_found{}
   , m_num_pmts_found{}
   , m_num_pmts_to_find{}
   , m_es_to_process{}
@@ -1088,7 +1089,10 @@ reader_c::read_headers_for_file(std::size_t file_num) {
     auto file_size           = f.m_in->get_size();
     f.m_probe_range          = calculate_probe_range(file_size, 10 * 1024 * 1024);
     auto size_to_probe       = std::min<uint64_t>(file_size,     f.m_probe_range);
-    auto min_size_to_probe   = std::min<uint64_t>(size_to_probe, 5 * 1024 * 1024);
+    // When identifying, stop as soon as all elementary streams listed
+    // in the PMTs have been probed and the service names are known.
+    auto fast_path           = use_identification_fast_path();
+    auto min_size_to_probe   = std::min<uint64_t>(size_to_probe, (fast_path ? 1 : 5) * 1024 * 1024);
     f.m_detected_packet_size = detect_packet_size(f.m_in.get(), size_to_probe);
 
     f.m_in->setFilePointer(0);
@@ -1112,7 +1116,8 @@ reader_c::read_headers_for_file(std::size_t file_num) {
       if (   f.m_pat_found
           && f.all_pmts_found()
           && (0 == f.m_es_to_process)
-          && (f.m_in->getFilePointer() >= min_size_to_probe))
+          && (   (f.m_in->getFilePointer() >= min_size_to_probe)
+              || (fast_path && f.m_sdt_found)))
         break;
 
       auto eof = f.m_in->eof() || (f.m_in->getFilePointer() >= size_to_probe);
@@ -1772,6 +1777,8 @@ reader_c::parse_sdt(track_c &track) {
       }
     }
 
+    file().m_sdt_found = true;
+
   } catch (mtx::mm_io::exception &) {
     mxdebug_if(m_debug_sdt, boost::format("parse_sdt: exception during SDT parsing\n"));
     return false;
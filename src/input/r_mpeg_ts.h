@@ -393,7 +393,7 @@ struct file_t {
   std::vector<generic_packetizer_c *> m_packetizers;
   std::vector<program_t> m_programs;
 
-  bool m_pat_found;
+  bool m_pat_found, m_sdt_found;
   unsigned int m_num_pmts_found, m_num_pmts_to_find;
   int m_es_to_process;
   timestamp_c m_global_timestamp_offset, m_stream_timestamp, m_timestamp_restriction_min, m_timestamp_restriction_max, m_timestamp_mpls_sync, m_last_non_subtitle_pts, m_last_non_subtitle_dts;
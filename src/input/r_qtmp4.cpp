@@ -371,6 +371,7 @@ qtmp4_reader_c::calculate_timestamps() {
   for (auto &dmx : m_demuxers) {
     dmx->calculate_frame_rate();
     dmx->calculate_timestamps();
+    dmx->release_tables();
   }
 
   auto min_timestamp = calculate_global_min_timestamp();
@@ -872,8 +873,17 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
   auto first_sample_flags = flags & QTMP4_TRUN_FIRST_SAMPLE_FLAGS ? m_in->read_uint32_be() : m_fragment->sample_flags;
   auto offset             = m_fragment->base_data_offset + data_offset;
 
-  std::vector<uint32_t> all_sample_flags;
+  // All samples of a run are stored contiguously. Therefore a single
+  // chunk suffices for all of them, and consecutive durations & frame
+  // offsets are run-length encoded in the same way "stts" and "ctts"
+  // are.
+  if (entries)
+    track.chunk_table.emplace_back(entries, offset);
+
+  std::vector<uint32_t> all_sample_flags, all_durations;
+  std::vector<int64_t> all_frame_offsets;
   std::vector<bool> all_keyframe_flags;
+  std::vector<uint64_t> all_offsets;
 
   for (auto idx = 0u; idx < entries; ++idx) {
     auto sample_duration = flags & QTMP4_TRUN_SAMPLE_DURATION   ? m_in->read_uint32_be() : m_fragment->sample_duration;
@@ -881,21 +891,34 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
     auto sample_flags    = flags & QTMP4_TRUN_SAMPLE_FLAGS      ? m_in->read_uint32_be() : idx > 0 ? m_fragment->sample_flags : first_sample_flags;
     auto ctts_duration   = flags & QTMP4_TRUN_SAMPLE_CTS_OFFSET ? m_in->read_uint32_be() : 0;
     auto keyframe        = !track.is_video()                    ? true                   : !(sample_flags & (QTMP4_FRAG_SAMPLE_FLAG_IS_NON_SYNC | QTMP4_FRAG_SAMPLE_FLAG_DEPENDS_YES));
+    auto frame_offset    = mtx::math::to_signed(ctts_duration);
+
+    if (!track.durmap_table.empty() && (track.durmap_table.back().duration == sample_duration))
+      ++track.durmap_table.back().number;
+    else
+      track.durmap_table.emplace_back(1, sample_duration);
+
+    if (!track.raw_frame_offset_table.empty() && (track.raw_frame_offset_table.back().offset == frame_offset))
+      ++track.raw_frame_offset_table.back().count;
+    else
+      track.raw_frame_offset_table.emplace_back(1, frame_offset);
 
-    track.durmap_table.emplace_back(1, sample_duration);
     track.sample_table.emplace_back(sample_size);
-    track.chunk_table.emplace_back(1, offset);
-    track.raw_frame_offset_table.emplace_back(1, mtx::math::to_signed(ctts_duration));
 
     if (keyframe)
       track.keyframe_table.emplace_back(track.num_frames_from_trun + 1);
 
-    offset += sample_size;
-
     track.num_frames_from_trun++;
 
-    all_sample_flags.emplace_back(sample_flags);
-    all_keyframe_flags.push_back(keyframe);
+    if (m_debug_tables) {
+      all_sample_flags.emplace_back(sample_flags);
+      all_durations.emplace_back(sample_duration);
+      all_frame_offsets.emplace_back(frame_offset);
+      all_keyframe_flags.push_back(keyframe);
+      all_offsets.emplace_back(offset);
+    }
+
+    offset += sample_size;
   }
 
   m_fragment->implicit_offset = offset;
@@ -906,22 +929,19 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
   if (!m_debug_tables)
     return;
 
-  auto fmt                = boost::format("%1%%2%: duration %3% size %4% data start %5% end %6% pts offset %7% key? %8% raw flags 0x%|9$08x|\n");
-  auto spc                = space((level + 2) * 2 + 1);
-  auto durmap_start       = track.durmap_table.size()           - entries;
-  auto sample_start       = track.sample_table.size()           - entries;
-  auto chunk_start        = track.chunk_table.size()            - entries;
-  auto frame_offset_start = track.raw_frame_offset_table.size() - entries;
-  auto end                = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), entries);
+  auto fmt          = boost::format("%1%%2%: duration %3% size %4% data start %5% end %6% pts offset %7% key? %8% raw flags 0x%|9$08x|\n");
+  auto spc          = space((level + 2) * 2 + 1);
+  auto sample_start = track.sample_table.size() - entries;
+  auto end          = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), entries);
 
   for (auto idx = 0u; idx < end; ++idx)
     mxdebug(fmt
             % spc % idx
-            % track.durmap_table[durmap_start + idx].duration
+            % all_durations[idx]
             % track.sample_table[sample_start + idx].size
-            % track.chunk_table[chunk_start + idx].pos
-            % (track.sample_table[sample_start + idx].size + track.chunk_table[chunk_start + idx].pos)
-            % track.raw_frame_offset_table[frame_offset_start + idx].offset
+            % all_offsets[idx]
+            % (track.sample_table[sample_start + idx].size + all_offsets[idx])
+            % all_frame_offsets[idx]
             % static_cast<unsigned int>(all_keyframe_flags[idx])
             % all_sample_flags[idx]);
 }
@@ -1895,10 +1915,9 @@ qtmp4_reader_c::get_progress() {
   if (-1 == m_main_dmx)
     return 100;
 
-  auto &dmx       = *m_demuxers[m_main_dmx];
-  auto max_chunks = (0 == dmx.sample_size) ? dmx.sample_table.size() : dmx.chunk_table.size();
+  auto &dmx = *m_demuxers[m_main_dmx];
 
-  return 100 * dmx.pos / max_chunks;
+  return dmx.m_index.empty() ? 100 : 100 * dmx.pos / dmx.m_index.size();
 }
 
 void
@@ -2024,7 +2043,7 @@ qtmp4_reader_c::detect_interleaving() {
 
 void
 qtmp4_demuxer_c::calculate_frame_rate() {
-  if ((1 == durmap_table.size()) && (0 != durmap_table[0].duration) && ((0 != sample_size) || (0 == frame_offset_table.size()))) {
+  if ((1 == durmap_table.size()) && (0 != durmap_table[0].duration) && ((0 != sample_size) || (0 == num_frame_offsets))) {
     // Constant frame_rate. Let's set the default duration.
     frame_rate.assign(time_scale, static_cast<int64_t>(durmap_table[0].duration));
     mxdebug_if(m_debug_frame_rate, boost::format("calculate_frame_rate: case 1: %1%/%2%\n") % frame_rate.numerator() % frame_rate.denominator());
@@ -2086,44 +2105,37 @@ qtmp4_demuxer_c::to_nsecs(int64_t value,
 
 void
 qtmp4_demuxer_c::calculate_timestamps_constant_sample_size() {
-  int const num_frame_offsets = frame_offset_table.size();
-  auto chunk_index            = 0;
+  auto frame_offsets = qt_frame_offset_iterator_c{raw_frame_offset_table};
+
+  timestamps.reserve(chunk_table.size());
+  durations.reserve(chunk_table.size());
 
   for (auto const &chunk : chunk_table) {
-    auto frame_offset = chunk_index < num_frame_offsets ? frame_offset_table[chunk_index] : 0;
+    auto frame_offset = frame_offsets.next();
 
     timestamps.push_back(to_nsecs(static_cast<uint64_t>(chunk.samples) * duration + frame_offset));
     durations.push_back(to_nsecs(static_cast<uint64_t>(chunk.size)    * duration));
-    frame_indices.push_back(chunk_index);
-
-    ++chunk_index;
   }
 }
 
 void
 qtmp4_demuxer_c::calculate_timestamps_variable_sample_size() {
-  auto const num_frame_offsets = frame_offset_table.size();
-  auto const num_samples       = sample_table.size();
-
-  std::vector<int64_t> timestamps_before_offsets;
+  auto const num_samples = sample_table.size();
+  auto frame_offsets     = qt_frame_offset_iterator_c{raw_frame_offset_table};
 
   timestamps.reserve(num_samples);
-  timestamps_before_offsets.reserve(num_samples);
   durations.reserve(num_samples);
-  frame_indices.reserve(num_samples);
 
-  for (unsigned int frame = 0; num_samples > frame; ++frame) {
-    auto timestamp = to_nsecs(sample_table[frame].pts);
-
-    frame_indices.push_back(frame);
-    timestamps_before_offsets.push_back(timestamp);
-    timestamps.push_back(timestamp + (frame < num_frame_offsets ? to_nsecs(frame_offset_table[frame]) : 0));
-  }
+  for (unsigned int frame = 0; num_samples > frame; ++frame)
+    timestamps.push_back(to_nsecs(sample_table[frame].pts) + to_nsecs(frame_offsets.next()));
 
   int64_t avg_duration = 0, num_good_frames = 0;
+  auto previous_timestamp = num_samples ? to_nsecs(sample_table[0].pts) : 0;
 
   for (unsigned int frame = 0; num_samples > (frame + 1); ++frame) {
-    int64_t diff = timestamps_before_offsets[frame + 1] - timestamps_before_offsets[frame];
+    auto timestamp     = to_nsecs(sample_table[frame + 1].pts);
+    int64_t diff       = timestamp - previous_timestamp;
+    previous_timestamp = timestamp;
 
     if (0 >= diff)
       durations.push_back(0);
@@ -2166,14 +2178,26 @@ qtmp4_demuxer_c::calculate_timestamps() {
   build_index();
   apply_edit_list();
 
+  // Everything needed for reading is contained in the index from now on.
+  timestamps = std::vector<int64_t>{};
+  durations  = std::vector<int64_t>{};
+
   m_timestamps_calculated = true;
 }
 
 void
-qtmp4_demuxer_c::adjust_timestamps(int64_t delta) {
-  for (auto &timestamp : timestamps)
-    timestamp += delta;
+qtmp4_demuxer_c::release_tables() {
+  // Only call after the index and the frame rate have been calculated.
+  sample_table           = std::vector<qt_sample_t>{};
+  chunk_table            = std::vector<qt_chunk_t>{};
+  chunkmap_table         = std::vector<qt_chunkmap_t>{};
+  durmap_table           = std::vector<qt_durmap_t>{};
+  keyframe_table         = std::vector<uint32_t>{};
+  raw_frame_offset_table = std::vector<qt_frame_offset_t>{};
+}
 
+void
+qtmp4_demuxer_c::adjust_timestamps(int64_t delta) {
   for (auto &index : m_index)
     index.timestamp += delta;
 }
@@ -2283,20 +2307,16 @@ qtmp4_demuxer_c::update_tables() {
     }
   }
 
-  // calc pts/dts offsets
-  for (j = 0; j < raw_frame_offset_table.size(); ++j) {
-    size_t k;
-
-    for (k = 0; k < raw_frame_offset_table[j].count; ++k)
-      frame_offset_table.push_back(raw_frame_offset_table[j].offset);
-  }
+  // The pts/dts offsets are not expanded; they're read from the
+  // run-length encoded table when the timestamps are calculated.
+  num_frame_offsets = boost::accumulate(raw_frame_offset_table, uint64_t{}, [](uint64_t sum, auto const &frame_offset) { return sum + frame_offset.count; });
 
   m_tables_updated = true;
 
   if (!m_debug_tables)
     return true;
 
-  mxdebug(boost::format(" Frame offset table for track ID %1%: %2% entries\n")    % id % frame_offset_table.size());
+  mxdebug(boost::format(" Frame offset table for track ID %1%: %2% entries\n")    % id % num_frame_offsets);
   mxdebug(boost::format(" Sample table contents for track ID %1%: %2% entries\n") % id % sample_table.size());
 
   auto fmt = boost::format("   %1%: pts %2% size %3% pos %4%\n");
@@ -2423,41 +2443,44 @@ qtmp4_demuxer_c::build_index() {
 
 void
 qtmp4_demuxer_c::build_index_constant_sample_size_mode() {
-  auto is_audio              = 'a' == type;
-  auto sound_stsd_atom       = reinterpret_cast<sound_v1_stsd_atom_t *>(is_audio && stsd ? stsd->get_buffer() : nullptr);
+  m_index.reserve(m_index.size() + chunk_table.size());
+
+  for (size_t frame_idx = 0; frame_idx < chunk_table.size(); ++frame_idx)
+    m_index.emplace_back(chunk_table[frame_idx].pos, calculate_constant_sample_size_mode_frame_size(chunk_table[frame_idx]), timestamps[frame_idx], durations[frame_idx], false);
+}
+
+uint64_t
+qtmp4_demuxer_c::calculate_constant_sample_size_mode_frame_size(qt_chunk_t const &chunk)
+  const {
+  if (1 != sample_size)
+    return chunk.size * sample_size;
+
+  uint64_t frame_size = chunk.size;
+
+  if ('a' != type)
+    return frame_size;
+
+  auto sound_stsd_atom       = reinterpret_cast<sound_v1_stsd_atom_t *>(stsd ? stsd->get_buffer() : nullptr);
   auto v0_sample_size        = sound_stsd_atom       ? get_uint16_be(&sound_stsd_atom->v0.sample_size)        : 0;
   auto v0_audio_version      = sound_stsd_atom       ? get_uint16_be(&sound_stsd_atom->v0.version)            : 0;
   auto v1_bytes_per_frame    = 1 == v0_audio_version ? get_uint32_be(&sound_stsd_atom->v1.bytes_per_frame)    : 0;
   auto v1_samples_per_packet = 1 == v0_audio_version ? get_uint32_be(&sound_stsd_atom->v1.samples_per_packet) : 0;
 
-  size_t frame_idx;
-  for (frame_idx = 0; frame_idx < chunk_table.size(); ++frame_idx) {
-    uint64_t frame_size;
-
-    if (1 != sample_size) {
-      frame_size = chunk_table[frame_idx].size * sample_size;
-
-    } else {
-      frame_size = chunk_table[frame_idx].size;
-
-      if (is_audio) {
-        if ((0 != v1_bytes_per_frame) && (0 != v1_samples_per_packet)) {
-          frame_size *= v1_bytes_per_frame;
-          frame_size /= v1_samples_per_packet;
-        } else
-          frame_size  = frame_size * a_channels * v0_sample_size / 8;
-      }
-    }
+  if ((0 != v1_bytes_per_frame) && (0 != v1_samples_per_packet)) {
+    frame_size *= v1_bytes_per_frame;
+    frame_size /= v1_samples_per_packet;
+  } else
+    frame_size  = frame_size * a_channels * v0_sample_size / 8;
 
-    m_index.emplace_back(chunk_table[frame_idx].pos, frame_size, timestamps[frame_idx], durations[frame_idx], false);
-  }
+  return frame_size;
 }
 
 void
 qtmp4_demuxer_c::build_index_chunk_mode() {
-  for (std::size_t frame_idx = 0, num_frames = frame_indices.size(); frame_idx < num_frames; ++frame_idx) {
-    auto act_frame_idx = frame_indices[frame_idx];
-    auto &sample       = sample_table[act_frame_idx];
+  m_index.reserve(m_index.size() + timestamps.size());
+
+  for (std::size_t frame_idx = 0, num_frames = timestamps.size(); frame_idx < num_frames; ++frame_idx) {
+    auto &sample = sample_table[frame_idx];
 
     m_index.emplace_back(sample.pos, sample.size, timestamps[frame_idx], durations[frame_idx], false);
   }
@@ -2503,22 +2526,63 @@ qtmp4_demuxer_c::mark_open_gop_random_access_points_as_key_frames() {
   }
 }
 
+std::vector<std::pair<uint64_t, uint64_t>>
+qtmp4_demuxer_c::get_first_frame_positions_and_sizes(uint64_t num_bytes)
+  const {
+  // Frames are stored in the same order the index would list them in,
+  // so the sample and chunk tables can be used directly if the index
+  // hasn't been built yet.
+  std::vector<std::pair<uint64_t, uint64_t>> frames;
+  uint64_t total_size = 0;
+
+  if (m_timestamps_calculated) {
+    for (auto const &index : m_index) {
+      if (total_size >= num_bytes)
+        break;
+      frames.emplace_back(index.file_pos, index.size);
+      total_size += index.size;
+    }
+
+  } else if (sample_size != 0) {
+    for (auto const &chunk : chunk_table) {
+      if (total_size >= num_bytes)
+        break;
+      frames.emplace_back(chunk.pos, calculate_constant_sample_size_mode_frame_size(chunk));
+      total_size += frames.back().second;
+    }
+
+  } else {
+    for (auto const &sample : sample_table) {
+      if (total_size >= num_bytes)
+        break;
+      frames.emplace_back(sample.pos, sample.size);
+      total_size += sample.size;
+    }
+  }
+
+  return frames;
+}
+
 memory_cptr
 qtmp4_demuxer_c::read_first_bytes(int num_bytes) {
   if (!update_tables())
     return memory_cptr{};
 
-  calculate_timestamps();
+  // Building the full index can take a long time for large files,
+  // and identification only needs the first few frames.
+  if (!m_reader.use_identification_fast_path())
+    calculate_timestamps();
 
+  auto frames    = get_first_frame_positions_and_sizes(num_bytes);
   auto buf       = memory_c::alloc(num_bytes);
   size_t buf_pos = 0;
   size_t idx_pos = 0;
 
-  while ((0 < num_bytes) && (idx_pos < m_index.size())) {
-    qt_index_t &index          = m_index[idx_pos];
-    uint64_t num_bytes_to_read = std::min<int64_t>(num_bytes, index.size);
+  while ((0 < num_bytes) && (idx_pos < frames.size())) {
+    auto &frame                = frames[idx_pos];
+    uint64_t num_bytes_to_read = std::min<int64_t>(num_bytes, frame.second);
 
-    m_reader.m_in->setFilePointer(index.file_pos);
+    m_reader.m_in->setFilePointer(frame.first);
     if (m_reader.m_in->read(buf->get_buffer() + buf_pos, num_bytes_to_read) < num_bytes_to_read)
       return memory_cptr{};
 
@@ -138,6 +138,36 @@ struct qt_frame_offset_t {
   }
 };
 
+// Returns the frame offsets stored in a run-length encoded table
+// ("ctts" atoms and "trun" atoms) one sample at a time without having to
+// expand the table.
+class qt_frame_offset_iterator_c {
+  std::vector<qt_frame_offset_t> const &m_table;
+  std::size_t m_idx{};
+  unsigned int m_num_used{};
+
+public:
+  qt_frame_offset_iterator_c(std::vector<qt_frame_offset_t> const &table)
+    : m_table{table}
+  {
+  }
+
+  // Returns 0 once the table has been exhausted.
+  int32_t next() {
+    while ((m_idx < m_table.size()) && (m_num_used >= m_table[m_idx].count)) {
+      ++m_idx;
+      m_num_used = 0;
+    }
+
+    if (m_idx >= m_table.size())
+      return 0;
+
+    ++m_num_used;
+
+    return static_cast<int32_t>(m_table[m_idx].offset);
+  }
+};
+
 struct qt_index_t {
   int64_t file_pos, size;
   int64_t timestamp, duration;
@@ -236,11 +266,11 @@ struct qtmp4_demuxer_c {
   std::vector<uint32_t> keyframe_table;
   std::vector<qt_editlist_t> editlist_table;
   std::vector<qt_frame_offset_t> raw_frame_offset_table;
-  std::vector<int32_t> frame_offset_table;
+  uint64_t num_frame_offsets{};
   std::vector<qt_random_access_point_t> random_access_point_table;
   std::unordered_map<uint32_t, std::vector<qt_sample_to_group_t> > sample_to_group_tables;
 
-  std::vector<int64_t> timestamps, durations, frame_indices;
+  std::vector<int64_t> timestamps, durations;
 
   std::vector<qt_index_t> m_index;
   std::vector<qt_fragment_t> m_fragments;
@@ -320,6 +350,7 @@ struct qtmp4_demuxer_c {
   void apply_edit_list();
 
   void build_index();
+  void release_tables();
 
   memory_cptr read_first_bytes(int num_bytes);
 
@@ -370,6 +401,8 @@ struct qtmp4_demuxer_c {
 private:
   void build_index_chunk_mode();
   void build_index_constant_sample_size_mode();
+  uint64_t calculate_constant_sample_size_mode_frame_size(qt_chunk_t const &chunk) const;
+  std::vector<std::pair<uint64_t, uint64_t>> get_first_frame_positions_and_sizes(uint64_t num_bytes) const;
   void dump_index_entries(std::string const &message) const;
   void mark_key_frames_from_key_frame_table();
   void mark_open_gop_random_access_points_as_key_frames();
@@ -17,6 +17,7 @@
 #include "common/ebml.h"
 #include "common/hacks.h"
 #include "common/math.h"
+#include "common/profiling.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
 #include "common/translation.h"
@@ -378,6 +379,9 @@ cluster_helper_c::must_duration_be_set(render_groups_c *rg,
 
 int
 cluster_helper_c::render() {
+  static auto s_profiling_counter = mtx::profiling::get_counter("cluster helper: render");
+  mtx::profiling::scope_c profiling{s_profiling_counter};
+
   std::vector<render_groups_cptr> render_groups;
   kax_cues_with_cleanup_c cues;
   cues.SetGlobalTimecodeScale(g_timestamp_scale);
@@ -503,8 +507,6 @@ cluster_helper_c::render() {
     render_group->m_durations.push_back(pack->get_unmodified_duration());
     render_group->m_duration_mandatory |= pack->duration_mandatory;
 
-    cues_c::get().set_duration_for_id_timestamp(source->get_track_num(), pack->assigned_timestamp - timestamp_offset, pack->get_duration());
-
     if (new_block_group) {
       // Set the reference priority if it was wanted.
       if ((0 < pack->ref_priority) && new_block_group->replace_simple_by_group())
@@ -535,8 +537,10 @@ cluster_helper_c::render() {
 
     else if (g_write_cues && (!added_to_cues || has_codec_state)) {
       added_to_cues = add_to_cues_maybe(pack);
-      if (added_to_cues)
+      if (added_to_cues) {
         cues.AddBlockBlob(*new_block_group);
+        cues_c::get().add_cued_block(*new_block_group, pack->get_duration());
+      }
     }
 
     pack->group = new_block_group;
@@ -24,11 +24,146 @@
 #include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
 
+cue_point_column_c::reader_c::reader_c(cue_point_column_c const &column)
+  : m_column{&column}
+{
+}
+
+bool
+cue_point_column_c::reader_c::next(cue_point_t &point) {
+  if (m_offset >= m_column->m_data.size())
+    return false;
+
+  auto timestamp_diff        = m_column->get_uint(m_offset);
+  auto cluster_position_diff = m_column->get_uint(m_offset);
+
+  m_timestamp               += static_cast<uint64_t>((timestamp_diff        >> 1) ^ -(timestamp_diff        & 1));
+  m_cluster_position        += static_cast<uint64_t>((cluster_position_diff >> 1) ^ -(cluster_position_diff & 1));
+
+  point.timestamp            = m_timestamp;
+  point.cluster_position     = m_cluster_position;
+  point.relative_position    = m_column->get_uint(m_offset);
+  point.duration             = m_column->get_uint(m_offset);
+  point.track_num            = m_column->m_track_num;
+
+  return true;
+}
+
+cue_point_column_c::cue_point_column_c(uint32_t track_num)
+  : m_track_num{track_num}
+{
+}
+
+void
+cue_point_column_c::add(cue_point_t const &point) {
+  auto timestamp_diff        = static_cast<int64_t>(point.timestamp        - m_last_timestamp);
+  auto cluster_position_diff = static_cast<int64_t>(point.cluster_position - m_last_cluster_position);
+
+  if (m_num_points && (point.timestamp < m_last_timestamp))
+    m_sorted = false;
+
+  // Differences can be negative. Map them to unsigned values with small
+  // magnitudes ("zig-zag encoding") before storing them.
+  put_uint((static_cast<uint64_t>(timestamp_diff)        << 1) ^ static_cast<uint64_t>(timestamp_diff        >> 63));
+  put_uint((static_cast<uint64_t>(cluster_position_diff) << 1) ^ static_cast<uint64_t>(cluster_position_diff >> 63));
+  put_uint(point.relative_position);
+  put_uint(point.duration);
+
+  m_last_timestamp        = point.timestamp;
+  m_last_cluster_position = point.cluster_position;
+  ++m_num_points;
+}
+
+void
+cue_point_column_c::sort() {
+  if (m_sorted)
+    return;
+
+  auto points = decode();
+  std::stable_sort(points.begin(), points.end(), [](cue_point_t const &a, cue_point_t const &b) { return a.timestamp < b.timestamp; });
+
+  clear();
+  for (auto const &point : points)
+    add(point);
+}
+
+void
+cue_point_column_c::adjust_positions(uint64_t old_position,
+                                     uint64_t delta) {
+  auto points = decode();
+
+  clear();
+  for (auto &point : points) {
+    if (point.cluster_position >= old_position)
+      point.cluster_position += delta;
+    add(point);
+  }
+}
+
+cue_point_column_c::reader_c
+cue_point_column_c::get_reader()
+  const {
+  return reader_c{*this};
+}
+
+std::vector<cue_point_t>
+cue_point_column_c::decode()
+  const {
+  std::vector<cue_point_t> points;
+  cue_point_t point;
+  auto reader = get_reader();
+
+  points.reserve(m_num_points);
+
+  while (reader.next(point))
+    points.push_back(point);
+
+  return points;
+}
+
+void
+cue_point_column_c::clear() {
+  m_data.clear();
+  m_num_points            = 0;
+  m_last_timestamp        = 0;
+  m_last_cluster_position = 0;
+  m_sorted                = true;
+}
+
+void
+cue_point_column_c::put_uint(uint64_t value) {
+  while (value >= 0x80) {
+    m_data.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+
+  m_data.push_back(static_cast<unsigned char>(value));
+}
+
+uint64_t
+cue_point_column_c::get_uint(std::size_t &offset)
+  const {
+  auto value = 0ull;
+  auto shift = 0u;
+
+  while (offset < m_data.size()) {
+    auto byte  = m_data[offset++];
+    value     |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift     += 7;
+
+    if (!(byte & 0x80))
+      break;
+  }
+
+  return value;
+}
+
+// ------------------------------------------------------------
+
 cues_cptr cues_c::s_cues;
 
 cues_c::cues_c()
-  : m_num_cue_points_postprocessed{}
-  , m_no_cue_duration{hack_engaged(ENGAGE_NO_CUE_DURATION)}
+  : m_no_cue_duration{hack_engaged(ENGAGE_NO_CUE_DURATION)}
   , m_no_cue_relative_position{hack_engaged(ENGAGE_NO_CUE_RELATIVE_POSITION)}
   , m_debug_cue_duration{         "cues|cues_cue_duration"}
   , m_debug_cue_relative_position{"cues|cues_cue_relative_position"}
@@ -36,11 +171,12 @@ cues_c::cues_c()
 }
 
 void
-cues_c::set_duration_for_id_timestamp(uint64_t id,
-                                     uint64_t timestamp,
-                                     uint64_t duration) {
-  if (!m_no_cue_duration)
-    m_id_timestamp_duration_multimap.insert({ id_timestamp_t{id, timestamp}, duration });
+cues_c::add_cued_block(KaxBlockBlob &blob,
+                       uint64_t duration) {
+  // Remembering the blocks registered with KaxCues allows
+  // postprocess_cues() to look up their positions and durations
+  // without walking the rendered cluster.
+  m_cued_blocks_in_cluster.push_back({ &blob, duration });
 }
 
 void
@@ -64,7 +200,7 @@ cues_c::add(KaxCuePoint &point) {
     uint64_t track_num = FindChildValue<KaxCueTrack>(*positions);
     assert(track_num <= static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
 
-    m_points.push_back({ timestamp, 0, FindChildValue<KaxCueClusterPosition>(*positions), static_cast<uint32_t>(track_num), 0 });
+    m_points_in_cluster.push_back({ timestamp, 0, FindChildValue<KaxCueClusterPosition>(*positions), static_cast<uint32_t>(track_num), 0 });
 
     uint64_t codec_state_position = FindChildValue<KaxCueCodecState>(*positions);
     if (codec_state_position)
@@ -72,15 +208,28 @@ cues_c::add(KaxCuePoint &point) {
   }
 }
 
+void
+cues_c::store_points_in_cluster() {
+  for (auto const &point : m_points_in_cluster)
+    m_columns.emplace(point.track_num, cue_point_column_c{point.track_num}).first->second.add(point);
+
+  m_points_in_cluster.clear();
+  m_cued_blocks_in_cluster.clear();
+}
+
+uint64_t
+cues_c::get_num_points()
+  const {
+  return boost::accumulate(m_columns, static_cast<uint64_t>(m_points_in_cluster.size()), [](uint64_t sum, auto const &pair) { return sum + pair.second.get_num_points(); });
+}
+
 void
 cues_c::write(mm_io_c &out,
               KaxSeekHead &seek_head) {
-  if (!m_points.size() || !g_cue_writing_requested)
+  if (!get_num_points() || !g_cue_writing_requested)
     return;
 
-  // auto start = mtx::sys::get_current_time_millis();
-  sort();
-  // auto end_sort = mtx::sys::get_current_time_millis();
+  store_points_in_cluster();
 
   // Need to write the (empty) cues element so that its position will
   // be set for indexing in g_kax_sh_main. Necessary because there's
@@ -100,7 +249,7 @@ cues_c::write(mm_io_c &out,
   auto total_size = calculate_total_size();
   write_ebml_element_head(out, EBML_ID(KaxCues), total_size);
 
-  for (auto &point : m_points) {
+  for_each_point_sorted([this, &out](cue_point_t const &point) {
     KaxCuePoint kc_point;
 
     GetChild<KaxCueTime>(kc_point).SetValue(point.timestamp / g_timestamp_scale);
@@ -122,58 +271,69 @@ cues_c::write(mm_io_c &out,
       GetChild<KaxCueDuration>(positions).SetValue(ROUND_TIMESTAMP_SCALE(point.duration) / g_timestamp_scale);
 
     kc_point.Render(out);
-  }
+  });
 
-  m_points.clear();
+  m_columns.clear();
   m_codec_state_position_map.clear();
-  m_num_cue_points_postprocessed = 0;
-
-  // auto end_all = mtx::sys::get_current_time_millis();
-  // mxinfo(boost::format("dur sort %1% write %2% total %3%\n") % (end_sort - start) % (end_all - end_sort) % (end_all - start));
 }
 
 void
-cues_c::sort() {
-  brng::sort(m_points, [](cue_point_t const &a, cue_point_t const &b) -> bool {
-      if (a.timestamp < b.timestamp)
-        return true;
-      if (a.timestamp > b.timestamp)
-        return false;
-
-      if (a.track_num < b.track_num)
-        return true;
-
-      return false;
-    });
-}
+cues_c::for_each_point_sorted(std::function<void(cue_point_t const &)> const &worker) {
+  // The points of each track are sorted by their timestamps. Merge the
+  // tracks' points ordered by timestamp & track number. m_columns is
+  // sorted by track number, therefore the first column with the
+  // lowest timestamp wins.
+  struct cursor_t {
+    cue_point_column_c::reader_c reader;
+    cue_point_t point;
+    bool valid;
+  };
+
+  std::vector<cursor_t> cursors;
+
+  for (auto &pair : m_columns) {
+    pair.second.sort();
+    cursors.push_back({ pair.second.get_reader(), cue_point_t{}, false });
+    cursors.back().valid = cursors.back().reader.next(cursors.back().point);
+  }
 
-std::multimap<id_timestamp_t, uint64_t>
-cues_c::calculate_block_positions(KaxCluster &cluster)
-  const {
+  while (true) {
+    cursor_t *best = nullptr;
 
-  std::multimap<id_timestamp_t, uint64_t> positions;
+    for (auto &cursor : cursors)
+      if (cursor.valid && (!best || (cursor.point.timestamp < best->point.timestamp)))
+        best = &cursor;
 
-  for (auto child : cluster) {
-    auto simple_block = dynamic_cast<KaxSimpleBlock *>(child);
-    if (simple_block) {
-      simple_block->SetParent(cluster);
-      positions.insert({ id_timestamp_t{ simple_block->TrackNum(), simple_block->GlobalTimecode()}, simple_block->GetElementPosition() });
-      continue;
-    }
+    if (!best)
+      break;
 
-    auto block_group = dynamic_cast<KaxBlockGroup *>(child);
-    if (!block_group)
-      continue;
+    worker(best->point);
+    best->valid = best->reader.next(best->point);
+  }
+}
+
+std::multimap<id_timestamp_t, cues_c::cued_block_t const *>
+cues_c::map_cued_blocks(KaxCluster &cluster)
+  const {
+  std::multimap<id_timestamp_t, cued_block_t const *> blocks;
 
-    auto block = FindChild<KaxBlock>(block_group);
+  for (auto const &cued_block : m_cued_blocks_in_cluster) {
+    auto &blob  = *cued_block.blob;
+    auto block  = blob.IsSimpleBlock() ? static_cast<KaxInternalBlock *>(&static_cast<KaxSimpleBlock &>(blob)) : FindChild<KaxBlock>(static_cast<KaxBlockGroup &>(blob));
     if (!block)
       continue;
 
     block->SetParent(cluster);
-    positions.insert({ id_timestamp_t{ block->TrackNum(), block->GlobalTimecode()}, block_group->GetElementPosition() });
+
+    // Cue times are stored in units of the timestamp scale.
+    auto timestamp = block->GlobalTimecode() / g_timestamp_scale * g_timestamp_scale;
+
+    // For equal keys the insertion order, which is the order the
+    // blocks were rendered in, is kept.
+    blocks.insert({ id_timestamp_t{ block->TrackNum(), timestamp }, &cued_block });
   }
 
-  return positions;
+  return blocks;
 }
 
 void
@@ -181,71 +341,75 @@ cues_c::postprocess_cues(KaxCues &cues,
                          KaxCluster &cluster) {
   add(cues);
 
-  if (m_no_cue_duration && m_no_cue_relative_position)
+  if (m_no_cue_duration && m_no_cue_relative_position) {
+    store_points_in_cluster();
     return;
+  }
 
+  // Usually there's one cue point per cued block in the same order,
+  // but that isn't guaranteed. Therefore points and blocks are matched
+  // by track number & timestamp. Several blocks with the same track
+  // number & timestamp are assigned to the points in order.
+  auto cued_blocks            = map_cued_blocks(cluster);
   auto cluster_data_start_pos = cluster.GetElementPosition() + cluster.HeadSize();
-  auto block_positions        = calculate_block_positions(cluster);
-  std::map<id_timestamp_t, size_t> nblocks_processed; //# blocks processed so far with given track #/timestamp
 
-  for (auto point = m_points.begin() + m_num_cue_points_postprocessed, end = m_points.end(); point != end; ++point) {
-    nblocks_processed[id_timestamp_t{ point->track_num, point->timestamp }]++;
+  for (auto &point : m_points_in_cluster) {
+    auto key       = id_timestamp_t{ point.track_num, point.timestamp };
+    auto block_itr = cued_blocks.lower_bound(key);
 
-    // Set CueRelativePosition for all cues.
-    if (!m_no_cue_relative_position) {
-      auto pair          = block_positions.equal_range({ point->track_num, point->timestamp });
-      auto position_itr  = pair.first;
-      auto pos_end       = pair.second;
-      auto num_processed = nblocks_processed[id_timestamp_t{ point->track_num, point->timestamp }];
+    if ((block_itr == cued_blocks.end()) || (block_itr->first != key)) {
+      mxdebug_if(m_debug_cue_relative_position || m_debug_cue_duration, boost::format("postprocess_cues: no cued block found for <%1%:%2%>\n") % point.track_num % point.timestamp);
+      continue;
+    }
 
-      for (auto i = 0u; ((i + 1) < num_processed) && (position_itr != pos_end); ++i)
-        position_itr++;
+    auto &block = *block_itr->second;
+    cued_blocks.erase(block_itr);
 
-      auto relative_position = block_positions.end() != position_itr ? std::max(position_itr->second, cluster_data_start_pos) - cluster_data_start_pos : 0ull;
+    // Set CueRelativePosition for all cues.
+    if (!m_no_cue_relative_position) {
+      auto &blob             = *block.blob;
+      auto block_position    = blob.IsSimpleBlock() ? static_cast<KaxSimpleBlock &>(blob).GetElementPosition() : static_cast<KaxBlockGroup &>(blob).GetElementPosition();
+      auto relative_position = std::max<uint64_t>(block_position, cluster_data_start_pos) - cluster_data_start_pos;
 
       assert(relative_position <= static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
 
-      point->relative_position = relative_position;
+      point.relative_position = relative_position;
 
       mxdebug_if(m_debug_cue_relative_position,
                  boost::format("cue_relative_position: looking for <%1%:%2%>: cluster_data_start_pos %3% position %4%\n")
-                 % point->track_num % point->timestamp % cluster_data_start_pos % relative_position);
+                 % point.track_num % point.timestamp % cluster_data_start_pos % relative_position);
     }
 
     // Set CueDuration if the packetizer wants them.
     if (m_no_cue_duration)
       continue;
 
-    auto pair          = m_id_timestamp_duration_multimap.equal_range({ point->track_num, point->timestamp });
-    auto duration_itr  = pair.first;
-    auto dur_end       = pair.second;
-    auto num_processed = nblocks_processed[id_timestamp_t{ point->track_num, point->timestamp }];
-
-    for (auto i = 0u; ((i + 1) < num_processed) && (duration_itr != dur_end); ++i)
-      duration_itr++;
-
-    auto ptzr         = g_packetizers_by_track_num[point->track_num];
+    auto ptzr = g_packetizers_by_track_num[point.track_num];
 
     if (!ptzr || !ptzr->wants_cue_duration())
       continue;
 
-    if (m_id_timestamp_duration_multimap.end() != duration_itr)
-      point->duration = duration_itr->second;
+    point.duration = block.duration;
 
-    mxdebug_if(m_debug_cue_duration,
-               boost::format("cue_duration: looking for <%1%:%2%>: %3%\n")
-               % point->track_num % point->timestamp % (duration_itr == m_id_timestamp_duration_multimap.end() ? static_cast<int64_t>(-1) : duration_itr->second));
+    mxdebug_if(m_debug_cue_duration, boost::format("cue_duration: looking for <%1%:%2%>: %3%\n") % point.track_num % point.timestamp % block.duration);
   }
 
-  m_num_cue_points_postprocessed = m_points.size();
-
-  m_id_timestamp_duration_multimap.clear();
+  store_points_in_cluster();
 }
 
 uint64_t
 cues_c::calculate_total_size()
   const {
-  return boost::accumulate(m_points, 0ull, [this](uint64_t sum, cue_point_t const &point) { return sum + calculate_point_size(point); });
+  auto total_size = 0ull;
+  cue_point_t point;
+
+  for (auto const &pair : m_columns) {
+    auto reader = pair.second.get_reader();
+    while (reader.next(point))
+      total_size += calculate_point_size(point);
+  }
+
+  return total_size;
 }
 
 uint64_t
@@ -284,14 +448,17 @@ cues_c::adjust_positions(uint64_t old_position,
                          uint64_t delta) {
   auto s_debug_rerender_track_headers = debugging_option_c{"rerender|rerender_track_headers"};
 
-  if (!delta || (m_points.empty() && m_codec_state_position_map.empty()))
+  if (!delta || ((0 == get_num_points()) && m_codec_state_position_map.empty()))
     return;
 
   mxdebug_if(s_debug_rerender_track_headers,
-             boost::format("[rerender] cues_c::adjust_positions: old_position %1% delta %2% num_points %3% first point's position %4%\n")
-             % old_position % delta % m_points.size() % (!m_points.empty() ? m_points[0].cluster_position : 0));
+             boost::format("[rerender] cues_c::adjust_positions: old_position %1% delta %2% num_points %3%\n")
+             % old_position % delta % get_num_points());
+
+  for (auto &pair : m_columns)
+    pair.second.adjust_positions(old_position, delta);
 
-  for (auto &point : m_points)
+  for (auto &point : m_points_in_cluster)
     if (point.cluster_position >= old_position)
       point.cluster_position += delta;
 
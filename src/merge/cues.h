@@ -28,16 +28,72 @@ struct cue_point_t {
   uint32_t track_num, relative_position;
 };
 
+// Compact storage for all cue points of a single track. Timestamps and
+// cluster positions are stored as differences to the previous point's
+// values, and all values are encoded as variable-length integers.
+class cue_point_column_c {
+protected:
+  std::vector<unsigned char> m_data;
+  uint32_t m_track_num;
+  uint64_t m_num_points{}, m_last_timestamp{}, m_last_cluster_position{};
+  bool m_sorted{true};
+
+public:
+  class reader_c {
+  protected:
+    cue_point_column_c const *m_column;
+    std::size_t m_offset{};
+    uint64_t m_timestamp{}, m_cluster_position{};
+
+  public:
+    reader_c(cue_point_column_c const &column);
+    bool next(cue_point_t &point);
+  };
+
+public:
+  cue_point_column_c(uint32_t track_num);
+
+  void add(cue_point_t const &point);
+  void sort();
+  void adjust_positions(uint64_t old_position, uint64_t delta);
+
+  uint32_t get_track_num() const {
+    return m_track_num;
+  }
+  uint64_t get_num_points() const {
+    return m_num_points;
+  }
+  std::size_t get_memory_usage() const {
+    return m_data.capacity();
+  }
+  bool is_sorted() const {
+    return m_sorted;
+  }
+
+  reader_c get_reader() const;
+
+protected:
+  std::vector<cue_point_t> decode() const;
+  void clear();
+  void put_uint(uint64_t value);
+  uint64_t get_uint(std::size_t &offset) const;
+};
+
 class cues_c;
 using cues_cptr = std::shared_ptr<cues_c>;
 
 class cues_c {
 protected:
-  std::vector<cue_point_t> m_points;
-  std::multimap<id_timestamp_t, uint64_t> m_id_timestamp_duration_multimap;
+  struct cued_block_t {
+    KaxBlockBlob *blob;
+    uint64_t duration;
+  };
+
+  std::map<uint32_t, cue_point_column_c> m_columns;
+  std::vector<cue_point_t> m_points_in_cluster;
+  std::vector<cued_block_t> m_cued_blocks_in_cluster;
   std::map<id_timestamp_t, uint64_t> m_codec_state_position_map;
 
-  size_t m_num_cue_points_postprocessed;
   bool m_no_cue_duration, m_no_cue_relative_position;
   debugging_option_c m_debug_cue_duration, m_debug_cue_relative_position;
 
@@ -49,17 +105,19 @@ public:
 
   void add(KaxCues &cues);
   void add(KaxCuePoint &point);
+  void add_cued_block(KaxBlockBlob &blob, uint64_t duration);
   void write(mm_io_c &out, KaxSeekHead &seek_head);
   void postprocess_cues(KaxCues &cues, KaxCluster &cluster);
-  void set_duration_for_id_timestamp(uint64_t id, uint64_t timestamp, uint64_t duration);
   void adjust_positions(uint64_t old_position, uint64_t delta);
 
 public:
   static cues_c &get();
 
 protected:
-  void sort();
-  std::multimap<id_timestamp_t, uint64_t> calculate_block_positions(KaxCluster &cluster) const;
+  void store_points_in_cluster();
+  std::multimap<id_timestamp_t, cued_block_t const *> map_cued_blocks(KaxCluster &cluster) const;
+  void for_each_point_sorted(std::function<void(cue_point_t const &)> const &worker);
+  uint64_t get_num_points() const;
   uint64_t calculate_total_size() const;
   uint64_t calculate_point_size(cue_point_t const &point) const;
   uint64_t calculate_bytes_for_uint(uint64_t value) const;
@@ -28,7 +28,9 @@
 #include "common/container.h"
 #include "common/ebml.h"
 #include "common/hacks.h"
+#include "common/profiling.h"
 #include "common/strings/formatting.h"
+#include "common/thread_pool.h"
 #include "common/unique_numbers.h"
 #include "common/xml/ebml_tags_converter.h"
 #include "merge/cluster_helper.h"
@@ -88,6 +90,10 @@ generic_packetizer_c::generic_packetizer_c(generic_reader_c *reader,
   , m_has_been_flushed{}
   , m_prevent_lacing{}
   , m_connected_successor{}
+  , m_profiling_process{}
+  , m_profiling_timestamps{}
+  , m_profiling_compression{}
+  , m_profiling_compression_wait{}
   , m_ti{ti}
   , m_reader{reader}
   , m_connected_to{}
@@ -165,6 +171,11 @@ generic_packetizer_c::generic_packetizer_c(generic_reader_c *reader,
   else if (mtx::includes(m_ti.m_compression_list, -1))
     m_ti.m_compression = m_ti.m_compression_list[-1];
 
+  if (mtx::includes(m_ti.m_compression_level_list, m_ti.m_id))
+    m_ti.m_compression_level = m_ti.m_compression_level_list[m_ti.m_id];
+  else if (mtx::includes(m_ti.m_compression_level_list, -1))
+    m_ti.m_compression_level = m_ti.m_compression_level_list[-1];
+
   // Let's see if the user has specified a name for this track.
   if (mtx::includes(m_ti.m_track_names, m_ti.m_id))
     m_ti.m_track_name = m_ti.m_track_names[m_ti.m_id];
@@ -351,6 +362,14 @@ generic_packetizer_c::generic_packetizer_c(generic_reader_c *reader,
     auto divisor        = m_htrack_default_duration_indicates_fields ? 2 : 1;
     m_timestamp_factory = timestamp_factory_c::create_fps_factory(m_htrack_default_duration / divisor, m_ti.m_tcsync);
   }
+
+  if (mtx::profiling::is_enabled()) {
+    auto scope                   = (boost::format("'%1%' track %2%") % m_ti.m_fname % m_ti.m_id).str();
+    m_profiling_process          = mtx::profiling::get_counter("packetizer: process",            scope);
+    m_profiling_timestamps       = mtx::profiling::get_counter("packetizer: timestamps",         scope);
+    m_profiling_compression      = mtx::profiling::get_counter("packetizer: compression",        scope);
+    m_profiling_compression_wait = mtx::profiling::get_counter("packetizer: compression (wait)", scope);
+  }
 }
 
 generic_packetizer_c::~generic_packetizer_c() {
@@ -483,6 +502,20 @@ generic_packetizer_c::get_track_default_duration()
   return m_htrack_default_duration;
 }
 
+int64_t
+generic_packetizer_c::get_expected_header_growth()
+  const {
+  // Elements such as the default duration or the video dimensions are
+  // often only known after the first frames have been processed.
+  return 32;
+}
+
+int64_t
+generic_packetizer_c::get_expected_codec_private_growth(int64_t expected_size)
+  const {
+  return std::max<int64_t>(0, expected_size - (m_hcodec_private ? m_hcodec_private->get_size() : 0));
+}
+
 void
 generic_packetizer_c::set_track_forced_flag(bool forced_track) {
   m_ti.m_forced_track = forced_track;
@@ -1230,7 +1263,7 @@ generic_packetizer_c::set_headers() {
     GetChild<KaxContentEncodingType >(c_encoding).SetValue(0); // It's a compression.
     GetChild<KaxContentEncodingScope>(c_encoding).SetValue(1); // Only the frame contents have been compresed.
 
-    m_compressor = compressor_c::create(m_hcompression);
+    create_compressor();
     m_compressor->set_track_headers(c_encoding);
   }
 
@@ -1254,12 +1287,71 @@ generic_packetizer_c::fix_headers() {
   m_track_entry->SetGlobalTimecodeScale((int64_t)g_timestamp_scale);
 }
 
+void
+generic_packetizer_c::create_compressor() {
+  m_compressor = compressor_c::create(m_hcompression);
+
+  if (m_compressor && (-1 != m_ti.m_compression_level))
+    m_compressor->set_level(m_ti.m_compression_level);
+}
+
+static unsigned int
+num_compression_threads() {
+  static auto s_num_threads = mtx::thread_pool_c::get_default_num_threads();
+
+  return s_num_threads;
+}
+
+static mtx::thread_pool_c &
+compression_thread_pool() {
+  static std::unique_ptr<mtx::thread_pool_c> s_pool;
+
+  if (!s_pool)
+    s_pool.reset(new mtx::thread_pool_c{num_compression_threads()});
+
+  return *s_pool;
+}
+
+void
+generic_packetizer_c::compress_packet_in_background(packet_cptr const &packet) {
+  // The job keeps both the packet and the compressor alive even if the
+  // packet is discarded before the compression has finished.
+  auto compressor             = m_compressor;
+  auto profiling_counter      = m_profiling_compression;
+  packet->pending_compression = compression_thread_pool().enqueue([packet, compressor, profiling_counter]() {
+    mtx::profiling::scope_c profiling{profiling_counter};
+
+    packet->data = compressor->compress(packet->data);
+    for (auto &data_add : packet->data_adds)
+      data_add = compressor->compress(data_add);
+  }).share();
+}
+
+void
+generic_packetizer_c::wait_for_compression(packet_t &packet) {
+  if (!packet.pending_compression.valid())
+    return;
+
+  mtx::profiling::scope_c profiling{m_profiling_compression_wait};
+
+  try {
+    packet.pending_compression.get();
+
+  } catch (mtx::compression_x &e) {
+    mxerror_tid(m_ti.m_fname, m_ti.m_id, boost::format(Y("Compression failed: %1%\n")) % e.error());
+  }
+
+  packet.pending_compression = std::shared_future<void>{};
+}
+
 void
 generic_packetizer_c::compress_packet(packet_t &packet) {
   if (!m_compressor) {
     return;
   }
 
+  mtx::profiling::scope_c profiling{m_profiling_compression};
+
   try {
     packet.data = m_compressor->compress(packet.data);
     size_t i;
@@ -1365,14 +1457,22 @@ generic_packetizer_c::add_packet2(packet_cptr pack) {
   pack->timestamp_before_factory = pack->timestamp;
 
   m_packet_queue.push_back(pack);
-  if (!m_timestamp_factory || (TFA_IMMEDIATE == m_timestamp_factory_application_mode))
-    apply_factory_once(pack);
-  else
-    apply_factory();
+
+  {
+    mtx::profiling::scope_c profiling{m_profiling_timestamps};
+
+    if (!m_timestamp_factory || (TFA_IMMEDIATE == m_timestamp_factory_application_mode))
+      apply_factory_once(pack);
+    else
+      apply_factory();
+  }
 
   after_packet_timestamped(*pack);
 
-  compress_packet(*pack);
+  if (m_compressor && m_compressor->is_parallelizable() && (1 < num_compression_threads()))
+    compress_packet_in_background(pack);
+  else
+    compress_packet(*pack);
 }
 
 void
@@ -1390,6 +1490,9 @@ generic_packetizer_c::get_packet() {
   packet_cptr pack = m_packet_queue.front();
   m_packet_queue.pop_front();
 
+  // Packets are only handed out once their compression has finished.
+  wait_for_compression(*pack);
+
   pack->output_order_timestamp = timestamp_c::ns(pack->assigned_timestamp - std::max(m_codec_delay.to_ns(0), m_seek_pre_roll.to_ns(0)));
 
   account_enqueued_bytes(*pack, -1);
@@ -1561,7 +1664,7 @@ generic_packetizer_c::connect(generic_packetizer_c *src,
   m_htrack_default_duration     = src->m_htrack_default_duration;
   m_huid                        = src->m_huid;
   m_hcompression                = src->m_hcompression;
-  m_compressor                  = compressor_c::create(m_hcompression);
+  create_compressor();
   m_last_cue_timestamp          = src->m_last_cue_timestamp;
   m_timestamp_factory           = src->m_timestamp_factory;
   m_correction_timestamp_offset = 0;
@@ -1672,9 +1775,18 @@ generic_packetizer_c::create_track_number() {
 
 file_status_e
 generic_packetizer_c::read(bool force) {
+  mtx::profiling::scope_c profiling{m_reader->m_profiling_read};
+
   return m_reader->read(this, force);
 }
 
+int
+generic_packetizer_c::process(packet_cptr packet) {
+  mtx::profiling::scope_c profiling{m_profiling_process};
+
+  return process_impl(packet);
+}
+
 void
 generic_packetizer_c::prevent_lacing() {
   m_prevent_lacing = true;
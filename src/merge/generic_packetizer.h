@@ -30,6 +30,10 @@ namespace libmatroska {
 class KaxTrackEntry;
 }
 
+namespace mtx { namespace profiling {
+class counter_c;
+}}
+
 using namespace libmatroska;
 
 class generic_reader_c;
@@ -86,6 +90,9 @@ protected:
   bool m_prevent_lacing;
   generic_packetizer_c *m_connected_successor;
 
+  // Only set if profiling is enabled.
+  mtx::profiling::counter_c *m_profiling_process, *m_profiling_timestamps, *m_profiling_compression, *m_profiling_compression_wait;
+
 protected:                      // static
   static int ms_track_number;
 
@@ -117,6 +124,9 @@ public:
     return !m_packet_queue.empty() && m_packet_queue.front()->factory_applied;
   }
   void discard_queued_packets();
+  compressor_c const *get_compressor() const {
+    return m_compressor.get();
+  }
   void flush();
   virtual int64_t get_smallest_timestamp() const {
     return m_packet_queue.empty() ? 0x0FFFFFFF : m_packet_queue.front()->timestamp;
@@ -137,7 +147,7 @@ public:
   inline int process(packet_t *packet) {
     return process(packet_cptr(packet));
   }
-  virtual int process(packet_cptr packet) = 0;
+  int process(packet_cptr packet);
 
   virtual void set_cue_creation(cue_strategy_e create_cue_data) {
     m_ti.m_cues = create_cue_data;
@@ -188,6 +198,7 @@ public:
   virtual void set_track_default_duration(int64_t default_duration, bool force = false);
   virtual void set_track_max_additionals(int max_add_block_ids);
   virtual int64_t get_track_default_duration() const;
+  virtual int64_t get_expected_header_growth() const;
   virtual void set_track_forced_flag(bool forced_track);
   virtual void set_track_enabled_flag(bool enabled_track);
   virtual void set_track_seek_pre_roll(timestamp_c const &seek_pre_roll);
@@ -282,10 +293,15 @@ public:
 protected:
   virtual void flush_impl() {
   };
+  virtual int process_impl(packet_cptr packet) = 0;
 
   virtual void show_experimental_status_version(std::string const &codec_id);
 
   virtual void compress_packet(packet_t &packet);
+  virtual void compress_packet_in_background(packet_cptr const &packet);
+  virtual void wait_for_compression(packet_t &packet);
+  virtual void create_compressor();
+  int64_t get_expected_codec_private_growth(int64_t expected_size) const;
   virtual void account_enqueued_bytes(packet_t &packet, int64_t factor);
 };
 
@@ -14,6 +14,7 @@
 #include "common/common_pch.h"
 
 #include "common/list_utils.h"
+#include "common/profiling.h"
 #include "common/strings/formatting.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
@@ -86,6 +87,7 @@ generic_reader_c::generic_reader_c(const track_info_c &ti,
   , m_num_audio_tracks{}
   , m_num_subtitle_tracks{}
   , m_reference_timestamp_tolerance{}
+  , m_profiling_read{mtx::profiling::get_counter("reader: read", (boost::format("'%1%'") % m_ti.m_fname).str())}
 {
   add_all_requested_track_ids(*this, m_ti.m_atracks.m_items);
   add_all_requested_track_ids(*this, m_ti.m_vtracks.m_items);
@@ -540,6 +542,13 @@ generic_reader_c::set_probe_range_percentage(int64_rational_c const &probe_range
   s_probe_range_percentage = probe_range_percentage;
 }
 
+bool
+generic_reader_c::use_identification_fast_path() {
+  static debugging_option_c s_full_parsing{"identification_full_parsing"};
+
+  return g_identifying && !s_full_parsing;
+}
+
 int64_t
 generic_reader_c::calculate_probe_range(int64_t file_size,
                                         int64_t fixed_minimum)
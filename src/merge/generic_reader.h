@@ -32,6 +32,10 @@ using namespace libmatroska;
 
 class generic_packetizer_c;
 
+namespace mtx { namespace profiling {
+class counter_c;
+}}
+
 #define DEFTRACK_TYPE_AUDIO 0
 #define DEFTRACK_TYPE_VIDEO 1
 #define DEFTRACK_TYPE_SUBS  2
@@ -62,6 +66,9 @@ public:
 
   int64_t m_reference_timestamp_tolerance;
 
+  // Only set if profiling is enabled.
+  mtx::profiling::counter_c *m_profiling_read;
+
 protected:
   id_result_t m_id_results_container;
   std::vector<id_result_t> m_id_results_tracks, m_id_results_attachments, m_id_results_chapters, m_id_results_tags;
@@ -111,6 +118,13 @@ public:
   virtual int64_t get_file_size() {
     return m_in->get_size();
   }
+  // Gives up the file handles and read buffers until data is read
+  // again, e.g. for files in an append chain that aren't being read
+  // at the moment.
+  virtual void release_file_handles() {
+    if (m_in)
+      m_in->release_file_handle();
+  }
   virtual int64_t get_queued_bytes() const;
   virtual bool is_simple_subtitle_container() {
     return false;
@@ -129,6 +143,10 @@ public:
 public:
   static void set_probe_range_percentage(int64_rational_c const &probe_range_percentage);
 
+  // Readers may stop parsing as soon as everything needed for the
+  // identification output has been found if this returns true.
+  static bool use_identification_fast_path();
+
 protected:
   virtual bool demuxing_requested(char type, int64_t id, boost::optional<std::string> const &language = boost::none) const;
 
@@ -16,6 +16,7 @@
 
 #include <cassert>
 
+#include "common/mm_io_x.h"
 #include "merge/libmatroska_extensions.h"
 
 kax_reference_block_c::kax_reference_block_c():
@@ -175,3 +176,60 @@ kax_cues_with_cleanup_c::~kax_cues_with_cleanup_c() {
   // non-eempty. We don't care about that assertion.
   myTempReferences.clear();
 }
+
+kax_file_data_streamed_c::kax_file_data_streamed_c(std::string const &file_name,
+                                                   uint64_t file_size)
+  : KaxFileData{}
+  , m_file_name{file_name}
+  , m_file_size{file_size}
+{
+  SetSize_(m_file_size);
+#if LIBEBML_VERSION < 0x000800
+  bValueIsSet = true;
+#else
+  SetValueIsSet();
+#endif
+}
+
+filepos_t
+kax_file_data_streamed_c::UpdateSize(bool,
+                                     bool) {
+  SetSize_(m_file_size);
+  return m_file_size;
+}
+
+filepos_t
+kax_file_data_streamed_c::RenderData(IOCallback &output,
+                                     bool,
+                                     bool) {
+  // The payload is already present at the current position, e.g. after
+  // the data has been relocated. Skip over it instead of writing it again.
+  if (m_payload_written) {
+    output.setFilePointer(m_file_size, seek_current);
+    return m_file_size;
+  }
+
+  auto const block_size = 1024llu * 1024;
+  auto af_buffer        = memory_c::alloc(std::min<uint64_t>(block_size, m_file_size));
+  auto buffer           = af_buffer->get_buffer();
+  auto remaining        = m_file_size;
+
+  try {
+    auto in = mm_file_io_c::open(m_file_name);
+
+    while (remaining) {
+      auto to_copy = std::min<uint64_t>(block_size, remaining);
+
+      if (in->read(buffer, to_copy) != to_copy)
+        throw mtx::mm_io::end_of_file_x{};
+
+      output.writeFully(buffer, to_copy);
+      remaining -= to_copy;
+    }
+
+  } catch (mtx::mm_io::exception &) {
+    mxerror(boost::format(Y("The attachment '%1%' could not be read.\n")) % m_file_name);
+  }
+
+  return m_file_size;
+}
@@ -17,6 +17,7 @@
 #include "common/common_pch.h"
 
 #include <ebml/EbmlVersion.h>
+#include <matroska/KaxAttached.h>
 #include <matroska/KaxBlock.h>
 #include <matroska/KaxBlockData.h>
 #include <matroska/KaxCluster.h>
@@ -96,3 +97,20 @@ public:
   kax_cues_with_cleanup_c();
   virtual ~kax_cues_with_cleanup_c();
 };
+
+class kax_file_data_streamed_c: public KaxFileData {
+protected:
+  std::string m_file_name;
+  uint64_t m_file_size;
+  bool m_payload_written{};
+
+public:
+  kax_file_data_streamed_c(std::string const &file_name, uint64_t file_size);
+
+  void set_payload_written(bool written) {
+    m_payload_written = written;
+  }
+
+  virtual filepos_t UpdateSize(bool bSaveDefault, bool bForceRender);
+  virtual filepos_t RenderData(IOCallback &output, bool bForceRender, bool bSaveDefault);
+};
@@ -41,6 +41,7 @@
 #include <matroska/KaxTags.h>
 
 #include "common/chapters/chapters.h"
+#include "common/codec.h"
 #include "common/command_line.h"
 #include "common/ebml.h"
 #include "common/extern_data.h"
@@ -51,6 +52,7 @@
 #include "common/list_utils.h"
 #include "common/mm_io.h"
 #include "common/mm_mpls_multi_file_io.h"
+#include "common/profiling.h"
 #include "common/segmentinfo.h"
 #include "common/split_arg_parsing.h"
 #include "common/strings/formatting.h"
@@ -63,6 +65,7 @@
 #include "merge/cluster_helper.h"
 #include "merge/filelist.h"
 #include "merge/generic_reader.h"
+#include "merge/mux_server.h"
 #include "merge/output_control.h"
 #include "merge/reader_detection_and_creation.h"
 #include "merge/track_info.h"
@@ -127,6 +130,8 @@ set_usage() {
   usage_text += Y("  --timestamp-scale <n>    Force the timestamp scale factor to n.\n");
   usage_text += Y("  --disable-track-statistics-tags\n"
                   "                           Do not write tags with track statistics.\n");
+  usage_text += Y("  --no-output-caching      Remove data written to the destination file\n"
+                  "                           from the operating system's file cache.\n");
   usage_text +=   "\n";
   usage_text += Y(" File splitting, linking, appending and concatenating (more global options):\n");
   usage_text += Y("  --split <d[K,M,G]|HH:MM:SS|s>\n"
@@ -328,9 +333,10 @@ set_usage() {
                   "                           read as for the conversion to UTF-8.\n");
   usage_text +=   "\n";
   usage_text += Y(" Options that only apply to VobSub subtitle tracks:\n");
-  usage_text += Y("  --compression <TID:method>\n"
+  usage_text += Y("  --compression <TID:method[:level]>\n"
                   "                           Sets the compression method used for the\n"
-                  "                           specified track ('none' or 'zlib').\n");
+                  "                           specified track ('none' or 'zlib'). For 'zlib'\n"
+                  "                           the level (1-9, default 9) can be given, too.\n");
   usage_text +=   "\n\n";
   usage_text += Y(" Other options:\n");
   usage_text += Y("  -i, --identify <file>    Print information about the source file.\n");
@@ -356,8 +362,17 @@ set_usage() {
                   "                           Redirects all messages into this file.\n");
   usage_text += Y("  --debug <topic>          Turns on debugging output for 'topic'.\n");
   usage_text += Y("  --engage <feature>       Turns on experimental feature 'feature'.\n");
+  usage_text += Y("  --profile                Measure the time spent in the processing stages\n"
+                  "                           and output a summary at the end.\n");
+  usage_text += Y("  --profile-trace-file <file>\n"
+                  "                           Implies --profile; additionally writes a trace\n"
+                  "                           of all timed stages to the file in JSON format.\n");
   usage_text += Y("  @option-file.json        Reads additional command line options from\n"
                   "                           the specified JSON file (see man page).\n");
+  usage_text += Y("  --server                 Read job descriptions from the standard input\n"
+                  "                           and run them one after the other (see man page).\n");
+  usage_text += Y("  --server-jobs <n>        Implies --server; run up to n jobs at the same\n"
+                  "                           time.\n");
   usage_text += Y("  -h, --help               Show this help.\n");
   usage_text += Y("  -V, --version            Show version information.\n");
   usage_text +=   "\n\n";
@@ -484,16 +499,32 @@ identify(std::string &filename) {
   file.name           = filename;
   file.all_names.push_back(filename);
 
+  static debugging_option_c s_debug_timing{"identification_timing"};
+
+  auto start_time = mtx::sys::get_current_time_millis();
+
   get_file_type(file);
 
   if (mtx::file_type_e::is_unknown == file.type)
     display_unsupported_file_type(file);
 
+  auto detected_time = mtx::sys::get_current_time_millis();
+
   create_readers();
 
+  auto headers_read_time = mtx::sys::get_current_time_millis();
+
   file.reader->identify();
+
+  auto identified_time = mtx::sys::get_current_time_millis();
+
   file.reader->display_identification_results();
 
+  mxdebug_if(s_debug_timing,
+             boost::format("identification timing: reader '%1%' file type detection %2% ms, header parsing %3% ms, identification %4% ms, total %5% ms (fast path %6%)\n")
+             % file.reader->get_format_name().get_untranslated() % (detected_time - start_time) % (headers_read_time - detected_time) % (identified_time - headers_read_time) % (identified_time - start_time)
+             % generic_reader_c::use_identification_fast_path());
+
   g_files.clear();
 }
 
@@ -1310,6 +1341,7 @@ parse_arg_cues(const std::string &s,
 /** \brief Parse the \c --compression argument
 
    The argument must have the form \c TID:compression, e.g. \c 0:zlib.
+   For zlib an optional level can be appended, e.g. \c 0:zlib:6.
 */
 static void
 parse_arg_compression(const std::string &s,
@@ -1334,8 +1366,19 @@ parse_arg_compression(const std::string &s,
   available_compression_methods.push_back("analyze_header_removal");
 
   ti.m_compression_list[id] = COMPRESSION_UNSPECIFIED;
+  ti.m_compression_level_list.erase(id);
   balg::to_lower(parts[1]);
 
+  auto method_and_level = split(parts[1], ":", 2);
+  if (method_and_level.size() == 2) {
+    int level = 0;
+    if ((method_and_level[0] != "zlib") || !parse_number(method_and_level[1], level) || (1 > level) || (9 < level))
+      mxerror(boost::format(Y("Invalid compression level specified in '--compression %1%'. Only 'zlib' supports a level which must be between 1 and 9.\n")) % s);
+
+    ti.m_compression_level_list[id] = level;
+    parts[1]                        = method_and_level[0];
+  }
+
   if (parts[1] == "zlib")
     ti.m_compression_list[id] = COMPRESSION_ZLIB;
 
@@ -1802,8 +1845,10 @@ parse_arg_attach_file(attachment_cptr const &attachment,
     if (0 == io->get_size())
       mxerror(boost::format(Y("The size of attachment '%1%' is 0.\n")) % attachment->name);
 
-    attachment->data = memory_c::alloc(io->get_size());
-    io->read(attachment->data->get_buffer(), attachment->data->get_size());
+    // The content is streamed from the file while rendering instead of
+    // being kept in memory for the whole run.
+    attachment->data_file_name = attachment->name;
+    attachment->data_file_size = io->get_size();
 
   } catch (...) {
     mxerror(boost::format(Y("The attachment '%1%' could not be read.\n")) % attachment->name);
@@ -2306,6 +2351,17 @@ parse_args(std::vector<std::string> args) {
       parse_arg_priority(next_arg);
       sit++;
 
+    } else if (this_arg == "--profile")
+      mtx::profiling::enable();
+
+    else if (this_arg == "--profile-trace-file") {
+      if (no_next_arg)
+        mxerror(boost::format(Y("'%1%' lacks its argument.\n")) % this_arg);
+
+      mtx::profiling::enable();
+      mtx::profiling::set_trace_file_name(next_arg);
+      sit++;
+
     } else if ((this_arg == "-q") || (this_arg == "--quiet"))
       verbose = 0;
 
@@ -2385,6 +2441,9 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--disable-track-statistics-tags")
       g_no_track_statistics_tags = true;
 
+    else if (this_arg == "--no-output-caching")
+      g_no_output_caching = true;
+
     else if (this_arg == "--attachment-description") {
       if (no_next_arg)
         mxerror(Y("'--attachment-description' lacks the description.\n"));
@@ -3071,19 +3130,14 @@ setup(int argc,
   return args;
 }
 
-/** \brief Setup and high level program control
+/** \brief High level program control for multiplexing
 
-   Calls the functions for setup, handling the command line arguments,
-   creating the readers, the main loop, finishing the current output
-   file and cleaning up.
+   Handles the command line arguments, creates the readers, runs the
+   main loop, finishes the current output file and cleans up. Does not
+   return.
 */
-int
-main(int argc,
-     char **argv) {
-  mxrun_before_exit(cleanup);
-
-  auto args = setup(argc, argv);
-
+static void
+run_multiplexing(std::vector<std::string> const &args) {
   parse_args(args);
 
   int64_t start = mtx::sys::get_current_time_millis();
@@ -3123,7 +3177,67 @@ main(int argc,
 
   mxinfo(boost::format(Y("Multiplexing took %1%.\n")) % create_minutes_seconds_time_string((mtx::sys::get_current_time_millis() - start + 500) / 1000, true));
 
+  mtx::profiling::report();
+
   cleanup();
 
   mxexit();
 }
+
+/** \brief Runs the server mode if it has been requested
+
+   In server mode no other options may be given; all of them are part
+   of the job descriptions. Does not return if the server mode has been
+   requested.
+*/
+static void
+run_server_maybe(std::vector<std::string> const &args) {
+  if (!mtx::includes(args, std::string{"--server"}) && !mtx::includes(args, std::string{"--server-jobs"}))
+    return;
+
+  auto num_jobs = 1u;
+
+  for (auto sit = args.begin(), sit_end = args.end(); sit != sit_end; ++sit) {
+    if (*sit == "--server")
+      continue;
+
+    if (*sit == "--server-jobs") {
+      if ((sit + 1) == sit_end)
+        mxerror(boost::format(Y("'%1%' lacks its argument.\n")) % *sit);
+
+      if (!parse_number(*(sit + 1), num_jobs) || !num_jobs)
+        mxerror(boost::format(Y("Invalid number of jobs for '%1%': '%2%'.\n")) % *sit % *(sit + 1));
+
+      ++sit;
+      continue;
+    }
+
+    mxerror(boost::format(Y("The option '%1%' cannot be used together with '--server'. Options for the jobs must be part of the job descriptions.\n")) % *sit);
+  }
+
+  if (!mux_server_c::is_supported())
+    mxerror(Y("The server mode is not supported on this operating system.\n"));
+
+  // Set up tables all jobs need once so that the processes running
+  // the jobs inherit them.
+  codec_c::look_up(std::string{"A_AAC"});
+
+  mux_server_c server{num_jobs, [](std::vector<std::string> const &job_args) {
+    run_multiplexing(parse_common_args(job_args));
+  }};
+
+  mxexit(server.run());
+}
+
+/** \brief Setup and high level program control
+*/
+int
+main(int argc,
+     char **argv) {
+  mxrun_before_exit(cleanup);
+
+  auto args = setup(argc, argv);
+
+  run_server_maybe(args);
+  run_multiplexing(args);
+}
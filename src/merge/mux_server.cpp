@@ -0,0 +1,389 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   server mode: running many multiplexing jobs from one process
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if !defined(SYS_WINDOWS)
+# include <cerrno>
+# include <fcntl.h>
+# include <csignal>
+# include <poll.h>
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+#include "common/command_line.h"
+#include "common/fs_sys_helpers.h"
+#include "common/random.h"
+#include "common/strings/editing.h"
+#include "merge/mux_server.h"
+
+std::vector<std::string>
+option_file_cache_c::expand(std::vector<std::string> const &args) {
+  std::vector<std::string> expanded;
+
+  for (auto const &arg : args) {
+    if (arg.empty() || (arg[0] != '@')) {
+      expanded.push_back(arg);
+      continue;
+    }
+
+    auto const &file_args = get(arg.substr(1));
+    expanded.insert(expanded.end(), file_args.begin(), file_args.end());
+  }
+
+  return expanded;
+}
+
+std::vector<std::string> const &
+option_file_cache_c::get(std::string const &file_name) {
+  boost::system::error_code ec;
+  auto path            = bfs::path{file_name};
+  auto last_write_time = bfs::last_write_time(path, ec);
+  auto size            = !ec ? bfs::file_size(path, ec) : 0;
+
+  if (ec)
+    throw mux_server_job_failed_x{(boost::format(Y("The file '%1%' could not be opened for reading: %2%.")) % file_name % ec.message()).str()};
+
+  auto itr = m_entries.find(file_name);
+  if (   (itr != m_entries.end())
+      && (itr->second.m_last_write_time == last_write_time)
+      && (itr->second.m_size            == size))
+    return itr->second.m_args;
+
+  auto entry              = entry_t{};
+  entry.m_last_write_time = last_write_time;
+  entry.m_size            = size;
+
+  mtx::cli::read_args_from_file(entry.m_args, file_name);
+
+  auto &stored = m_entries[file_name];
+  stored       = std::move(entry);
+
+  return stored.m_args;
+}
+
+void
+parse_mux_server_job(std::string const &line,
+                     mux_server_job_t &job) {
+  nlohmann::json doc;
+
+  try {
+    doc = mtx::json::parse(line);
+  } catch (std::exception const &ex) {
+    throw mux_server_job_failed_x{(boost::format(Y("The job description is not valid JSON: %1%")) % ex.what()).str()};
+  }
+
+  auto args = doc;
+
+  if (doc.is_object()) {
+    if (doc.count("id"))
+      job.m_id = doc["id"];
+    args = doc.count("arguments") ? doc["arguments"] : nlohmann::json{};
+  }
+
+  auto invalid = [](nlohmann::json const &arg) { return !arg.is_string(); };
+  if (!args.is_array() || std::any_of(args.begin(), args.end(), invalid))
+    throw mux_server_job_failed_x{Y("A job description must be either a JSON array of strings or a JSON object containing such an array as 'arguments'.")};
+
+  if (args.empty())
+    throw mux_server_job_failed_x{Y("The job description does not contain any arguments.")};
+
+  job.m_args.clear();
+  for (auto const &arg : args)
+    job.m_args.push_back(arg.get<std::string>());
+}
+
+// ------------------------------------------------------------
+
+mux_server_c::mux_server_c(unsigned int max_jobs,
+                           mux_function_t const &mux)
+  : m_max_jobs{std::max(max_jobs, 1u)}
+  , m_mux{mux}
+  , m_num_jobs{}
+  , m_num_failed_jobs{}
+{
+}
+
+bool
+mux_server_c::is_supported() {
+#if defined(SYS_WINDOWS)
+  return false;
+#else
+  return true;
+#endif
+}
+
+void
+mux_server_c::report(nlohmann::json const &result) {
+  g_mm_stdio->puts(mtx::json::dump(result, -1) + "\n");
+  g_mm_stdio->flush();
+}
+
+#if defined(SYS_WINDOWS)
+
+int
+mux_server_c::run() {
+  return 2;
+}
+
+void
+mux_server_c::start_job(std::string const &) {
+}
+
+bool
+mux_server_c::wait_for_job(bool) {
+  return false;
+}
+
+#else  // defined(SYS_WINDOWS)
+
+namespace {
+
+int const s_handled_signals[] = { SIGINT, SIGTERM };
+std::map<int, struct sigaction> s_previous_actions;
+volatile sig_atomic_t s_received_signal{};
+
+// Only records the signal; it's acted upon by the server's main loop.
+void
+handle_signal(int signum) {
+  s_received_signal = signum;
+}
+
+void
+install_signal_handlers() {
+  struct sigaction action{};
+  action.sa_handler = handle_signal;
+  sigemptyset(&action.sa_mask);
+
+  // No SA_RESTART: poll() and waitpid() are interrupted so that the
+  // signal is noticed right away.
+  for (auto signum : s_handled_signals)
+    sigaction(signum, &action, &s_previous_actions[signum]);
+}
+
+void
+restore_signal_handlers() {
+  for (auto const &previous_action : s_previous_actions)
+    sigaction(previous_action.first, &previous_action.second, nullptr);
+}
+
+void
+block_signals(bool block) {
+  sigset_t signals;
+  sigemptyset(&signals);
+  for (auto signum : s_handled_signals)
+    sigaddset(&signals, signum);
+
+  sigprocmask(block ? SIG_BLOCK : SIG_UNBLOCK, &signals, nullptr);
+}
+
+}
+
+int
+mux_server_c::run() {
+  // Errors detected by the server itself, e.g. in option files, only
+  // fail the job they occur in. The standard output is reserved for
+  // the reports.
+  set_mxmsg_handler(MXMSG_INFO,    [](unsigned int, std::string const &) {});
+  set_mxmsg_handler(MXMSG_WARNING, [this](unsigned int, std::string const &message) { m_warnings.push_back(strip_copy(message, true)); });
+  set_mxmsg_handler(MXMSG_ERROR,   [](unsigned int, std::string const &message) { throw mux_server_job_failed_x{strip_copy(message, true)}; });
+
+  // SIGINT and SIGTERM stop the server from reading further jobs. The
+  // signal is passed on to the running jobs which are then reported
+  // as usual.
+  s_received_signal = 0;
+  install_signal_handlers();
+
+  std::string pending;
+  char buffer[4096];
+  auto input_open  = true;
+  auto interrupted = false;
+
+  while (input_open || !m_running_jobs.empty()) {
+    if (s_received_signal && !interrupted) {
+      interrupted = true;
+      input_open  = false;
+
+      for (auto const &job : m_running_jobs)
+        kill(job.first, s_received_signal);
+    }
+
+    if (!input_open) {
+      wait_for_job(true);
+      continue;
+    }
+
+    // Wake up regularly in order to report finished jobs even if no
+    // new jobs arrive and to notice signals received right before
+    // poll() was entered.
+    auto fd     = pollfd{ STDIN_FILENO, POLLIN, 0 };
+    auto result = poll(&fd, 1, 100);
+
+    while (wait_for_job(false))
+      ;
+
+    if (0 == result)
+      continue;
+
+    auto num_read = result > 0 ? ::read(STDIN_FILENO, buffer, sizeof(buffer)) : -1;
+
+    if ((0 > num_read) && (EINTR == errno))
+      continue;
+
+    if (0 >= num_read) {
+      input_open = false;
+      pending   += "\n";
+
+    } else
+      pending.append(buffer, num_read);
+
+    std::string::size_type end_of_line;
+    while (!s_received_signal && ((end_of_line = pending.find('\n')) != std::string::npos)) {
+      auto line = pending.substr(0, end_of_line);
+      pending.erase(0, end_of_line + 1);
+
+      strip(line, true);
+      if (!line.empty())
+        start_job(line);
+    }
+  }
+
+  restore_signal_handlers();
+  reset_mxmsg_handlers();
+
+  return interrupted || m_num_failed_jobs ? 2 : 0;
+}
+
+void
+mux_server_c::start_job(std::string const &line) {
+  ++m_num_jobs;
+
+  auto job = mux_server_job_t{};
+  job.m_id = m_num_jobs;
+  m_warnings.clear();
+
+  try {
+    parse_mux_server_job(line, job);
+    job.m_args = m_option_files.expand(job.m_args);
+
+  } catch (mtx::exception &ex) {
+    ++m_num_failed_jobs;
+    report({ { "id", job.m_id }, { "success", false }, { "exit_code", 2 }, { "error", ex.what() }, { "warnings", m_warnings } });
+    return;
+  }
+
+  while (!s_received_signal && (m_running_jobs.size() >= m_max_jobs))
+    wait_for_job(true);
+
+  if (s_received_signal) {
+    ++m_num_failed_jobs;
+    report({ { "id", job.m_id }, { "success", false }, { "exit_code", 2 }, { "error", Y("The server was interrupted before the job could be started.") } });
+    return;
+  }
+
+  // Output buffered at this point would otherwise be written by both
+  // processes.
+  fflush(nullptr);
+
+  // A signal arriving between fork() and restoring the handlers in the
+  // child must not be swallowed by the server's handler.
+  block_signals(true);
+
+  auto pid        = fork();
+  auto fork_errno = errno;
+
+  if (0 != pid)
+    block_signals(false);
+
+  if (0 > pid) {
+    ++m_num_failed_jobs;
+    report({ { "id", job.m_id }, { "success", false }, { "exit_code", 2 }, { "error", (boost::format(Y("The job could not be started: %1%")) % strerror(fork_errno)).str() } });
+    return;
+  }
+
+  if (0 == pid) {
+    // The child process runs the job as if mkvmerge had been started
+    // with its arguments, including mkvmerge's own signal handlers. Its
+    // output goes to the server's standard error channel; the job's
+    // input must not be taken from the server's standard input.
+    restore_signal_handlers();
+    block_signals(false);
+
+    auto null_fd = ::open("/dev/null", O_RDONLY);
+    if (0 <= null_fd) {
+      dup2(null_fd, STDIN_FILENO);
+      ::close(null_fd);
+    }
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    reset_mxmsg_handlers();
+    random_c::reset();
+
+    m_mux(job.m_args);
+    mxexit();
+  }
+
+  m_running_jobs[pid] = running_job_t{ job.m_id, mtx::sys::get_current_time_millis() };
+}
+
+bool
+mux_server_c::wait_for_job(bool block) {
+  if (m_running_jobs.empty())
+    return false;
+
+  auto status = 0;
+  auto pid    = waitpid(-1, &status, block ? 0 : WNOHANG);
+
+  if ((0 > pid) && (ECHILD == errno)) {
+    // The jobs' processes are gone without their exit status having
+    // been collected, e.g. because SIGCHLD is ignored.
+    for (auto const &job : m_running_jobs) {
+      ++m_num_failed_jobs;
+      report({ { "id", job.second.m_id }, { "success", false }, { "exit_code", 2 }, { "error", Y("The job's exit status could not be determined.") } });
+    }
+
+    m_running_jobs.clear();
+  }
+
+  if (0 >= pid)
+    return false;
+
+  auto itr = m_running_jobs.find(pid);
+  if (itr == m_running_jobs.end())
+    return true;
+
+  // mkvmerge's exit code 1 means that warnings were emitted.
+  auto exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 2;
+  auto success   = (0 == exit_code) || (1 == exit_code);
+  auto result    = nlohmann::json{
+    { "id",          itr->second.m_id                                              },
+    { "success",     success                                                       },
+    { "exit_code",   exit_code                                                     },
+    { "duration_ms", mtx::sys::get_current_time_millis() - itr->second.m_start     },
+  };
+
+  if (WIFSIGNALED(status))
+    result["signal"] = WTERMSIG(status);
+
+  if (!success)
+    ++m_num_failed_jobs;
+
+  m_running_jobs.erase(itr);
+  report(result);
+
+  return true;
+}
+
+#endif  // defined(SYS_WINDOWS)
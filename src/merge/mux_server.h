@@ -0,0 +1,112 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   server mode: running many multiplexing jobs from one process
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <unordered_map>
+
+#include "common/error.h"
+#include "common/json.h"
+
+class mux_server_job_failed_x: public mtx::exception {
+protected:
+  std::string m_message;
+
+public:
+  mux_server_job_failed_x(std::string const &message)
+    : m_message{message}
+  {
+  }
+  virtual ~mux_server_job_failed_x() throw() { }
+
+  virtual const char *what() const throw() {
+    return m_message.c_str();
+  }
+};
+
+struct mux_server_job_t {
+  nlohmann::json m_id;
+  std::vector<std::string> m_args;
+};
+
+// Keeps the arguments read from option files ('@file.json') so that
+// each file is only read and parsed again once it has been modified.
+class option_file_cache_c {
+protected:
+  struct entry_t {
+    std::time_t m_last_write_time;
+    uintmax_t m_size;
+    std::vector<std::string> m_args;
+  };
+
+  std::unordered_map<std::string, entry_t> m_entries;
+
+public:
+  // Replaces all arguments starting with '@' by the arguments read
+  // from the named option file.
+  std::vector<std::string> expand(std::vector<std::string> const &args);
+
+  std::size_t get_num_entries() const {
+    return m_entries.size();
+  }
+
+protected:
+  std::vector<std::string> const &get(std::string const &file_name);
+};
+
+// Parses one job description: either a JSON array of strings (the
+// arguments, like in option files) or a JSON object with the keys
+// "arguments" (required) and "id" (optional). job.m_id is only
+// overwritten if the description contains an ID. Throws
+// mux_server_job_failed_x on errors.
+void parse_mux_server_job(std::string const &line, mux_server_job_t &job);
+
+// Reads job descriptions from the standard input, one per line, and
+// runs each of them in a process forked from the server so that all
+// tables initialized before don't have to be set up again. Up to
+// max_jobs run at the same time. For each finished job a JSON object
+// is written to the standard output on a line of its own.
+class mux_server_c {
+public:
+  using mux_function_t = std::function<void(std::vector<std::string> const &)>;
+
+protected:
+  struct running_job_t {
+    nlohmann::json m_id;
+    int64_t m_start;
+  };
+
+  unsigned int m_max_jobs;
+  mux_function_t m_mux;
+  option_file_cache_c m_option_files;
+  std::map<int, running_job_t> m_running_jobs;
+  uint64_t m_num_jobs, m_num_failed_jobs;
+  std::vector<std::string> m_warnings;
+
+public:
+  // mux is run in the child process and must not return.
+  mux_server_c(unsigned int max_jobs, mux_function_t const &mux);
+
+  // Returns once the standard input has been closed and all jobs have
+  // finished. The result is the exit code for the server.
+  int run();
+
+  static bool is_supported();
+
+protected:
+  void start_job(std::string const &line);
+  bool wait_for_job(bool block);
+  void report(nlohmann::json const &result);
+};
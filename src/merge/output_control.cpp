@@ -55,9 +55,12 @@
 #include "common/ebml.h"
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
+#include "common/math.h"
 #include "common/mm_io_x.h"
 #include "common/mm_write_buffer_io.h"
+#include "common/profiling.h"
 #include "common/strings/formatting.h"
+#include "common/strings/utf8.h"
 #include "common/tags/tags.h"
 #include "common/translation.h"
 #include "common/unique_numbers.h"
@@ -67,7 +70,9 @@
 #include "merge/filelist.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
+#include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
+#include "merge/progress.h"
 #include "merge/webm.h"
 
 using namespace libmatroska;
@@ -109,6 +114,7 @@ bool g_no_lacing                                              = false;
 bool g_no_linking                                             = true;
 bool g_use_durations                                          = false;
 bool g_no_track_statistics_tags                               = false;
+bool g_no_output_caching                                      = false;
 bool g_write_date                                             = true;
 
 double g_timestamp_scale                                      = TIMESTAMP_SCALE;
@@ -167,6 +173,8 @@ static mtx::chapters::kax_cptr s_chapters_in_this_file;
 
 static std::unique_ptr<KaxAttachments> s_kax_as;
 
+static uint64_t s_num_bytes_relocated_in_kernel{}, s_num_bytes_relocated_in_user_space{};
+
 static std::unique_ptr<EbmlVoid> s_kax_sh_void;
 static std::unique_ptr<EbmlVoid> s_kax_chapters_void;
 static int64_t s_max_chapter_size           = 0;
@@ -181,6 +189,11 @@ static mtx::bits::value_c s_seguid_prev(128), s_seguid_current(128), s_seguid_ne
 static int s_display_files_done           = 0;
 static int s_display_path_length          = 1;
 static generic_reader_c *s_display_reader = nullptr;
+static int64_t s_num_packets_muxed        = 0;
+static progress_statistics_c s_progress_statistics;
+
+using append_key_t = std::pair<size_t, size_t>;
+static std::map<append_key_t, append_spec_t *> s_append_mapping_by_dst;
 
 static std::unique_ptr<EbmlHead> s_head;
 
@@ -295,50 +308,70 @@ determine_display_reader() {
   return winner->reader.get();
 }
 
-/** \brief Selects a reader for displaying its progress information
+/** \brief Shows the compression ratio and throughput for each compressed track
 */
 static void
-display_progress(bool is_100percent = false) {
-  static auto s_no_progress             = debugging_option_c{"no_progress"};
-  static int64_t s_previous_progress_on = 0;
-  static int s_previous_percentage      = -1;
+display_compression_statistics() {
+  for (auto &file : g_files)
+    for (auto ptzr : file->reader->m_reader_packetizers) {
+      auto compressor = ptzr->get_compressor();
+      if (!compressor || !compressor->get_num_items() || !compressor->get_raw_size())
+        continue;
 
-  if (s_no_progress)
-    return;
+      auto seconds = compressor->get_compression_time_ns() / 1000000000.0;
 
-  if (is_100percent) {
-    if (mtx::cli::g_gui_mode)
-      mxinfo(boost::format("#GUI#progress 100%%\n"));
-    else
-      mxinfo(boost::format(Y("Progress: 100%%%1%")) % "\r");
+      mxinfo(boost::format(Y("Compression statistics for track %1% of '%2%': %3% frames, %4% bytes compressed to %5% bytes (%|6$.1f|%%), %|7$.1f| MB/s\n"))
+             % ptzr->m_ti.m_id
+             % ptzr->m_ti.m_fname
+             % compressor->get_num_items()
+             % compressor->get_raw_size()
+             % compressor->get_compressed_size()
+             % (compressor->get_compressed_size() * 100.0 / compressor->get_raw_size())
+             % (seconds > 0 ? compressor->get_raw_size() / seconds / 1024.0 / 1024.0 : 0.0));
+    }
+}
+
+static void
+output_progress(int percentage,
+                bool averages) {
+  static std::string::size_type s_previous_line_length = 0;
+
+  if (mtx::cli::g_gui_mode) {
+    mxinfo(boost::format("#GUI#progress %1%%%\n") % percentage);
+    mxinfo(boost::format("%1%\n") % s_progress_statistics.format_for_gui(averages));
     return;
   }
 
-  if (!s_display_reader)
-    s_display_reader = determine_display_reader();
+  auto line = (boost::format(Y("Progress: %1%%% (%2%)")) % percentage % s_progress_statistics.format_for_cli(averages)).str();
 
-  bool display_progress  = false;
-  int current_percentage = (s_display_reader->get_progress() + s_display_files_done * 100) / s_display_path_length;
-  int64_t current_time   = mtx::sys::get_current_time_millis();
+  // Overwrite what's left of the previous, possibly longer line.
+  auto line_length = get_width_in_em(to_wide(line));
+  if (line_length < s_previous_line_length)
+    line += std::string(s_previous_line_length - line_length, ' ');
+  s_previous_line_length = line_length;
 
-  if (   (-1 == s_previous_percentage)
-      || ((100 == current_percentage) && (100 > s_previous_percentage))
-      || ((current_percentage != s_previous_percentage) && ((current_time - s_previous_progress_on) >= 500)))
-    display_progress = true;
+  mxinfo(boost::format("%1%\r") % line);
+}
 
-  if (!display_progress)
-    return;
+/** \brief Displays the progress and throughput information
 
-  // if (2 < current_percentage)
-  //   exit(42);
+   Only called once the progress ticker has signalled that the
+   interval has passed, and not for each packet.
+*/
+static void
+display_progress(bool is_100percent = false) {
+  if (!s_display_reader)
+    s_display_reader = determine_display_reader();
 
-  if (mtx::cli::g_gui_mode)
-    mxinfo(boost::format("#GUI#progress %1%%%\n") % current_percentage);
-  else
-    mxinfo(boost::format(Y("Progress: %1%%%%2%")) % current_percentage % "\r");
+  auto sample            = progress_statistics_c::sample_t{};
+  sample.m_time_ms       = mtx::sys::get_current_time_millis();
+  sample.m_bytes_read    = mm_file_io_c::get_num_bytes_read();
+  sample.m_bytes_written = mm_file_io_c::get_num_bytes_written();
+  sample.m_num_packets   = s_num_packets_muxed;
+  sample.m_percentage    = is_100percent ? 100 : (s_display_reader->get_progress() + s_display_files_done * 100) / s_display_path_length;
 
-  s_previous_percentage  = current_percentage;
-  s_previous_progress_on = current_time;
+  s_progress_statistics.add_sample(sample);
+  output_progress(sample.m_percentage, is_100percent);
 }
 
 /** \brief Add some tags to the list of all tags
@@ -371,7 +404,7 @@ add_attachment(attachment_cptr const &attachment) {
           ||
           (   (ex_attachment->name             == attachment->name)
            && (ex_attachment->description      == attachment->description)
-           && (ex_attachment->data->get_size() == attachment->data->get_size())
+           && (ex_attachment->get_data_size() == attachment->get_data_size())
            && (ex_attachment->source_file      != attachment->source_file)
            && !attachment->source_file.empty()))
         return attachment->id;
@@ -677,10 +710,18 @@ render_headers(mm_io_c *out) {
       g_kax_tracks->Render(*out, false);
       g_kax_sh_main->IndexThis(*g_kax_tracks, *g_kax_segment);
 
-      // Reserve some small amount of space for header changes by the
-      // packetizers.
+      // Reserve some space for header changes by the packetizers. Each
+      // packetizer estimates how much its headers may grow (e.g. due to
+      // codec private data only being available after the first frames)
+      // so that the data written so far doesn't have to be relocated
+      // later on.
+      auto expected_growth = 0ll;
+      for (auto &ptzr : g_packetizers)
+        if (ptzr.packetizer)
+          expected_growth += ptzr.packetizer->get_expected_header_growth();
+
       s_void_after_track_headers = std::make_unique<EbmlVoid>();
-      s_void_after_track_headers->SetSize(1024 + full_header_size - g_kax_tracks->ElementSize(false));
+      s_void_after_track_headers->SetSize(1024 + expected_growth + full_header_size - g_kax_tracks->ElementSize(false));
       s_void_after_track_headers->Render(*out);
     }
 
@@ -723,22 +764,72 @@ adjust_cue_and_seekhead_positions(uint64_t data_start_pos,
 }
 
 static void
-relocate_written_data(uint64_t data_start_pos,
-                      uint64_t delta) {
-  if (g_cluster_helper->discarding())
-    return;
+set_streamed_attachment_payloads_written(bool written) {
+  for (auto attached_child : *s_kax_as) {
+    auto attached = dynamic_cast<KaxAttached *>(attached_child);
+    if (!attached)
+      continue;
 
-  auto rel_pos_from_end = s_out->get_size() - s_out->getFilePointer();
+    for (auto child : *attached) {
+      auto file_data = dynamic_cast<kax_file_data_streamed_c *>(child);
+      if (file_data)
+        file_data->set_payload_written(written);
+    }
+  }
+}
+
+static bool
+relocate_written_data_by_inserting_range(uint64_t data_start_pos,
+                                         uint64_t &delta) {
+  // Let the file system insert a range of unallocated space into the
+  // file. Both the offset and the length must be multiples of the file
+  // system's block size. Therefore the range is inserted at the first
+  // block boundary after the data's start, and only the bytes between
+  // the data's start and that boundary have to be copied manually.
+  auto block_size = s_out->get_block_size();
+  if (!block_size)
+    return false;
+
+  auto aligned_start_pos = mtx::math::round_up(data_start_pos, block_size);
+  auto aligned_delta     = mtx::math::round_up(delta,          block_size);
+
+  if (aligned_start_pos >= static_cast<uint64_t>(s_out->get_size()))
+    return false;
+
+  if (!s_out->insert_range(aligned_start_pos, aligned_delta))
+    return false;
+
+  auto head_size = aligned_start_pos - data_start_pos;
+
+  mxdebug_if(s_debug_rerender_track_headers,
+             boost::format("[rerender]   inserted range at %1% of size %2% (block size %3%); copying %4% head bytes manually\n")
+             % aligned_start_pos % aligned_delta % block_size % head_size);
+
+  if (head_size) {
+    auto af_buffer = memory_c::alloc(head_size);
+
+    s_out->setFilePointer(data_start_pos);
+    s_out->read(af_buffer->get_buffer(), head_size);
+    s_out->setFilePointer(data_start_pos + aligned_delta);
+    s_out->write(af_buffer->get_buffer(), head_size);
+  }
+
+  s_num_bytes_relocated_in_kernel     += s_out->get_size() - aligned_start_pos - aligned_delta;
+  s_num_bytes_relocated_in_user_space += head_size;
+  delta                                = aligned_delta;
+
+  return true;
+}
+
+static void
+relocate_written_data_by_copying(uint64_t data_start_pos,
+                                 uint64_t delta) {
   auto const block_size = 1024llu * 1024;
   auto to_relocate      = s_out->get_size() - data_start_pos;
   auto relocated        = 0llu;
   auto af_buffer        = memory_c::alloc(block_size);
   auto buffer           = af_buffer->get_buffer();
 
-  mxdebug_if(s_debug_rerender_track_headers,
-             boost::format("[rerender] relocate_written_data: void pos %1% void size %2% = data_start_pos %3% s_out size %4% delta %5% to_relocate %6% rel_pos_from_end %7%\n")
-             % s_void_after_track_headers->GetElementPosition() % s_void_after_track_headers->ElementSize(true) % data_start_pos % s_out->get_size() % delta % to_relocate % rel_pos_from_end);
-
   // Extend the file's size. Setting the file pointer to beyond the
   // end and starting to write from there won't work with most of the
   // mm_io_c-derived classes.
@@ -747,15 +838,33 @@ relocate_written_data(uint64_t data_start_pos,
   s_out->write(dummy_data->c_str(), dummy_data->length());
   s_out->restore_pos();
 
+  // The kernel cannot copy overlapping ranges within the same
+  // file. Therefore the chunk size is limited by the distance the data
+  // is moved. Small chunks would cause more system calls than copying
+  // through user space.
+  auto kernel_chunk_size = std::min(block_size, delta);
+  auto use_kernel_copy   = kernel_chunk_size >= 64 * 1024;
+
   // Copy the data from back to front in order not to overwrite
   // existing data in case it overlaps which is likely.
   while (relocated < to_relocate) {
-    auto to_copy = std::min(block_size, to_relocate - relocated);
+    auto to_copy = std::min(use_kernel_copy ? kernel_chunk_size : block_size, to_relocate - relocated);
     auto src_pos = data_start_pos + to_relocate - relocated - to_copy;
     auto dst_pos = src_pos + delta;
 
     mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender]   relocating %1% bytes from %2% to %3%\n") % to_copy % src_pos % dst_pos);
 
+    if (use_kernel_copy) {
+      if (s_out->copy_range(src_pos, dst_pos, to_copy)) {
+        s_num_bytes_relocated_in_kernel += to_copy;
+        relocated                       += to_copy;
+        continue;
+      }
+
+      use_kernel_copy = false;
+      continue;
+    }
+
     s_out->setFilePointer(src_pos);
     auto num_read = s_out->read(buffer, to_copy);
 
@@ -770,13 +879,46 @@ relocate_written_data(uint64_t data_start_pos,
     if (num_written != num_read)
       mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender]   relocation failed; wrote only %1% of %2% bytes\n") % num_written % num_read);
 
-    relocated += to_copy;
+    s_num_bytes_relocated_in_user_space += to_copy;
+    relocated                           += to_copy;
   }
+}
+
+/** \brief Moves all data written after the track headers further back
+
+   The data is moved by at least \c delta bytes. The distance actually
+   used might be bigger if the file system requires alignment. It is
+   returned.
+*/
+static uint64_t
+relocate_written_data(uint64_t data_start_pos,
+                      uint64_t delta) {
+  if (g_cluster_helper->discarding())
+    return delta;
+
+  auto rel_pos_from_end = s_out->get_size() - s_out->getFilePointer();
+
+  mxdebug_if(s_debug_rerender_track_headers,
+             boost::format("[rerender] relocate_written_data: void pos %1% void size %2% = data_start_pos %3% s_out size %4% delta %5% to_relocate %6% rel_pos_from_end %7%\n")
+             % s_void_after_track_headers->GetElementPosition() % s_void_after_track_headers->ElementSize(true) % data_start_pos % s_out->get_size() % delta % (s_out->get_size() - data_start_pos) % rel_pos_from_end);
+
+  if (!relocate_written_data_by_inserting_range(data_start_pos, delta))
+    relocate_written_data_by_copying(data_start_pos, delta);
+
+  mxdebug_if(s_debug_rerender_track_headers,
+             boost::format("[rerender]   relocation done with delta %1%; total bytes relocated so far: %2% by the kernel, %3% through user space\n")
+             % delta % s_num_bytes_relocated_in_kernel % s_num_bytes_relocated_in_user_space);
 
   if (s_kax_as) {
     mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender]  re-writing attachments; old position %1% new %2%\n") % s_kax_as->GetElementPosition() % (s_kax_as->GetElementPosition() + delta));
+
+    // The content of attachments streamed from disk has already been
+    // relocated above. Only their element headers have to be written
+    // again so that libebml knows their new positions.
+    set_streamed_attachment_payloads_written(true);
     s_out->setFilePointer(s_kax_as->GetElementPosition() + delta);
     s_kax_as->Render(*s_out);
+    set_streamed_attachment_payloads_written(false);
   }
 
   if (s_kax_chapters_void) {
@@ -788,6 +930,8 @@ relocate_written_data(uint64_t data_start_pos,
   s_out->setFilePointer(rel_pos_from_end, seek_end);
 
   adjust_cue_and_seekhead_positions(data_start_pos, delta);
+
+  return delta;
 }
 
 static void
@@ -855,11 +999,9 @@ rerender_track_headers() {
              % new_tracks_end_pos % data_start_pos % data_size % s_void_after_track_headers->GetElementPosition() % s_void_after_track_headers->ElementSize(true) % new_void_size);
 
   if (data_size  && (new_tracks_end_pos >= (data_start_pos - 3))) {
-    auto delta      = 1024 + new_tracks_end_pos - data_start_pos;
+    auto delta      = relocate_written_data(data_start_pos, 1024 + new_tracks_end_pos - data_start_pos);
     data_start_pos += delta;
-    new_void_size   = 1024;
-
-    relocate_written_data(data_start_pos - delta, delta);
+    new_void_size   = data_start_pos - new_tracks_end_pos;
   }
 
   shrink_void_and_rerender_track_headers(new_void_size);
@@ -902,7 +1044,11 @@ render_attachments(IOCallback *out) {
       GetChild<KaxFileName>(kax_a).SetValueUTF8(name);
       GetChild<KaxFileUID >(kax_a).SetValue(attch.id);
 
-      GetChild<KaxFileData>(*kax_a).CopyBuffer(attch.data->get_buffer(), attch.data->get_size());
+      if (attch.data)
+        GetChild<KaxFileData>(*kax_a).CopyBuffer(attch.data->get_buffer(), attch.data->get_size());
+
+      else
+        kax_a->PushElement(*new kax_file_data_streamed_c{attch.data_file_name, attch.data_file_size});
     }
   }
 
@@ -946,6 +1092,10 @@ check_append_mapping() {
       mxerror(Y("Files cannot be appended to themselves. The argument for '--append-to' was invalid.\n"));
   }
 
+  std::map<size_t, size_t> num_mappings_by_src_file;
+  for (auto const &amap : g_append_mapping)
+    ++num_mappings_by_src_file[amap.src_file_id];
+
   // Now let's check each appended file if there are NO append to mappings
   // available (in which case we fill in default ones) or if there are fewer
   // mappings than tracks that are to be copied (which is an error).
@@ -953,7 +1103,7 @@ check_append_mapping() {
     if (!src_file->appending)
       continue;
 
-    size_t count = boost::count_if(g_append_mapping, [&src_file](auto const &e) { return e.src_file_id == src_file->id; });
+    size_t count = num_mappings_by_src_file[src_file->id];
 
     if ((0 < count) && (src_file-> reader->m_used_track_ids.size() > count))
       mxerror(boost::format(Y("Only partial append mappings were given for the file no. %1% ('%2%'). Either don't specify any mapping (in which case the "
@@ -981,7 +1131,12 @@ check_append_mapping() {
     }
   }
 
-  // Some more checks.
+  // Some more checks. Mappings are looked up by their source and
+  // destination tracks so that long append chains don't require
+  // quadratic run time.
+  std::map<append_key_t, append_spec_t *> mapping_by_src;
+  s_append_mapping_by_dst.clear();
+
   for (auto &amap : g_append_mapping) {
     src_file = g_files.begin() + amap.src_file_id;
     dst_file = g_files.begin() + amap.dst_file_id;
@@ -999,26 +1154,21 @@ check_append_mapping() {
                               "track can be appended to it. The argument for '--append-to' was invalid.\n")) % amap.dst_file_id % (*dst_file)->name % amap.dst_track_id);
 
     // 7. Is this track already mapped to somewhere else?
-    for (auto &cmp_amap : g_append_mapping) {
-      if (cmp_amap == amap)
-        continue;
-
-      if (   (cmp_amap.src_file_id  == amap.src_file_id)
-          && (cmp_amap.src_track_id == amap.src_track_id))
-        mxerror(boost::format(Y("The track %1% from file no. %2% ('%3%') is to be appended more than once. The argument for '--append-to' was invalid.\n"))
-                % amap.src_track_id % amap.src_file_id % (*src_file)->name);
-    }
+    auto &src_entry = mapping_by_src[{ amap.src_file_id, amap.src_track_id }];
+    if (src_entry && (*src_entry != amap))
+      mxerror(boost::format(Y("The track %1% from file no. %2% ('%3%') is to be appended more than once. The argument for '--append-to' was invalid.\n"))
+              % amap.src_track_id % amap.src_file_id % (*src_file)->name);
 
     // 8. Is there another track that is being appended to the dst_track_id?
-    for (auto &cmp_amap : g_append_mapping) {
-      if (cmp_amap == amap)
-        continue;
-
-      if (   (cmp_amap.dst_file_id  == amap.dst_file_id)
-          && (cmp_amap.dst_track_id == amap.dst_track_id))
-        mxerror(boost::format(Y("More than one track is to be appended to the track %1% from file no. %2% ('%3%'). The argument for '--append-to' was invalid.\n"))
-                % amap.dst_track_id % amap.dst_file_id % (*dst_file)->name);
-    }
+    auto &dst_entry = s_append_mapping_by_dst[{ amap.dst_file_id, amap.dst_track_id }];
+    if (dst_entry && (*dst_entry != amap))
+      mxerror(boost::format(Y("More than one track is to be appended to the track %1% from file no. %2% ('%3%'). The argument for '--append-to' was invalid.\n"))
+              % amap.dst_track_id % amap.dst_file_id % (*dst_file)->name);
+
+    if (!src_entry)
+      src_entry = &amap;
+    if (!dst_entry)
+      dst_entry = &amap;
   }
 
   // Finally see if the packetizers can be connected and connect them if they
@@ -1061,29 +1211,23 @@ check_append_mapping() {
 
   // Calculate the "longest path" -- meaning the maximum number of
   // concatenated files. This is needed for displaying the progress.
-  for (auto amap = g_append_mapping.begin(), amap_end = g_append_mapping.end(); amap != amap_end; ++amap) {
+  for (auto const &amap : g_append_mapping) {
     // Is this the first in a chain?
-    auto cmp_amap = boost::find_if(g_append_mapping, [&amap](auto const &e) {
-      return (*amap              != e)
-          && (amap->dst_file_id  == e.src_file_id)
-          && (amap->dst_track_id == e.src_track_id);
-      });
-
-    if (cmp_amap != g_append_mapping.end())
+    auto cmp_amap = mapping_by_src.find({ amap.dst_file_id, amap.dst_track_id });
+    if ((cmp_amap != mapping_by_src.end()) && (*cmp_amap->second != amap))
       continue;
 
     // Find consecutive mappings.
-    auto trav_amap  = amap;
+    auto trav_amap  = &amap;
     int path_length = 2;
-    do {
-      for (cmp_amap = g_append_mapping.begin(); cmp_amap != amap_end; ++cmp_amap)
-        if (   (trav_amap->src_file_id  == cmp_amap->dst_file_id)
-            && (trav_amap->src_track_id == cmp_amap->dst_track_id)) {
-          trav_amap = cmp_amap;
-          path_length++;
-          break;
-        }
-    } while (cmp_amap != amap_end);
+    while (true) {
+      auto next_amap = s_append_mapping_by_dst.find({ trav_amap->src_file_id, trav_amap->src_track_id });
+      if (next_amap == s_append_mapping_by_dst.end())
+        break;
+
+      trav_amap = next_amap->second;
+      path_length++;
+    }
 
     if (path_length > s_display_path_length)
       s_display_path_length = path_length;
@@ -1141,9 +1285,9 @@ void
 calc_attachment_sizes() {
   // Calculate the size of all attachments for split control.
   for (auto &att : g_attachments) {
-    g_attachment_sizes_first += att->data->get_size();
+    g_attachment_sizes_first += att->get_data_size();
     if (att->to_all_files)
-      g_attachment_sizes_others += att->data->get_size();
+      g_attachment_sizes_others += att->get_data_size();
   }
 }
 
@@ -1166,6 +1310,11 @@ create_packetizers() {
     file->reader->m_appending = file->appending;
     file->reader->create_packetizers();
 
+    // Creating the packetizers may have required reading from the
+    // file; see create_readers().
+    if (file->appending)
+      file->reader->release_file_handles();
+
     if (!s_appending_files)
       s_appending_files = file->appending;
   }
@@ -1318,6 +1467,21 @@ prepare_tags_for_rendering() {
   g_tags_size = s_kax_tags->ElementSize();
 }
 
+/** \brief Estimates the size of the destination file
+
+   Uses the sum of the source files' sizes. This is too large if not
+   all tracks are copied, but space reserved and not used is released
+   when the file is closed.
+*/
+static uint64_t
+estimate_output_file_size() {
+  uint64_t size = 0;
+  for (auto const &file : g_files)
+    size += file->size;
+
+  return size;
+}
+
 /** \brief Creates the next output file
 
    Creates a new file name depending on the split settings. Opens that
@@ -1339,6 +1503,18 @@ create_next_output_file() {
     mxerror(boost::format(Y("The file '%1%' could not be opened for writing: %2%.\n")) % this_outfile % ex);
   }
 
+  auto wb_out = dynamic_cast<mm_write_buffer_io_c *>(s_out.get());
+  if (wb_out) {
+    wb_out->set_profiling_counter(mtx::profiling::get_counter("output: write"));
+    wb_out->enable_background_writes(true);
+    wb_out->enable_dropping_cached_data(g_no_output_caching);
+
+    // Reserving the space up front reduces fragmentation. The
+    // estimate is only known for a single destination file.
+    if (!g_cluster_helper->splitting())
+      wb_out->preallocate(estimate_output_file_size());
+  }
+
   if (verbose && !g_cluster_helper->discarding())
     mxinfo(boost::format(Y("The file '%1%' has been opened for writing.\n")) % this_outfile);
 
@@ -1486,6 +1662,8 @@ finish_file(bool last_file,
   if (!last_file && !create_new_file)
     return;
 
+  mtx::profiling::scope_c profiling{mtx::profiling::get_counter("output: finish file")};
+
   run_before_file_finished_packetizer_hooks();
 
   bool do_output = verbose && !dynamic_cast<mm_null_io_c *>(s_out.get());
@@ -1706,6 +1884,7 @@ append_track(packetizer_t &ptzr,
     dst_file.num_unfinished_packetizers     = 0;
     dst_file.old_num_unfinished_packetizers = 0;
     dst_file.done                           = true;
+    dst_file.reader->release_file_handles();
     establish_deferred_connections(dst_file);
   }
 
@@ -1875,17 +2054,11 @@ append_tracks_maybe() {
     if (FILE_STATUS_DONE_AND_DRY != ptzr.status)
       continue;
 
-    append_spec_t *amap = nullptr;
-    for (auto &amap_idx : g_append_mapping)
-      if ((amap_idx.dst_file_id == static_cast<size_t>(ptzr.file)) && (amap_idx.dst_track_id == static_cast<size_t>(ptzr.packetizer->m_ti.m_id))) {
-        amap = &amap_idx;
-        break;
-      }
-
-    if (!amap)
+    auto amap = s_append_mapping_by_dst.find({ static_cast<size_t>(ptzr.file), static_cast<size_t>(ptzr.packetizer->m_ti.m_id) });
+    if (amap == s_append_mapping_by_dst.end())
       continue;
 
-    append_track(ptzr, *amap);
+    append_track(ptzr, *amap->second);
     appended_a_track = true;
   }
 
@@ -1937,6 +2110,7 @@ check_and_handle_end_of_input_after_pulling(packetizer_t &ptzr) {
   if ((0 >= file.num_unfinished_packetizers) && (0 < file.old_num_unfinished_packetizers)) {
     establish_deferred_connections(file);
     file.done = true;
+    file.reader->release_file_handles();
   }
   file.old_num_unfinished_packetizers = file.num_unfinished_packetizers;
 }
@@ -2030,6 +2204,16 @@ discard_queued_packets() {
 */
 void
 main_loop() {
+  static auto s_no_progress = debugging_option_c{"no_progress"};
+
+  auto show_progress = (1 <= verbose) && !s_no_progress;
+  auto ticker        = std::unique_ptr<progress_ticker_c>{};
+
+  if (show_progress) {
+    ticker = std::make_unique<progress_ticker_c>(std::chrono::milliseconds{500});
+    display_progress();
+  }
+
   // Let's go!
   while (1) {
     // Step 1: Make sure a packet is available for each output
@@ -2052,6 +2236,7 @@ main_loop() {
       g_cluster_helper->add_packet(pack);
 
       winner->pack.reset();
+      ++s_num_packets_muxed;
 
       // If splitting by parts is active and the last part has been
       // processed fully then we can finish up.
@@ -2061,7 +2246,7 @@ main_loop() {
       }
 
       // display some progress information
-      if (1 <= verbose)
+      if (ticker && ticker->is_due())
         display_progress();
 
     } else if (!appended_a_track && !force_pulled) // exit if there are no more packets
@@ -2072,8 +2257,11 @@ main_loop() {
   if (g_cluster_helper && (0 < g_cluster_helper->get_packet_count()))
     g_cluster_helper->render();
 
-  if (1 <= verbose)
+  if (show_progress)
     display_progress(true);
+
+  if (2 <= verbose)
+    display_compression_statistics();
 }
 
 /** \brief Deletes the file readers and other associated objects
@@ -2131,6 +2319,7 @@ cleanup() {
   g_attachments.clear();
   g_track_order.clear();
   g_append_mapping.clear();
+  s_append_mapping_by_dst.clear();
 
   g_seguid_link_previous.reset();
   g_seguid_link_next.reset();
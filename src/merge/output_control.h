@@ -96,6 +96,16 @@ struct attachment_t {
   bool to_all_files{};
   memory_cptr data;
   int64_t ui_id{};
+
+  // Attachments added with '--attach-file' aren't kept in memory. Their
+  // content is streamed from the file named 'data_file_name' while
+  // rendering.
+  std::string data_file_name;
+  uint64_t data_file_size{};
+
+  uint64_t get_data_size() const {
+    return data ? data->get_size() : data_file_size;
+  }
 };
 using attachment_cptr = std::shared_ptr<attachment_t>;
 
@@ -169,7 +179,7 @@ extern float g_video_fps;
 extern generic_packetizer_c *g_video_packetizer;
 
 extern bool g_write_cues, g_cue_writing_requested, g_write_date;
-extern bool g_no_lacing, g_no_linking, g_use_durations, g_no_track_statistics_tags;
+extern bool g_no_lacing, g_no_linking, g_use_durations, g_no_track_statistics_tags, g_no_output_caching;
 
 extern bool g_identifying;
 extern identification_output_format_e g_identification_output_format;
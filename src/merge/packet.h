@@ -15,6 +15,8 @@
 
 #include "common/common_pch.h"
 
+#include <future>
+
 #include "common/timestamp.h"
 
 namespace libmatroska {
@@ -67,6 +69,9 @@ struct packet_t {
 
   std::vector<packet_extension_cptr> extensions;
 
+  // Valid while the packet's data is being compressed by a worker thread.
+  std::shared_future<void> pending_compression;
+
   packet_t()
     : group{}
     , block{}
@@ -0,0 +1,178 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   progress statistics (throughput, remaining time)
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/translation.h"
+#include "merge/progress.h"
+
+progress_ticker_c::progress_ticker_c(std::chrono::milliseconds interval)
+  : m_interval{interval}
+  , m_due{}
+  , m_stopping{}
+{
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+progress_ticker_c::~progress_ticker_c() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stopping = true;
+  }
+
+  m_stop_requested.notify_all();
+  m_thread.join();
+}
+
+void
+progress_ticker_c::run() {
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  while (!m_stop_requested.wait_for(lock, m_interval, [this]() { return m_stopping; }))
+    m_due.store(true, std::memory_order_relaxed);
+}
+
+// ------------------------------------------------------------
+
+progress_statistics_c::progress_statistics_c()
+  : m_read_rate{}
+  , m_write_rate{}
+  , m_packet_rate{}
+  , m_num_samples{}
+{
+}
+
+void
+progress_statistics_c::add_sample(sample_t const &sample) {
+  // Weight of the newest sample for the smoothed rates
+  static double const s_smoothing_factor = 0.3;
+
+  ++m_num_samples;
+
+  if (1 == m_num_samples) {
+    m_first = m_previous = m_current = sample;
+    return;
+  }
+
+  m_previous = m_current;
+  m_current  = sample;
+
+  auto duration_ms = m_current.m_time_ms - m_previous.m_time_ms;
+  if (0 >= duration_ms)
+    return;
+
+  auto read_rate   = calculate_rate(m_current.m_bytes_read    - m_previous.m_bytes_read,    duration_ms);
+  auto write_rate  = calculate_rate(m_current.m_bytes_written - m_previous.m_bytes_written, duration_ms);
+  auto packet_rate = calculate_rate(m_current.m_num_packets   - m_previous.m_num_packets,   duration_ms);
+
+  if (2 == m_num_samples) {
+    m_read_rate   = read_rate;
+    m_write_rate  = write_rate;
+    m_packet_rate = packet_rate;
+    return;
+  }
+
+  m_read_rate   += (read_rate   - m_read_rate)   * s_smoothing_factor;
+  m_write_rate  += (write_rate  - m_write_rate)  * s_smoothing_factor;
+  m_packet_rate += (packet_rate - m_packet_rate) * s_smoothing_factor;
+}
+
+int64_t
+progress_statistics_c::get_elapsed_ms()
+  const {
+  return m_current.m_time_ms - m_first.m_time_ms;
+}
+
+boost::optional<int64_t>
+progress_statistics_c::get_remaining_ms()
+  const {
+  auto percentage = m_current.m_percentage;
+
+  if (100 <= percentage)
+    return 0;
+
+  if (0 >= percentage)
+    return boost::none;
+
+  auto elapsed_ms = get_elapsed_ms();
+  return elapsed_ms * (100 - percentage) / percentage;
+}
+
+double
+progress_statistics_c::get_average_read_rate()
+  const {
+  return calculate_rate(m_current.m_bytes_read - m_first.m_bytes_read, get_elapsed_ms());
+}
+
+double
+progress_statistics_c::get_average_write_rate()
+  const {
+  return calculate_rate(m_current.m_bytes_written - m_first.m_bytes_written, get_elapsed_ms());
+}
+
+double
+progress_statistics_c::get_average_packet_rate()
+  const {
+  return calculate_rate(m_current.m_num_packets - m_first.m_num_packets, get_elapsed_ms());
+}
+
+std::string
+progress_statistics_c::format_for_gui(bool averages)
+  const {
+  auto remaining = get_remaining_ms();
+  auto result    = (boost::format("#GUI#progress_statistics#elapsed=%1%#bytes_read=%2%#bytes_written=%3%#packets=%4%#read_rate=%5%#write_rate=%6%#packet_rate=%7%")
+                    % get_elapsed_ms()
+                    % (m_current.m_bytes_read    - m_first.m_bytes_read)
+                    % (m_current.m_bytes_written - m_first.m_bytes_written)
+                    % (m_current.m_num_packets   - m_first.m_num_packets)
+                    % std::llround(averages ? get_average_read_rate()   : m_read_rate)
+                    % std::llround(averages ? get_average_write_rate()  : m_write_rate)
+                    % std::llround(averages ? get_average_packet_rate() : m_packet_rate)).str();
+
+  if (remaining)
+    result += (boost::format("#remaining=%1%") % *remaining).str();
+
+  return result;
+}
+
+std::string
+progress_statistics_c::format_for_cli(bool averages)
+  const {
+  auto result = (boost::format(Y("%|1$.1f| MB/s read, %|2$.1f| MB/s written, %3% packets/s, elapsed %4%"))
+                 % ((averages ? get_average_read_rate()  : m_read_rate)  / 1024 / 1024)
+                 % ((averages ? get_average_write_rate() : m_write_rate) / 1024 / 1024)
+                 % std::llround(averages ? get_average_packet_rate() : m_packet_rate)
+                 % format_duration(get_elapsed_ms())).str();
+
+  auto remaining = get_remaining_ms();
+  if (remaining && !averages)
+    result += (boost::format(Y(", remaining %1%")) % format_duration(*remaining)).str();
+
+  return result;
+}
+
+double
+progress_statistics_c::calculate_rate(int64_t amount,
+                                      int64_t duration_ms) {
+  return 0 < duration_ms ? amount * 1000.0 / duration_ms : 0.0;
+}
+
+std::string
+progress_statistics_c::format_duration(int64_t duration_ms) {
+  auto seconds = std::max<int64_t>(duration_ms, 0) / 1000;
+
+  if (3600 <= seconds)
+    return (boost::format("%1%:%|2$02d|:%|3$02d|") % (seconds / 3600) % ((seconds / 60) % 60) % (seconds % 60)).str();
+
+  return (boost::format("%1%:%|2$02d|") % (seconds / 60) % (seconds % 60)).str();
+}
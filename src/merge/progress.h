@@ -0,0 +1,100 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   progress statistics (throughput, remaining time)
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Sets a flag in regular intervals from a background thread. The main
+// loop only has to test the flag after each packet instead of querying
+// the current time.
+class progress_ticker_c {
+protected:
+  std::chrono::milliseconds m_interval;
+  std::atomic<bool> m_due;
+  bool m_stopping;
+  std::mutex m_mutex;
+  std::condition_variable m_stop_requested;
+  std::thread m_thread;
+
+public:
+  progress_ticker_c(std::chrono::milliseconds interval);
+  ~progress_ticker_c();
+
+  bool is_due() {
+    if (!m_due.load(std::memory_order_relaxed))
+      return false;
+
+    m_due.store(false, std::memory_order_relaxed);
+    return true;
+  }
+
+protected:
+  void run();
+};
+
+class progress_statistics_c {
+public:
+  struct sample_t {
+    int64_t m_time_ms{}, m_bytes_read{}, m_bytes_written{}, m_num_packets{};
+    int m_percentage{};
+  };
+
+protected:
+  sample_t m_first, m_previous, m_current;
+  double m_read_rate, m_write_rate, m_packet_rate;
+  unsigned int m_num_samples;
+
+public:
+  progress_statistics_c();
+
+  void add_sample(sample_t const &sample);
+
+  unsigned int get_num_samples() const {
+    return m_num_samples;
+  }
+  int get_percentage() const {
+    return m_current.m_percentage;
+  }
+  int64_t get_elapsed_ms() const;
+  boost::optional<int64_t> get_remaining_ms() const;
+
+  // Rates per second. The current rates are smoothed over the last few
+  // samples; the averages cover everything since the first sample.
+  double get_read_rate() const {
+    return m_read_rate;
+  }
+  double get_write_rate() const {
+    return m_write_rate;
+  }
+  double get_packet_rate() const {
+    return m_packet_rate;
+  }
+  double get_average_read_rate() const;
+  double get_average_write_rate() const;
+  double get_average_packet_rate() const;
+
+  // "#GUI#progress_statistics#key1=value1#key2=value2…" without a
+  // trailing newline. Rates are reported as integers.
+  std::string format_for_gui(bool averages = false) const;
+  std::string format_for_cli(bool averages = false) const;
+
+protected:
+  static double calculate_rate(int64_t amount, int64_t duration_ms);
+  static std::string format_duration(int64_t duration_ms);
+};
@@ -15,6 +15,7 @@
 // #include "common/logger.h"
 #include "common/mm_mpls_multi_file_io.h"
 #include "common/mm_read_buffer_io.h"
+#include "common/profiling.h"
 #include "common/strings/formatting.h"
 #include "common/xml/xml.h"
 #include "input/r_aac.h"
@@ -71,7 +72,12 @@ file_names_to_paths(const std::vector<std::string> &file_names) {
 static mm_io_cptr
 open_input_file(filelist_t &file) {
   try {
-    if (file.all_names.size() == 1)
+    // Files being appended only need their file handles while
+    // they're actually being read from.
+    if ((file.all_names.size() == 1) && file.appending)
+      return mm_io_cptr(new mm_read_buffer_io_c(new mm_on_demand_file_io_c(file.name), 1 << 17));
+
+    else if (file.all_names.size() == 1)
       return mm_io_cptr(new mm_read_buffer_io_c(new mm_file_io_c(file.name), 1 << 17));
 
     else {
@@ -147,6 +153,35 @@ detect_text_file_formats(filelist_t const &file) {
   return mtx::file_type_e::is_unknown;
 }
 
+/** \brief Probe for the type of the previous file
+
+   Files appended to each other are usually of the same type. Trying
+   that type first avoids running all the other probes for each part
+   of long append chains. Only types that can be detected reliably are
+   considered here; for all others the regular probing order is kept.
+*/
+static bool
+probe_for_type_of_previous_file(mtx::file_type_e type,
+                                mm_io_c *io,
+                                int64_t size) {
+  switch (type) {
+    case mtx::file_type_e::avi:         return do_probe<avi_reader_c>(io, size);
+    case mtx::file_type_e::matroska:    return do_probe<kax_reader_c>(io, size);
+    case mtx::file_type_e::wav:         return do_probe<wav_reader_c>(io, size);
+    case mtx::file_type_e::ogm:         return do_probe<ogm_reader_c>(io, size);
+    case mtx::file_type_e::flac:        return do_probe<flac_reader_c>(io, size);
+    case mtx::file_type_e::qtmp4:       return do_probe<qtmp4_reader_c>(io, size);
+    case mtx::file_type_e::real:        return do_probe<real_reader_c>(io, size);
+    case mtx::file_type_e::ivf:         return do_probe<ivf_reader_c>(io, size);
+    // Transport and program streams are only probed after several
+    // other types in the regular order. As the previous part was
+    // detected as such a stream, a positive result is trustworthy.
+    case mtx::file_type_e::mpeg_ts:     return do_probe<mtx::mpeg_ts::reader_c>(io, size);
+    case mtx::file_type_e::mpeg_ps:     return do_probe<mpeg_ps_reader_c>(io, size);
+    default:                            return false;
+  }
+}
+
 /** \brief Probe the file type
 
    Opens the input file and calls the \c probe_file function for each known
@@ -162,6 +197,9 @@ get_file_type_internal(filelist_t &file) {
   if (is_playlist)
     io = file.playlist_mpls_in.get();
 
+  else if (file.appending && !g_files.empty() && probe_for_type_of_previous_file(g_files.back()->type, io, size))
+    return { g_files.back()->type, size };
+
   // File types that can be detected unambiguously but are not supported
   if (do_probe<aac_adif_reader_c>(io, size))
     return { mtx::file_type_e::aac, size };
@@ -419,13 +457,23 @@ create_readers() {
           break;
       }
 
-      file->reader->read_headers();
+      {
+        mtx::profiling::scope_c profiling{mtx::profiling::get_counter("reader: read headers", (boost::format("'%1%'") % file->ti->m_fname).str())};
+        file->reader->read_headers();
+      }
+
       file->reader->set_timestamp_restrictions(file->restricted_timestamp_min, file->restricted_timestamp_max);
 
       // Re-calculate file size because the reader might switch to a
       // multi I/O reader in read_headers().
       file->size = file->reader->get_file_size();
 
+      // Only keep the first file of each append chain open. The others
+      // are re-opened once they're actually read from so that the
+      // number of open files doesn't grow with the chain's length.
+      if (file->appending)
+        file->reader->release_file_handles();
+
       mxdebug_if(s_debug_timestamp_restrictions,
                  boost::format("Timestamp restrictions for %3%: min %1% max %2%\n") % file->restricted_timestamp_min % file->restricted_timestamp_max % file->ti->m_fname);
 
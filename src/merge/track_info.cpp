@@ -35,6 +35,7 @@ track_info_c::track_info_c()
   , m_forced_track{boost::logic::indeterminate}
   , m_enabled_track{boost::logic::indeterminate}
   , m_compression{COMPRESSION_UNSPECIFIED}
+  , m_compression_level{-1}
   , m_nalu_size_length{}
   , m_no_chapters{}
   , m_no_global_tags{}
@@ -103,6 +104,8 @@ track_info_c::operator =(const track_info_c &src) {
 
   m_compression_list               = src.m_compression_list;
   m_compression                    = src.m_compression;
+  m_compression_level_list         = src.m_compression_level_list;
+  m_compression_level              = src.m_compression_level;
 
   m_track_names                    = src.m_track_names;
   m_track_name                     = src.m_track_name;
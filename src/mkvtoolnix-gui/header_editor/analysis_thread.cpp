@@ -0,0 +1,304 @@
+#include "common/common_pch.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTimer>
+
+#include <matroska/KaxAttachments.h>
+#include <matroska/KaxSemantic.h>
+
+#include "common/qt.h"
+#include "mkvtoolnix-gui/header_editor/analysis_thread.h"
+
+namespace mtx { namespace gui { namespace HeaderEditor {
+
+namespace {
+
+// Reports its progress through the worker's signals instead of
+// showing a dialog, and hands the elements the header editor is
+// interested in to the worker as soon as the scan finds them.
+class BackgroundKaxAnalyzer : public kax_analyzer_c {
+protected:
+  AnalysisWorker &m_worker;
+
+public:
+  BackgroundKaxAnalyzer(AnalysisWorker &worker, QString const &fileName)
+    : kax_analyzer_c{to_utf8(fileName)}
+    , m_worker{worker}
+  {
+  }
+
+  virtual bool show_progress_running(int percentage) override {
+    m_worker.reportProgress(percentage);
+    return !m_worker.isAnalysisAborted();
+  }
+
+  virtual void element_found(kax_analyzer_data_c const &data) override {
+    m_worker.handleElementFound(*this, data);
+  }
+};
+
+}
+
+class AnalysisWorkerPrivate {
+  friend class AnalysisWorker;
+
+  QMutex m_mutex;
+  QString m_fileName;
+  QList<AnalysisWorker::Modification> m_modifications;
+  QAtomicInteger<bool> m_abortAnalysis;
+
+  // Only accessed from the worker thread:
+  std::unique_ptr<kax_analyzer_c> m_analyzer;
+  ebml_element_cptr m_pendingTracks;
+  bool m_segmentInfoRead{}, m_tracksRead{};
+  int m_lastPercentage{-1};
+
+  explicit AnalysisWorkerPrivate()
+  {
+  }
+};
+
+AnalysisWorker::AnalysisWorker(QObject *parent)
+  : QObject{parent}
+  , d_ptr{new AnalysisWorkerPrivate{}}
+{
+}
+
+AnalysisWorker::~AnalysisWorker() {
+}
+
+void
+AnalysisWorker::analyzeFile(QString const &fileName) {
+  Q_D(AnalysisWorker);
+
+  QMutexLocker lock{&d->m_mutex};
+
+  d->m_fileName      = fileName;
+  d->m_abortAnalysis = false;
+
+  QTimer::singleShot(0, this, SLOT(analyze()));
+}
+
+void
+AnalysisWorker::modifyFile(QList<Modification> const &modifications) {
+  Q_D(AnalysisWorker);
+
+  QMutexLocker lock{&d->m_mutex};
+
+  d->m_modifications = modifications;
+
+  QTimer::singleShot(0, this, SLOT(modify()));
+}
+
+void
+AnalysisWorker::abortAnalysis() {
+  Q_D(AnalysisWorker);
+
+  d->m_abortAnalysis = true;
+}
+
+bool
+AnalysisWorker::isAnalysisAborted()
+  const {
+  Q_D(const AnalysisWorker);
+
+  return d->m_abortAnalysis;
+}
+
+void
+AnalysisWorker::reportProgress(int percentage) {
+  Q_D(AnalysisWorker);
+
+  if (percentage == d->m_lastPercentage)
+    return;
+
+  d->m_lastPercentage = percentage;
+  emit analysisProgressChanged(percentage);
+}
+
+void
+AnalysisWorker::handleElementFound(kax_analyzer_c &analyzer,
+                                   kax_analyzer_data_c const &data) {
+  Q_D(AnalysisWorker);
+
+  if ((data.m_id == KaxInfo::ClassInfos.GlobalId) && !d->m_segmentInfoRead) {
+    auto segmentInfo = analyzer.read_element(data);
+    if (!segmentInfo)
+      return;
+
+    d->m_segmentInfoRead = true;
+    emit segmentInfoRead(segmentInfo);
+
+    // Keep the segment information in front of the tracks in the
+    // tree even if the tracks come first in the file.
+    if (d->m_pendingTracks) {
+      emit tracksRead(d->m_pendingTracks);
+      d->m_pendingTracks.reset();
+    }
+
+  } else if ((data.m_id == KaxTracks::ClassInfos.GlobalId) && !d->m_tracksRead) {
+    auto tracks = analyzer.read_element(data);
+    if (!tracks)
+      return;
+
+    d->m_tracksRead = true;
+
+    if (d->m_segmentInfoRead)
+      emit tracksRead(tracks);
+    else
+      d->m_pendingTracks = tracks;
+  }
+}
+
+void
+AnalysisWorker::emitSegmentInfoAndTracks(kax_analyzer_c &analyzer) {
+  Q_D(AnalysisWorker);
+
+  // Elements located via the meta seek elements or found after the
+  // tracks haven't been reported by the scan.
+  if (!d->m_segmentInfoRead)
+    analyzer.with_elements(KaxInfo::ClassInfos.GlobalId, [this, &analyzer](kax_analyzer_data_c const &data) {
+      handleElementFound(analyzer, data);
+    });
+
+  if (d->m_pendingTracks) {
+    emit tracksRead(d->m_pendingTracks);
+    d->m_pendingTracks.reset();
+  }
+
+  if (!d->m_tracksRead)
+    analyzer.with_elements(KaxTracks::ClassInfos.GlobalId, [this, &analyzer](kax_analyzer_data_c const &data) {
+      handleElementFound(analyzer, data);
+    });
+
+  if (d->m_pendingTracks) {
+    emit tracksRead(d->m_pendingTracks);
+    d->m_pendingTracks.reset();
+  }
+}
+
+void
+AnalysisWorker::analyze() {
+  Q_D(AnalysisWorker);
+
+  QString fileName;
+  {
+    QMutexLocker lock{&d->m_mutex};
+    fileName = d->m_fileName;
+  }
+
+  d->m_pendingTracks.reset();
+  d->m_segmentInfoRead = false;
+  d->m_tracksRead      = false;
+  d->m_lastPercentage  = -1;
+  d->m_analyzer        = std::make_unique<BackgroundKaxAnalyzer>(*this, fileName);
+
+  emit analysisStarted();
+
+  auto &analyzer = *d->m_analyzer;
+  auto ok        = false;
+  QString error;
+
+  try {
+    ok = analyzer.set_parse_mode(kax_analyzer_c::parse_mode_fast)
+      .set_open_mode(MODE_READ)
+      .set_throw_on_error(true)
+      .process();
+
+    if (ok) {
+      emitSegmentInfoAndTracks(analyzer);
+
+      analyzer.with_elements(KaxAttachments::ClassInfos.GlobalId, [this, &analyzer](kax_analyzer_data_c const &data) {
+        auto attachments = analyzer.read_element(data);
+        if (attachments)
+          emit attachmentsRead(attachments);
+      });
+    }
+
+  } catch (mtx::kax_analyzer_x &ex) {
+    ok    = false;
+    error = Q(ex.what());
+  }
+
+  analyzer.close_file();
+
+  auto aborted = !ok && error.isEmpty() && isAnalysisAborted();
+  if (!ok)
+    d->m_analyzer.reset();
+
+  emit analysisFinished(ok, aborted, error);
+}
+
+void
+AnalysisWorker::modify() {
+  Q_D(AnalysisWorker);
+
+  QList<Modification> modifications;
+  {
+    QMutexLocker lock{&d->m_mutex};
+    modifications = d->m_modifications;
+    d->m_modifications.clear();
+  }
+
+  emit modificationStarted();
+
+  if (!d->m_analyzer) {
+    emit modificationFinished(false, {});
+    return;
+  }
+
+  auto &analyzer = *d->m_analyzer;
+  auto ok        = true;
+  QString error;
+
+  try {
+    for (auto const &modification : modifications) {
+      auto result = modification.m_removeAll ? analyzer.remove_elements(EbmlId(*modification.m_element))
+                  :                            analyzer.update_element(modification.m_element, true);
+
+      if (kax_analyzer_c::uer_success != result) {
+        emit modificationFailed(static_cast<int>(result), modification.m_failureMessage);
+        ok = false;
+      }
+    }
+
+  } catch (mtx::kax_analyzer_x &ex) {
+    error = Q(ex.what());
+    ok    = false;
+  }
+
+  analyzer.close_file();
+  d->m_analyzer.reset();
+
+  // The elements must be released before the GUI thread gets to
+  // touch their children again.
+  modifications.clear();
+
+  emit modificationFinished(ok, error);
+}
+
+// ------------------------------------------------------------
+
+AnalysisThread::AnalysisThread(QObject *parent)
+  : QThread{parent}
+  , m_worker{new AnalysisWorker{}}
+{
+  m_worker->moveToThread(this);
+}
+
+AnalysisThread::~AnalysisThread() {
+}
+
+AnalysisWorker &
+AnalysisThread::worker() {
+  return *m_worker;
+}
+
+void
+AnalysisThread::abortAnalysis() {
+  worker().abortAnalysis();
+}
+
+}}}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <QList>
+#include <QString>
+#include <QThread>
+
+#include "common/kax_analyzer.h"
+
+namespace mtx { namespace gui { namespace HeaderEditor {
+
+class AnalysisWorkerPrivate;
+class AnalysisWorker : public QObject {
+  Q_OBJECT;
+
+public:
+  // One element to write to the file. If m_removeAll is set all
+  // level 1 elements with m_element's ID are removed instead.
+  struct Modification {
+    ebml_element_cptr m_element;
+    bool m_removeAll{};
+    QString m_failureMessage;
+  };
+
+protected:
+  Q_DECLARE_PRIVATE(AnalysisWorker);
+
+  QScopedPointer<AnalysisWorkerPrivate> const d_ptr;
+
+public:
+  AnalysisWorker(QObject *parent = nullptr);
+  virtual ~AnalysisWorker();
+
+  void analyzeFile(QString const &fileName);
+  // Writes the modifications using the analyzer of the last
+  // successful analysis.
+  void modifyFile(QList<Modification> const &modifications);
+  void abortAnalysis();
+
+  bool isAnalysisAborted() const;
+  void reportProgress(int percentage);
+  void handleElementFound(kax_analyzer_c &analyzer, kax_analyzer_data_c const &data);
+
+protected slots:
+  void analyze();
+  void modify();
+
+signals:
+  void analysisStarted();
+  void analysisProgressChanged(int percentage);
+  void segmentInfoRead(ebml_element_cptr segmentInfo);
+  void tracksRead(ebml_element_cptr tracks);
+  void attachmentsRead(ebml_element_cptr attachments);
+  void analysisFinished(bool ok, bool aborted, QString const &error);
+
+  void modificationStarted();
+  void modificationFailed(int result, QString const &message);
+  void modificationFinished(bool ok, QString const &error);
+
+protected:
+  void emitSegmentInfoAndTracks(kax_analyzer_c &analyzer);
+};
+
+class AnalysisThread : public QThread {
+  Q_OBJECT;
+
+protected:
+  QScopedPointer<AnalysisWorker> m_worker;
+
+public:
+  AnalysisThread(QObject *parent = nullptr);
+  virtual ~AnalysisThread();
+
+  AnalysisWorker &worker();
+
+public slots:
+  void abortAnalysis();
+};
+
+}}}
+
+Q_DECLARE_METATYPE(ebml_element_cptr);
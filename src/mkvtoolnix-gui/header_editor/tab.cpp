@@ -17,6 +17,7 @@
 #include "common/mm_io_x.h"
 #include "common/property_element.h"
 #include "common/qt.h"
+#include "common/qt_kax_analyzer.h"
 #include "common/segmentinfo.h"
 #include "common/strings/formatting.h"
 #include "common/unique_numbers.h"
@@ -55,6 +56,7 @@ Tab::Tab(QWidget *parent,
   : QWidget{parent}
   , ui{new Ui::Tab}
   , m_fileName{fileName}
+  , m_analysisThread{new AnalysisThread{this}}
   , m_model{new PageModel{this}}
   , m_treeContextMenu{new QMenu{this}}
   , m_expandAllAction{new QAction{this}}
@@ -74,20 +76,51 @@ Tab::Tab(QWidget *parent,
 }
 
 Tab::~Tab() {
+  // Writing cannot be interrupted safely; wait for it to finish.
+  m_analysisThread->abortAnalysis();
+  m_analysisThread->quit();
+  m_analysisThread->wait();
 }
 
 void
 Tab::resetData() {
-  m_analyzer.reset();
   m_eSegmentInfo.reset();
   m_eTracks.reset();
+  m_loadedAttachments.clear();
   m_model->reset();
   m_segmentinfoPage = nullptr;
+  m_attachmentsPage = nullptr;
+}
+
+bool
+Tab::isBusy()
+  const {
+  return m_analyzing || m_saving;
+}
+
+void
+Tab::showProgress(QString const &status,
+                  bool cancellable) {
+  ui->analysisStatus->setText(status);
+  // Writing doesn't report its progress; show a busy indicator instead.
+  ui->analysisProgress->setRange(0, cancellable ? 100 : 0);
+  ui->analysisProgress->setValue(0);
+  ui->abortAnalysis->setVisible(cancellable);
+  ui->analysisProgressWidget->setVisible(true);
+}
+
+void
+Tab::hideProgress() {
+  ui->analysisProgressWidget->setVisible(false);
 }
 
 void
 Tab::load() {
-  QVector<int> selectedRows;
+  if (isBusy())
+    return;
+
+  m_selectedRows.clear();
+  m_expansionStatus.clear();
 
   auto selectedIdx = ui->elements->selectionModel()->currentIndex();
   if (!selectedIdx.isValid()) {
@@ -97,15 +130,13 @@ Tab::load() {
   }
 
   while (selectedIdx.isValid()) {
-    selectedRows.insert(0, selectedIdx.row());
+    m_selectedRows.insert(0, selectedIdx.row());
     selectedIdx = selectedIdx.sibling(selectedIdx.row(), 0).parent();
   }
 
-  QHash<QString, bool> expansionStatus;
-
   for (auto const &page : m_model->allExpandablePages()) {
     auto key = dynamic_cast<TopLevelPage &>(*page).internalIdentifier();
-    expansionStatus[key] = ui->elements->isExpanded(page->m_pageIdx);
+    m_expansionStatus[key] = ui->elements->isExpanded(page->m_pageIdx);
   }
 
   resetData();
@@ -119,48 +150,52 @@ Tab::load() {
     return;
   }
 
-  m_analyzer = std::make_unique<QtKaxAnalyzer>(this, m_fileName);
-  bool ok    = false;
-  QString error;
+  // The segment information and the tracks are added as soon as the
+  // analysis has read them; see finishLoading() for the rest.
+  m_analyzing = true;
+  showProgress(QY("The file is being analyzed."), true);
 
-  try {
-    ok = m_analyzer->set_parse_mode(kax_analyzer_c::parse_mode_fast)
-      .set_open_mode(MODE_READ)
-      .set_throw_on_error(true)
-      .process();
+  m_analysisThread->worker().analyzeFile(m_fileName);
+}
+
+void
+Tab::finishLoading(bool ok,
+                   bool aborted,
+                   QString const &error) {
+  m_analyzing = false;
+  hideProgress();
 
-  } catch (mtx::kax_analyzer_x &ex) {
-    error = QY("Error details: %1.").arg(Q(ex.what()));
+  if (aborted) {
+    emit removeThisTab();
+    return;
   }
 
   if (!ok) {
-    if (error.isEmpty())
-      error = QY("Possible reasons are: the file is not a Matroska file; the file is write-protected; the file is locked by another process; you do not have permission to access the file.");
+    auto details = !error.isEmpty() ? QY("Error details: %1.").arg(error)
+                 :                    QY("Possible reasons are: the file is not a Matroska file; the file is write-protected; the file is locked by another process; you do not have permission to access the file.");
 
     auto text = Q("%1 %2")
       .arg(QY("The file you tried to open (%1) could not be read successfully.").arg(m_fileName))
-      .arg(error);
+      .arg(details);
     Util::MessageBox::critical(this)->title(QY("File parsing failed")).text(text).exec();
     emit removeThisTab();
     return;
   }
 
-  populateTree();
-
-  m_analyzer->close_file();
+  handleAttachments();
 
   for (auto const &page : m_model->allExpandablePages()) {
     auto key = dynamic_cast<TopLevelPage &>(*page).internalIdentifier();
-    ui->elements->setExpanded(page->m_pageIdx, expansionStatus[key]);
+    ui->elements->setExpanded(page->m_pageIdx, m_expansionStatus[key]);
   }
 
   Util::resizeViewColumnsToContents(ui->elements);
 
-  if (selectedRows.isEmpty())
+  if (m_selectedRows.isEmpty())
     return;
 
-  selectedIdx = m_model->index(selectedRows.takeFirst(), 0);
-  for (auto row : selectedRows)
+  auto selectedIdx = m_model->index(m_selectedRows.takeFirst(), 0);
+  for (auto row : m_selectedRows)
     selectedIdx = m_model->index(row, 0, selectedIdx);
 
   auto selection = QItemSelection{selectedIdx, selectedIdx.sibling(selectedIdx.row(), m_model->columnCount() - 1)};
@@ -170,6 +205,11 @@ Tab::load() {
 
 void
 Tab::save() {
+  if (isBusy()) {
+    MainWindow::get()->setStatusBarMessage(QY("The file cannot be saved while it is being analyzed or saved."));
+    return;
+  }
+
   auto segmentinfoModified = false;
   auto tracksModified      = false;
   auto attachmentsModified = false;
@@ -201,48 +241,60 @@ Tab::save() {
 
   doModifications();
 
-  bool ok = true;
+  auto modifications = QList<AnalysisWorker::Modification>{};
 
-  try {
-    if (segmentinfoModified && m_eSegmentInfo) {
-      auto result = m_analyzer->update_element(m_eSegmentInfo, true);
-      if (kax_analyzer_c::uer_success != result) {
-        QtKaxAnalyzer::displayUpdateElementResult(this, result, QY("Saving the modified segment information header failed."));
-        ok = false;
-      }
-    }
+  if (segmentinfoModified && m_eSegmentInfo)
+    modifications << AnalysisWorker::Modification{m_eSegmentInfo, false, QY("Saving the modified segment information header failed.")};
 
-    if (tracksModified && m_eTracks) {
-      auto result = m_analyzer->update_element(m_eTracks, true);
-      if (kax_analyzer_c::uer_success != result) {
-        QtKaxAnalyzer::displayUpdateElementResult(this, result, QY("Saving the modified track headers failed."));
-        ok = false;
-      }
-    }
+  if (tracksModified && m_eTracks)
+    modifications << AnalysisWorker::Modification{m_eTracks, false, QY("Saving the modified track headers failed.")};
 
-    if (attachmentsModified) {
-      auto attachments = std::make_shared<KaxAttachments>();
+  if (attachmentsModified) {
+    // The attached files are owned by their pages. Release them from
+    // the master only after the worker is done with it.
+    auto attachments = ebml_element_cptr{new KaxAttachments, [](EbmlElement *element) {
+      static_cast<KaxAttachments *>(element)->RemoveAll();
+      delete element;
+    }};
+    auto &master     = static_cast<KaxAttachments &>(*attachments);
 
-      for (auto const &attachedFilePage : m_attachmentsPage->m_children)
-        attachments->PushElement(*dynamic_cast<AttachedFilePage &>(*attachedFilePage).m_attachment.get());
+    for (auto const &attachedFilePage : m_attachmentsPage->m_children)
+      master.PushElement(*dynamic_cast<AttachedFilePage &>(*attachedFilePage).m_attachment.get());
 
-      auto result = attachments->ListSize() ? m_analyzer->update_element(attachments.get(), true)
-                  :                           m_analyzer->remove_elements(KaxAttachments::ClassInfos.GlobalId);
+    modifications << AnalysisWorker::Modification{attachments, !master.ListSize(), QY("Saving the modified attachments failed.")};
+  }
 
-      attachments->RemoveAll();
+  // The pages must not be modified while their elements are written.
+  m_saving = true;
+  m_modificationFailures.clear();
+  ui->elements->setEnabled(false);
+  ui->pageContainer->setEnabled(false);
+  showProgress(QY("The modifications are being saved."), false);
 
-      if (kax_analyzer_c::uer_success != result) {
-        QtKaxAnalyzer::displayUpdateElementResult(this, result, QY("Saving the modified attachments failed."));
-        ok = false;
-      }
-    }
+  m_analysisThread->worker().modifyFile(modifications);
+}
 
-  } catch (mtx::kax_analyzer_x &ex) {
-    QMessageBox::critical(this, QY("Error writing Matroska file"), QY("Error details: %1.").arg(Q(ex.what())));
-    ok = false;
-  }
+void
+Tab::recordModificationFailure(int result,
+                               QString const &message) {
+  m_modificationFailures << qMakePair(result, message);
+}
 
-  m_analyzer->close_file();
+void
+Tab::finishSaving(bool ok,
+                  QString const &error) {
+  m_saving = false;
+  ui->elements->setEnabled(true);
+  ui->pageContainer->setEnabled(true);
+  hideProgress();
+
+  for (auto const &failure : m_modificationFailures)
+    QtKaxAnalyzer::displayUpdateElementResult(this, static_cast<kax_analyzer_c::update_element_result_e>(failure.first), failure.second);
+
+  m_modificationFailures.clear();
+
+  if (!error.isEmpty())
+    QMessageBox::critical(this, QY("Error writing Matroska file"), QY("Error details: %1.").arg(error));
 
   load();
 
@@ -264,6 +316,10 @@ Tab::setupUi() {
   Util::HeaderViewManager::create(*ui->elements, "HeaderEditor::Elements");
   Util::preventScrollingWithoutFocus(this);
 
+  hideProgress();
+
+  auto &worker = m_analysisThread->worker();
+
   connect(ui->elements,                              &Util::BasicTreeView::customContextMenuRequested, this, &Tab::showTreeContextMenu);
   connect(ui->elements,                              &Util::BasicTreeView::filesDropped,               this, &Tab::handleDroppedFiles);
   connect(ui->elements,                              &Util::BasicTreeView::deletePressed,              this, &Tab::removeSelectedAttachment);
@@ -276,6 +332,16 @@ Tab::setupUi() {
   connect(m_saveAttachmentContentAction,             &QAction::triggered,                              this, &Tab::saveAttachmentContent);
   connect(m_replaceAttachmentContentAction,          &QAction::triggered,                              [this]() { replaceAttachmentContent(false); });
   connect(m_replaceAttachmentContentSetValuesAction, &QAction::triggered,                              [this]() { replaceAttachmentContent(true); });
+  connect(ui->abortAnalysis,                         &QPushButton::clicked,                            m_analysisThread, &AnalysisThread::abortAnalysis);
+  connect(&worker,                                   &AnalysisWorker::analysisProgressChanged,         ui->analysisProgress, &QProgressBar::setValue);
+  connect(&worker,                                   &AnalysisWorker::segmentInfoRead,                 this, &Tab::handleSegmentInfo);
+  connect(&worker,                                   &AnalysisWorker::tracksRead,                      this, &Tab::handleTracks);
+  connect(&worker,                                   &AnalysisWorker::attachmentsRead,                 this, &Tab::collectAttachments);
+  connect(&worker,                                   &AnalysisWorker::analysisFinished,                this, &Tab::finishLoading);
+  connect(&worker,                                   &AnalysisWorker::modificationFailed,              this, &Tab::recordModificationFailure);
+  connect(&worker,                                   &AnalysisWorker::modificationFinished,            this, &Tab::finishSaving);
+
+  m_analysisThread->start();
 }
 
 void
@@ -301,6 +367,7 @@ void
 Tab::retranslateUi() {
   ui->fileNameLabel->setText(QY("File name:"));
   ui->directoryLabel->setText(QY("Directory:"));
+  ui->abortAnalysis->setText(QY("&Cancel"));
 
   m_expandAllAction->setText(QY("&Expand all"));
   m_collapseAllAction->setText(QY("&Collapse all"));
@@ -330,19 +397,6 @@ Tab::setupToolTips() {
   Util::setToolTip(ui->elements, QY("Right-click for actions for header elements and attachments"));
 }
 
-void
-Tab::populateTree() {
-  m_analyzer->with_elements(KaxInfo::ClassInfos.GlobalId, [this](kax_analyzer_data_c const &data) {
-    handleSegmentInfo(data);
-  });
-
-  m_analyzer->with_elements(KaxTracks::ClassInfos.GlobalId, [this](kax_analyzer_data_c const &data) {
-    handleTracks(data);
-  });
-
-  handleAttachments();
-}
-
 void
 Tab::selectionChanged(QModelIndex const &current,
                       QModelIndex const &) {
@@ -449,8 +503,8 @@ Tab::createValuePage(TopLevelPage &parentPage,
 }
 
 void
-Tab::handleSegmentInfo(kax_analyzer_data_c const &data) {
-  m_eSegmentInfo = m_analyzer->read_element(data);
+Tab::handleSegmentInfo(ebml_element_cptr const &element) {
+  m_eSegmentInfo = element;
   if (!m_eSegmentInfo)
     return;
 
@@ -464,11 +518,13 @@ Tab::handleSegmentInfo(kax_analyzer_data_c const &data) {
     createValuePage(*page, info, element);
 
   m_segmentinfoPage = page;
+
+  Util::resizeViewColumnsToContents(ui->elements);
 }
 
 void
-Tab::handleTracks(kax_analyzer_data_c const &data) {
-  m_eTracks = m_analyzer->read_element(data);
+Tab::handleTracks(ebml_element_cptr const &element) {
+  m_eTracks = element;
   if (!m_eTracks)
     return;
 
@@ -536,30 +592,33 @@ Tab::handleTracks(kax_analyzer_data_c const &data) {
         createValuePage(*parentPage, *parentMaster, element);
     }
   }
+
+  Util::resizeViewColumnsToContents(ui->elements);
 }
 
 void
-Tab::handleAttachments() {
-  auto attachments = KaxAttachedList{};
-
-  m_analyzer->with_elements(KaxAttachments::ClassInfos.GlobalId, [this, &attachments](kax_analyzer_data_c const &data) {
-    auto master = std::dynamic_pointer_cast<KaxAttachments>(m_analyzer->read_element(data));
-    if (!master)
-      return;
+Tab::collectAttachments(ebml_element_cptr const &element) {
+  auto master = std::dynamic_pointer_cast<KaxAttachments>(element);
+  if (!master)
+    return;
 
-    auto idx = 0u;
-    while (idx < master->ListSize()) {
-      auto attached = dynamic_cast<KaxAttached *>((*master)[idx]);
-      if (attached) {
-        attachments << KaxAttachedPtr{attached};
-        master->Remove(idx);
-      } else
-        ++idx;
-    }
-  });
+  auto idx = 0u;
+  while (idx < master->ListSize()) {
+    auto attached = dynamic_cast<KaxAttached *>((*master)[idx]);
+    if (attached) {
+      m_loadedAttachments << KaxAttachedPtr{attached};
+      master->Remove(idx);
+    } else
+      ++idx;
+  }
+}
 
-  m_attachmentsPage = new AttachmentsPage{*this, attachments};
+void
+Tab::handleAttachments() {
+  m_attachmentsPage = new AttachmentsPage{*this, m_loadedAttachments};
   m_attachmentsPage->init();
+
+  m_loadedAttachments.clear();
 }
 
 void
@@ -627,6 +686,8 @@ Tab::showTreeContextMenu(QPoint const &pos) {
   m_treeContextMenu->addSeparator();
   m_treeContextMenu->addAction(m_addAttachmentsAction);
 
+  m_addAttachmentsAction->setEnabled(!!m_attachmentsPage);
+
   if (isAttachments) {
     m_treeContextMenu->addAction(m_removeAttachmentAction);
     m_treeContextMenu->addSeparator();
@@ -645,6 +706,9 @@ Tab::showTreeContextMenu(QPoint const &pos) {
 
 void
 Tab::selectAttachmentsAndAdd() {
+  if (!m_attachmentsPage)
+    return;
+
   auto &settings = Util::Settings::get();
   auto fileNames = Util::getOpenFileNames(this, QY("Add attachments"), settings.lastOpenDirPath(), QY("All files") + Q(" (*)"));
 
@@ -668,6 +732,10 @@ Tab::addAttachment(KaxAttachedPtr const &attachment) {
 
 void
 Tab::addAttachments(QStringList const &fileNames) {
+  // The attachments page is only created once the analysis is done.
+  if (!m_attachmentsPage)
+    return;
+
   for (auto const &fileName : fileNames)
     addAttachment(createAttachmentFromFile(fileName));
 
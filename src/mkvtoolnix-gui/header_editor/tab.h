@@ -3,8 +3,10 @@
 #include "common/common_pch.h"
 
 #include <QDateTime>
+#include <QHash>
+#include <QVector>
 
-#include "common/qt_kax_analyzer.h"
+#include "mkvtoolnix-gui/header_editor/analysis_thread.h"
 #include "mkvtoolnix-gui/header_editor/page_model.h"
 
 class QAction;
@@ -33,7 +35,8 @@ protected:
   std::unique_ptr<Ui::Tab> ui;
 
   QString m_fileName;
-  std::unique_ptr<QtKaxAnalyzer> m_analyzer;
+  AnalysisThread *m_analysisThread;
+  bool m_analyzing{}, m_saving{};
 
   PageModel *m_model;
   PageBase *m_segmentinfoPage{};
@@ -43,6 +46,13 @@ protected:
   QAction *m_expandAllAction, *m_collapseAllAction, *m_addAttachmentsAction, *m_removeAttachmentAction, *m_saveAttachmentContentAction, *m_replaceAttachmentContentAction, *m_replaceAttachmentContentSetValuesAction;
 
   std::shared_ptr<EbmlElement> m_eSegmentInfo, m_eTracks;
+  QList<KaxAttachedPtr> m_loadedAttachments;
+
+  // State to restore once a reload has finished:
+  QVector<int> m_selectedRows;
+  QHash<QString, bool> m_expansionStatus;
+
+  QList<QPair<int, QString>> m_modificationFailures;
 
 public:
   explicit Tab(QWidget *parent, QString const &fileName);
@@ -55,6 +65,7 @@ public:
   virtual void appendPage(PageBase *page, QModelIndex const &parentIdx = {});
   virtual QString const &fileName() const;
   virtual QString title() const;
+  virtual bool isBusy() const;
   virtual void validate();
   virtual void addAttachment(KaxAttachedPtr const &attachment);
 
@@ -75,14 +86,21 @@ public slots:
   virtual void replaceAttachmentContent(bool deriveNameAndMimeType);
   virtual void handleDroppedFiles(QStringList const &fileNames, Qt::MouseButtons mouseButtons);
 
+protected slots:
+  void handleSegmentInfo(ebml_element_cptr const &element);
+  void handleTracks(ebml_element_cptr const &element);
+  void collectAttachments(ebml_element_cptr const &element);
+  void finishLoading(bool ok, bool aborted, QString const &error);
+  void recordModificationFailure(int result, QString const &message);
+  void finishSaving(bool ok, QString const &error);
+
 protected:
   void setupUi();
   void setupToolTips();
-  void handleSegmentInfo(kax_analyzer_data_c const &data);
-  void handleTracks(kax_analyzer_data_c const &data);
   void handleAttachments();
-  void populateTree();
   void resetData();
+  void showProgress(QString const &status, bool cancellable);
+  void hideProgress();
   void doModifications();
   void expandCollapseAll(bool expand, QModelIndex const &parentIdx = {});
   void reportValidationFailure(bool isCritical, QModelIndex const &pageIdx);
@@ -185,6 +185,11 @@ Tool::reload() {
   if (!tab)
     return;
 
+  if (tab->isBusy()) {
+    MainWindow::get()->setStatusBarMessage(QY("The file cannot be reloaded while it is being analyzed or saved."));
+    return;
+  }
+
   if (Util::Settings::get().m_warnBeforeClosingModifiedTabs && tab->hasBeenModified()) {
     auto answer = Util::MessageBox::question(this)
       ->title(QY("Reload modified file"))
@@ -213,6 +218,13 @@ Tool::closeTab(int index) {
 
   auto tab = static_cast<Tab *>(ui->editors->widget(index));
 
+  if (tab->isBusy()) {
+    MainWindow::get()->switchToTool(this);
+    ui->editors->setCurrentIndex(index);
+    MainWindow::get()->setStatusBarMessage(QY("The file cannot be closed while it is being analyzed or saved."));
+    return false;
+  }
+
   if (Util::Settings::get().m_warnBeforeClosingModifiedTabs && tab->hasBeenModified()) {
     MainWindow::get()->switchToTool(this);
     ui->editors->setCurrentIndex(index);
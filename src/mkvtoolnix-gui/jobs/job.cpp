@@ -87,6 +87,14 @@ Job::progress()
   return d->progress;
 }
 
+Job::ProgressStatistics
+Job::progressStatistics()
+  const {
+  Q_D(const Job);
+
+  return d->progressStatistics;
+}
+
 QStringList const &
 Job::output()
   const {
@@ -245,6 +253,16 @@ Job::setProgress(unsigned int progress) {
   emit progressChanged(d->id, d->progress);
 }
 
+void
+Job::setProgressStatistics(ProgressStatistics const &statistics) {
+  Q_D(Job);
+
+  QMutexLocker locked{&d->mutex};
+
+  d->progressStatistics = statistics;
+  emit progressStatisticsChanged(d->id, d->progressStatistics);
+}
+
 void
 Job::setPendingAuto() {
   Q_D(Job);
@@ -300,6 +318,14 @@ Job::displayableStatus(Status status) {
        :                           QY("Unknown");
 }
 
+QString
+Job::displayableThroughput(ProgressStatistics const &statistics) {
+  return QY("%1 MB/s read, %2 MB/s written, %3 packets/s")
+    .arg(statistics.readRate  / 1024.0 / 1024.0, 0, 'f', 1)
+    .arg(statistics.writeRate / 1024.0 / 1024.0, 0, 'f', 1)
+    .arg(statistics.packetRate);
+}
+
 QString
 Job::outputFolder()
   const {
@@ -53,6 +53,12 @@ public:
     ErrorLine,
   };
 
+  // Throughput as reported by the programs run by the job. Durations
+  // are in milliseconds, rates per second. "remaining" is -1 if unknown.
+  struct ProgressStatistics {
+    qint64 elapsed{}, remaining{-1}, bytesRead{}, bytesWritten{}, numPackets{}, readRate{}, writeRate{}, packetRate{};
+  };
+
 public:
   Job(Status status = PendingManual);
   virtual ~Job();
@@ -64,6 +70,7 @@ public:
   Status status() const;
   QString description() const;
   unsigned int progress() const;
+  ProgressStatistics progressStatistics() const;
 
   QStringList const &output() const;
   QStringList const &warnings() const;
@@ -113,6 +120,7 @@ protected:
 public slots:
   virtual void setStatus(Job::Status status);
   virtual void setProgress(unsigned int progress);
+  virtual void setProgressStatistics(mtx::gui::Jobs::Job::ProgressStatistics const &statistics);
   virtual void addLineToInternalLogs(QString const &line, mtx::gui::Jobs::Job::LineType type);
   virtual void abort() = 0;
   virtual void updateUnacknowledgedWarningsAndErrors();
@@ -121,12 +129,14 @@ public slots:
 signals:
   void statusChanged(uint64_t id, mtx::gui::Jobs::Job::Status oldStatus, mtx::gui::Jobs::Job::Status newStatus);
   void progressChanged(uint64_t id, unsigned int progress);
+  void progressStatisticsChanged(uint64_t id, mtx::gui::Jobs::Job::ProgressStatistics const &statistics);
   void numUnacknowledgedWarningsOrErrorsChanged(uint64_t id, int numWarnings, int numErrors);
 
   void lineRead(QString const &line, mtx::gui::Jobs::Job::LineType type);
 
 public:                         // static
   static QString displayableStatus(Status status);
+  static QString displayableThroughput(ProgressStatistics const &statistics);
   static JobPtr loadJob(Util::ConfigFile &settings);
   static JobPtr loadJob(QString const &fileName);
 
@@ -137,3 +147,4 @@ public:                         // static
 
 Q_DECLARE_METATYPE(mtx::gui::Jobs::Job::LineType);
 Q_DECLARE_METATYPE(mtx::gui::Jobs::Job::Status);
+Q_DECLARE_METATYPE(mtx::gui::Jobs::Job::ProgressStatistics);
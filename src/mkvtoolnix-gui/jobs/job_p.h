@@ -12,6 +12,7 @@ public:
   QString description;
   QStringList output, warnings, errors, fullOutput;
   unsigned int progress{}, exitCode{std::numeric_limits<unsigned int>::max()};
+  Job::ProgressStatistics progressStatistics;
   int warningsAcknowledged{}, errorsAcknowledged{};
   QDateTime dateAdded, dateStarted, dateFinished;
   bool quitAfterFinished{}, modified{true};
@@ -8,6 +8,7 @@
 #include <QTemporaryFile>
 #include <QTimer>
 
+#include "common/list_utils.h"
 #include "common/qt.h"
 #include "mkvtoolnix-gui/jobs/mux_job.h"
 #include "mkvtoolnix-gui/jobs/mux_job_p.h"
@@ -74,6 +75,7 @@ MuxJob::start() {
 
   setStatus(Job::Running);
   setProgress(0);
+  setProgressStatistics({});
 
   d->process.start(Util::Settings::get().actualMkvmergeExe(), QStringList{} << "--gui-mode" << QString{"@%1"}.arg(d->settingsFile->fileName()), QIODevice::ReadOnly);
 }
@@ -127,6 +129,11 @@ MuxJob::processLine(QString const &rawLine) {
     return;
   }
 
+  if (line.startsWith("#GUI#progress_statistics#")) {
+    processProgressStatistics(line);
+    return;
+  }
+
   auto matches = QRegularExpression{"^#GUI#progress\\s+(\\d+)%"}.match(line);
   if (matches.hasMatch()) {
     setProgress(matches.captured(1).toUInt());
@@ -136,6 +143,32 @@ MuxJob::processLine(QString const &rawLine) {
   emit lineRead(line, InfoLine);
 }
 
+void
+MuxJob::processProgressStatistics(QString const &line) {
+  // Format: #GUI#progress_statistics#key1=value1#key2=value2…
+  auto statistics = ProgressStatistics{};
+
+  for (auto const &item : line.mid(25).split(Q("#"), QString::SkipEmptyParts)) {
+    auto keyValue = item.split(Q("="));
+    if (keyValue.size() != 2)
+      continue;
+
+    auto key   = keyValue[0];
+    auto value = keyValue[1].toLongLong();
+
+    if      (key == Q("elapsed"))       statistics.elapsed      = value;
+    else if (key == Q("remaining"))     statistics.remaining    = value;
+    else if (key == Q("bytes_read"))    statistics.bytesRead    = value;
+    else if (key == Q("bytes_written")) statistics.bytesWritten = value;
+    else if (key == Q("packets"))       statistics.numPackets   = value;
+    else if (key == Q("read_rate"))     statistics.readRate     = value;
+    else if (key == Q("write_rate"))    statistics.writeRate    = value;
+    else if (key == Q("packet_rate"))   statistics.packetRate   = value;
+  }
+
+  setProgressStatistics(statistics);
+}
+
 void
 MuxJob::readAvailable() {
   Q_D(MuxJob);
@@ -159,6 +192,12 @@ MuxJob::processFinished(int exitCode,
               : 1 == exitCode                      ? Job::DoneWarnings
               :                                      Job::Failed;
 
+  // mkvmerge reports the averages over the whole run together with
+  // the final progress.
+  auto statistics = progressStatistics();
+  if (mtx::included_in(status, Job::DoneOk, Job::DoneWarnings) && statistics.elapsed)
+    emit lineRead(QY("Average throughput: %1").arg(displayableThroughput(statistics)), InfoLine);
+
   setStatus(status);
 
   if (d->quitAfterFinished)
@@ -53,6 +53,7 @@ protected:
   void setupMuxJobConnections();
   void processBytesRead();
   void processLine(QString const &rawLine);
+  void processProgressStatistics(QString const &line);
   virtual void saveJobInternal(Util::ConfigFile &settings) const;
 
 signals:
@@ -7,6 +7,7 @@
 #include "common/fs_sys_helpers.h"
 #include "common/version.h"
 #include "mkvtoolnix-gui/app.h"
+#include "mkvtoolnix-gui/header_editor/analysis_thread.h"
 #include "mkvtoolnix-gui/jobs/job.h"
 #include "mkvtoolnix-gui/main_window/update_checker.h"
 #include "mkvtoolnix-gui/merge/source_file.h"
@@ -21,10 +22,12 @@ static void
 registerMetaTypes() {
   qRegisterMetaType<Jobs::Job::LineType>("Job::LineType");
   qRegisterMetaType<Jobs::Job::Status>("Job::Status");
+  qRegisterMetaType<Jobs::Job::ProgressStatistics>("Job::ProgressStatistics");
   qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
   qRegisterMetaType<std::shared_ptr<Merge::SourceFile>>("std::shared_ptr<SourceFile>");
   qRegisterMetaType<QList<std::shared_ptr<Merge::SourceFile>>>("QList<std::shared_ptr<SourceFile>>");
   qRegisterMetaType<QFileInfoList>("QFileInfoList");
+  qRegisterMetaType<ebml_element_cptr>("ebml_element_cptr");
   qRegisterMetaType<mtx_release_version_t>("mtx_release_version_t");
   qRegisterMetaType<std::shared_ptr<pugi::xml_document>>("std::shared_ptr<pugi::xml_document>");
 #if defined(HAVE_UPDATE_CHECK)
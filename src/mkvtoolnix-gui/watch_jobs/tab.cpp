@@ -39,6 +39,7 @@ class TabPrivate {
   uint64_t m_id, m_currentJobProgress, m_queueProgress;
   QHash<Jobs::Job::LineType, bool> m_currentJobLineTypeSeen;
   Jobs::Job::Status m_currentJobStatus;
+  Jobs::Job::ProgressStatistics m_currentJobStatistics;
   QDateTime m_currentJobStartTime;
   QString m_currentJobDescription;
   QMenu *m_whenFinished, *m_moreActions;
@@ -158,9 +159,10 @@ Tab::connectToJob(Jobs::Job const &job) {
   d->m_id                    = job.id();
   auto connType              = static_cast<Qt::ConnectionType>(Qt::AutoConnection | Qt::UniqueConnection);
 
-  connect(&job, &Jobs::Job::statusChanged,   this, &Tab::onStatusChanged,      connType);
-  connect(&job, &Jobs::Job::progressChanged, this, &Tab::onJobProgressChanged, connType);
-  connect(&job, &Jobs::Job::lineRead,        this, &Tab::onLineRead,           connType);
+  connect(&job, &Jobs::Job::statusChanged,             this, &Tab::onStatusChanged,                connType);
+  connect(&job, &Jobs::Job::progressChanged,           this, &Tab::onJobProgressChanged,           connType);
+  connect(&job, &Jobs::Job::progressStatisticsChanged, this, &Tab::onJobProgressStatisticsChanged, connType);
+  connect(&job, &Jobs::Job::lineRead,                  this, &Tab::onLineRead,                     connType);
 }
 
 void
@@ -172,9 +174,10 @@ Tab::disconnectFromJob(Jobs::Job const &job) {
     d->m_id                    = std::numeric_limits<uint64_t>::max();
   }
 
-  disconnect(&job, &Jobs::Job::statusChanged,   this, &Tab::onStatusChanged);
-  disconnect(&job, &Jobs::Job::progressChanged, this, &Tab::onJobProgressChanged);
-  disconnect(&job, &Jobs::Job::lineRead,        this, &Tab::onLineRead);
+  disconnect(&job, &Jobs::Job::statusChanged,             this, &Tab::onStatusChanged);
+  disconnect(&job, &Jobs::Job::progressChanged,           this, &Tab::onJobProgressChanged);
+  disconnect(&job, &Jobs::Job::progressStatisticsChanged, this, &Tab::onJobProgressStatisticsChanged);
+  disconnect(&job, &Jobs::Job::lineRead,                  this, &Tab::onLineRead);
 }
 
 uint64_t
@@ -273,6 +276,10 @@ Tab::updateRemainingTime() {
   if ((Jobs::Job::Running != d->m_currentJobStatus) || !d->m_currentJobProgress)
     d->ui->remainingTimeCurrentJob->setText(Q("–"));
 
+  // Prefer the estimate reported by the job itself.
+  else if (0 <= d->m_currentJobStatistics.remaining)
+    d->ui->remainingTimeCurrentJob->setText(Q(create_minutes_seconds_time_string(d->m_currentJobStatistics.remaining / 1000)));
+
   else
     updateOneRemainingTimeLabel(d->ui->remainingTimeCurrentJob, d->m_currentJobStartTime, d->m_currentJobProgress);
 
@@ -306,6 +313,29 @@ Tab::onJobProgressChanged(uint64_t,
   updateRemainingTime();
 }
 
+void
+Tab::onJobProgressStatisticsChanged(uint64_t,
+                                    Jobs::Job::ProgressStatistics const &statistics) {
+  Q_D(Tab);
+
+  if (QObject::sender() != d->m_currentlyConnectedJob)
+    return;
+
+  d->m_currentJobStatistics = statistics;
+  updateThroughput();
+  updateRemainingTime();
+}
+
+void
+Tab::updateThroughput() {
+  Q_D(Tab);
+
+  if (!d->m_currentJobStatistics.elapsed)
+    d->ui->throughputCurrentJob->setText(Q("–"));
+  else
+    d->ui->throughputCurrentJob->setText(Jobs::Job::displayableThroughput(d->m_currentJobStatistics));
+}
+
 void
 Tab::onLineRead(QString const &line,
                 Jobs::Job::LineType type) {
@@ -363,10 +393,11 @@ Tab::setInitialDisplay(Jobs::Job const &job) {
 
   d->m_currentJobLineTypeSeen.clear();
 
-  d->m_currentJobStatus    = job.status();
-  d->m_currentJobProgress  = job.progress();
-  d->m_currentJobStartTime = job.dateStarted();
-  d->m_queueProgress       = MainWindow::watchCurrentJobTab()->queueProgress();
+  d->m_currentJobStatus     = job.status();
+  d->m_currentJobProgress   = job.progress();
+  d->m_currentJobStatistics = job.progressStatistics();
+  d->m_currentJobStartTime  = job.dateStarted();
+  d->m_queueProgress        = MainWindow::watchCurrentJobTab()->queueProgress();
 
   d->ui->description->setText(d->m_currentJobDescription);
   d->ui->status->setText(Jobs::Job::displayableStatus(job.status()));
@@ -380,6 +411,7 @@ Tab::setInitialDisplay(Jobs::Job const &job) {
 
   d->ui->acknowledgeWarningsAndErrorsButton->setEnabled(job.numUnacknowledgedWarnings() || job.numUnacknowledgedErrors());
 
+  updateThroughput();
   updateRemainingTime();
 }
 
@@ -464,6 +496,7 @@ Tab::clearOutput() {
   d->ui->finishedAt->setText(QY("Not finished yet"));
   d->ui->remainingTimeCurrentJob->setText(Q("–"));
   d->ui->remainingTimeQueue->setText(Q("–"));
+  d->ui->throughputCurrentJob->setText(Q("–"));
 
   emit watchCurrentJobTabCleared();
 }
@@ -50,6 +50,7 @@ signals:
 public slots:
   void onStatusChanged(uint64_t id, mtx::gui::Jobs::Job::Status oldStatus, mtx::gui::Jobs::Job::Status newStatus);
   void onJobProgressChanged(uint64_t id, unsigned int progress);
+  void onJobProgressStatisticsChanged(uint64_t id, mtx::gui::Jobs::Job::ProgressStatistics const &statistics);
   void onQueueProgressChanged(int progress, int totalProgress);
   void onLineRead(QString const &line, mtx::gui::Jobs::Job::LineType type);
   void onAbort();
@@ -62,6 +63,7 @@ public slots:
   void disableButtonIfAllWarningsAndErrorsButtonAcknowledged(int numWarnings, int numErrors);
 
   void updateRemainingTime();
+  void updateThroughput();
 
   void enableMoreActionsActions();
   void setupWhenFinishedActions();
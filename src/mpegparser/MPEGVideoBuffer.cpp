@@ -38,21 +38,19 @@ MPEG2PictureHeader::MPEG2PictureHeader() {
 }
 
 int32_t MPEGVideoBuffer::FindStartCode(uint32_t startPos){
-  //How many bytes can we look through?
-  uint32_t window = myBuffer->GetLength() - startPos;
+  uint32_t length = GetLength();
 
-  if(window < 4) //Make sure we have enough bytes to search.
+  if((startPos + 4) > length) //Make sure we have enough bytes to search.
     return -1;
 
-  for(unsigned int i = startPos; i < (startPos + window - 3); i++){
-    CircBuffer& buf = *myBuffer;
-    binary a,b,c,d;
-    a = buf[i];
-    b = buf[i+1];
-    c = buf[i+2];
-    d = buf[i+3];
-    if((a == 0x00) && (b == 0x00) && (c == 0x01)){
-      switch(d){
+  binary* buf = myBlock->get_buffer() + readPos;
+
+  for(uint32_t i = startPos; i <= (length - 4); i++){
+    if((buf[i + 2] > 0x01) || (buf[i + 1] != 0x00)){ //can't be part of 00 00 01 at i
+      continue;
+    }
+    if((buf[i] == 0x00) && (buf[i + 1] == 0x00) && (buf[i + 2] == 0x01)){
+      switch(buf[i + 3]){
         case MPEG_VIDEO_SEQUENCE_START_CODE:
         case MPEG_VIDEO_GOP_START_CODE:
         case MPEG_VIDEO_PICTURE_START_CODE:
@@ -68,21 +66,30 @@ int32_t MPEGVideoBuffer::FindStartCode(uint32_t startPos){
 }
 
 void MPEGVideoBuffer::UpdateState(){
-  assert(myBuffer);
   int32_t test = 0;
-  if(myBuffer->GetLength() == 0){
+  uint32_t length = GetLength();
+  if(length == 0){
     state = MPEG2_BUFFER_STATE_EMPTY;
     return;
   }
+  //Everything before the last three bytes has been searched if no
+  //start code is found. Continue from there the next time instead of
+  //searching the whole window again.
+  uint32_t searched = length - std::min<uint32_t>(length, 3);
   if(chunkStart == -1){
-    test = FindStartCode(0);
-    if(test != -1)  //We found a new startcode
+    test = FindStartCode(scanPos);
+    if(test != -1){  //We found a new startcode
       chunkStart = test;
+      scanPos = chunkStart + 4;
+    }else
+      scanPos = std::max(scanPos, searched);
   }
-  if(chunkEnd == -1){
-    test = FindStartCode(chunkStart+4);
+  if((chunkStart != -1) && (chunkEnd == -1)){
+    test = FindStartCode(std::max<uint32_t>(chunkStart + 4, scanPos));
     if(test != -1)  //We found a new startcode
       chunkEnd = test;
+    else
+      scanPos = std::max(scanPos, searched);
   }
   if(chunkStart == -1 || chunkEnd == -1){
     state = MPEG2_BUFFER_STATE_NEED_MORE_DATA;
@@ -96,16 +103,15 @@ MPEGChunk * MPEGVideoBuffer::ReadChunk(){
   MPEGChunk* myChunk = nullptr;
   if(state == MPEG2_BUFFER_STATE_CHUNK_READY){
     assert(chunkStart < chunkEnd && chunkStart != -1 && chunkEnd != -1);
-    if(chunkStart != 0){ //we have to skip some bytes
-      myBuffer->Skip(chunkStart);
-    }
+    //Bytes before chunkStart are skipped. The chunk references the
+    //block instead of copying the data.
     uint32_t chunkLength = chunkEnd - chunkStart;
-    binary* chunkData = new binary[chunkLength];
-    myBuffer->Read(chunkData, chunkLength);
+    myChunk = new MPEGChunk(myBlock, readPos + chunkStart, chunkLength);
+    readPos += chunkEnd;
     chunkStart = 0; //we read up to the next start code
     chunkEnd = -1;
+    scanPos = 4;
     UpdateState();
-    myChunk = new MPEGChunk(chunkData, chunkLength);
     return myChunk;
   }else{
     return nullptr;
@@ -115,13 +121,38 @@ MPEGChunk * MPEGVideoBuffer::ReadChunk(){
 void MPEGVideoBuffer::ForceFinal(){
   if(state == MPEG2_BUFFER_STATE_NEED_MORE_DATA){
     chunkStart = 0;
-    chunkEnd = chunkStart + myBuffer->GetLength();
+    chunkEnd = chunkStart + GetLength();
     UpdateState();
   }
 }
 
+void MPEGVideoBuffer::MakeRoom(uint32_t numBytes){
+  if((writePos + numBytes) <= capacity)
+    return;
+
+  uint32_t length = GetLength();
+
+  //Chunks handed out earlier may still point into the current block.
+  if(myBlock.use_count() == 1){
+    memmove(myBlock->get_buffer(), myBlock->get_buffer() + readPos, length);
+  }else{
+    memory_cptr newBlock = memory_c::alloc(capacity);
+    memcpy(newBlock->get_buffer(), myBlock->get_buffer() + readPos, length);
+    myBlock = newBlock;
+  }
+
+  readPos = 0;
+  writePos = length;
+}
+
 int32_t MPEGVideoBuffer::Feed(binary* data, uint32_t numBytes){
-  uint32_t res = myBuffer->Write(data, numBytes);
+  int32_t res = -1;
+  if(numBytes <= static_cast<uint32_t>(GetFreeBufferSpace())){
+    MakeRoom(numBytes);
+    memcpy(myBlock->get_buffer() + writePos, data, numBytes);
+    writePos += numBytes;
+    res = 0;
+  }
   UpdateState();
   return res;
 }
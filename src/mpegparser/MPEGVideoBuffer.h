@@ -25,7 +25,6 @@
 #include "common/common_pch.h"
 
 #include "Types.h"
-#include "CircBuffer.h"
 
 #define MPEG_VIDEO_PICTURE_START_CODE  0x00
 #define MPEG_VIDEO_SEQUENCE_START_CODE  0xb3
@@ -86,6 +85,7 @@ private:
   binary * data;
   uint32_t size;
   uint8_t type;
+  memory_cptr block; //set if data points into a buffer shared with others
 public:
   MPEGChunk(binary* n_data, uint32_t n_size):
     data(n_data), size(n_size) {
@@ -96,8 +96,19 @@ public:
     type = data[3];
   }
 
+  //References the data instead of copying it. The block is kept alive
+  //for as long as the chunk exists.
+  MPEGChunk(memory_cptr const &n_block, uint32_t n_offset, uint32_t n_size):
+    data(n_block->get_buffer() + n_offset), size(n_size), block(n_block) {
+
+    assert(4 <= size);
+    assert((n_offset + size) <= n_block->get_size());
+
+    type = data[3];
+  }
+
   ~MPEGChunk(){
-    if(data)
+    if(data && !block)
       delete [] data;
   }
 
@@ -126,34 +137,49 @@ void ParseSequenceHeader(MPEGChunk* chunk, MPEG2SequenceHeader & hdr);
 bool ParsePictureHeader(MPEGChunk* chunk, MPEG2PictureHeader & hdr);
 bool ParseGOPHeader(MPEGChunk* chunk, MPEG2GOPHeader & hdr);
 
+//The unread data is always kept in one contiguous block of memory so
+//that start codes can be searched for without wrap-around
+//arithmetic. Chunks handed out reference that block instead of
+//copying their data. If the end of the block is reached, the unread
+//data is moved to the front of the block if no chunk references it
+//anymore or to a new block otherwise.
 class MPEGVideoBuffer{
 private:
-  CircBuffer * myBuffer;
+  memory_cptr myBlock;
+  uint32_t capacity;
+  uint32_t readPos;  //start of the unread data within the block
+  uint32_t writePos; //end of the unread data within the block
   MPEG2BufferState_e state;
   int32_t chunkStart;
   int32_t chunkEnd;
+  uint32_t scanPos;  //no wanted start code begins before this position
   void UpdateState();
   int32_t FindStartCode(uint32_t startPos = 0);
+  void MakeRoom(uint32_t numBytes);
 public:
   MPEGVideoBuffer(uint32_t size){
-    myBuffer = new CircBuffer(size);
+    myBlock = memory_c::alloc(size);
+    capacity = size;
+    readPos = 0;
+    writePos = 0;
     state = MPEG2_BUFFER_STATE_EMPTY;
     chunkStart = -1;
     chunkEnd = -1;
-  }
-
-  ~MPEGVideoBuffer(){
-    delete myBuffer;
+    scanPos = 0;
   }
 
   inline MPEG2BufferState_e GetState() const { return state; }
 
+  inline uint32_t GetLength() const {
+    return writePos - readPos;
+  }
+
   int32_t GetFreeBufferSpace(){
-    return (myBuffer->buf_capacity - myBuffer->bytes_in_buf);
+    return capacity - GetLength();
   }
 
   void SetEndOfData(){
-    chunkEnd = myBuffer->GetLength() - 1;
+    chunkEnd = GetLength() - 1;
   }
 
   void ForceFinal();  //prepares the remaining data as a chunk
@@ -38,7 +38,7 @@ public:
   aac_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, mtx::aac::audio_config_t const &config, mode_e mode);
   virtual ~aac_packetizer_c();
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -105,7 +105,7 @@ ac3_packetizer_c::set_headers() {
 }
 
 int
-ac3_packetizer_c::process(packet_cptr packet) {
+ac3_packetizer_c::process_impl(packet_cptr packet) {
   // mxinfo(boost::format("tc %1% size %2%\n") % format_timestamp(packet->timestamp) % packet->data->get_size());
 
   m_timestamp_calculator.add_timestamp(packet, m_stream_position);
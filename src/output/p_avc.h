@@ -24,7 +24,7 @@ protected:
 
 public:
   avc_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, double fps, int width, int height);
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
   virtual void set_headers();
 
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
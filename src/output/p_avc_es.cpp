@@ -32,6 +32,7 @@ avc_es_video_packetizer_c(generic_reader_c *p_reader,
                           track_info_c &p_ti)
   : generic_packetizer_c(p_reader, p_ti)
   , m_default_duration_for_interlaced_content(-1)
+  , m_source_nalu_size_length{}
   , m_first_frame(true)
   , m_set_display_dimensions(false)
   , m_debug_timestamps{   "avc_es|avc_es_timestamps"}
@@ -88,12 +89,22 @@ avc_es_video_packetizer_c::add_extra_data(memory_cptr data) {
   m_parser.add_bytes(data->get_buffer(), data->get_size());
 }
 
+void
+avc_es_video_packetizer_c::set_source_nalu_size_length(std::size_t nalu_size_length) {
+  m_source_nalu_size_length = nalu_size_length;
+}
+
 int
-avc_es_video_packetizer_c::process(packet_cptr packet) {
+avc_es_video_packetizer_c::process_impl(packet_cptr packet) {
   try {
     if (packet->has_timestamp())
       m_parser.add_timestamp(packet->timestamp);
-    m_parser.add_bytes(packet->data->get_buffer(), packet->data->get_size());
+
+    if (m_source_nalu_size_length)
+      m_parser.add_bytes_framed(packet->data, m_source_nalu_size_length);
+    else
+      m_parser.add_bytes(packet->data->get_buffer(), packet->data->get_size());
+
     flush_frames();
 
   } catch (mtx::mpeg::nalu_size_length_x &error) {
@@ -238,3 +249,10 @@ avc_es_video_packetizer_c::can_connect_to(generic_packetizer_c *src,
 
   return CAN_CONNECT_YES;
 }
+
+int64_t
+avc_es_video_packetizer_c::get_expected_header_growth()
+  const {
+  // The codec private data is only complete once the SPS/PPS have been found.
+  return generic_packetizer_c::get_expected_header_growth() + get_expected_codec_private_growth(1024);
+}
@@ -104,7 +104,7 @@ dts_packetizer_c::get_dts_packet(bool flushing) {
     dtsheader.has_exss         = false;
   }
 
-  packet_buf = memory_c::clone(buf + pos, dtsheader.frame_byte_size);
+  packet_buf = m_packet_buffer.slice(pos, dtsheader.frame_byte_size);
 
   m_packet_buffer.remove(bytes_to_remove);
 
@@ -124,7 +124,7 @@ dts_packetizer_c::set_headers() {
 }
 
 int
-dts_packetizer_c::process(packet_cptr packet) {
+dts_packetizer_c::process_impl(packet_cptr packet) {
   m_timestamp_calculator.add_timestamp(packet, m_stream_position);
   m_stream_position += packet->data->get_size();
 
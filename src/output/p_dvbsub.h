@@ -22,7 +22,7 @@ public:
   dvbsub_packetizer_c(generic_reader_c *reader, track_info_c &ti, memory_cptr const &private_data);
   virtual ~dvbsub_packetizer_c();
 
-  virtual int process(packet_cptr packet) override;
+  virtual int process_impl(packet_cptr packet) override;
   virtual void set_headers() override;
 
   virtual translatable_string_c get_format_name() const override {
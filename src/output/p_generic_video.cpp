@@ -69,7 +69,7 @@ generic_video_packetizer_c::set_headers() {
 // fref > 0:   B frame with given forward reference (absolute reference,
 //             not relative!)
 int
-generic_video_packetizer_c::process(packet_cptr packet) {
+generic_video_packetizer_c::process_impl(packet_cptr packet) {
   if ((0.0 == m_fps) && (-1 == packet->timestamp))
     mxerror_tid(m_ti.m_fname, m_ti.m_id, boost::format(Y("The FPS is 0.0 but the reader did not provide a timestamp for a packet. %1%\n")) % BUGMSG);
 
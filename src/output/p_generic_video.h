@@ -30,7 +30,7 @@ protected:
 public:
   generic_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, std::string const &codec_id, double fps, int width, int height);
 
-  virtual int process(packet_cptr packet) override;
+  virtual int process_impl(packet_cptr packet) override;
   virtual void set_headers() override;
 
   virtual translatable_string_c get_format_name() const override {
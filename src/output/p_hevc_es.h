@@ -21,16 +21,19 @@ class hevc_es_video_packetizer_c: public generic_packetizer_c {
 protected:
   mtx::hevc::es_parser_c m_parser;
   int64_t m_default_duration_for_interlaced_content;
+  std::size_t m_source_nalu_size_length;
   bool m_first_frame, m_set_display_dimensions, m_debug_timestamps, m_debug_aspect_ratio;
 
 public:
   hevc_es_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti);
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
+  virtual int64_t get_expected_header_growth() const;
   virtual void add_extra_data(memory_cptr data);
   virtual void set_headers();
   virtual void set_container_default_field_duration(int64_t default_duration);
   virtual unsigned int get_nalu_size_length() const;
+  virtual void set_source_nalu_size_length(std::size_t nalu_size_length);
 
   virtual void flush_frames();
 
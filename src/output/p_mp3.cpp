@@ -74,10 +74,10 @@ mp3_packetizer_c::handle_garbage(int64_t bytes) {
     }));
 }
 
-unsigned char *
+memory_cptr
 mp3_packetizer_c::get_mp3_packet(mp3_header_t *mp3header) {
   if (m_byte_buffer.get_size() == 0)
-    return 0;
+    return {};
 
   int pos;
   size_t size;
@@ -89,12 +89,12 @@ mp3_packetizer_c::get_mp3_packet(mp3_header_t *mp3header) {
     pos  = find_mp3_header(buf, size);
 
     if (0 > pos)
-      return nullptr;
+      return {};
 
     decode_mp3_header(&buf[pos], mp3header);
 
     if ((pos + mp3header->framesize) > size)
-      return nullptr;
+      return {};
 
     if (!mp3header->is_tag)
       break;
@@ -112,7 +112,7 @@ mp3_packetizer_c::get_mp3_packet(mp3_header_t *mp3header) {
   if (!m_valid_headers_found) {
     pos = find_consecutive_mp3_headers(m_byte_buffer.get_buffer(), m_byte_buffer.get_size(), 5);
     if (0 > pos)
-      return nullptr;
+      return {};
 
     // Great, we have found five consecutive identical headers. Be happy
     // with those!
@@ -157,13 +157,13 @@ mp3_packetizer_c::get_mp3_packet(mp3_header_t *mp3header) {
     rerender_track_headers();
 
   if (mp3header->framesize > m_byte_buffer.get_size())
-    return nullptr;
+    return {};
 
-  buf = (unsigned char *)safememdup(m_byte_buffer.get_buffer(), mp3header->framesize);
+  auto packet = m_byte_buffer.slice(0, mp3header->framesize);
 
   m_byte_buffer.remove(mp3header->framesize);
 
-  return buf;
+  return packet;
 }
 
 void
@@ -179,17 +179,17 @@ mp3_packetizer_c::set_headers() {
 }
 
 int
-mp3_packetizer_c::process(packet_cptr packet) {
+mp3_packetizer_c::process_impl(packet_cptr packet) {
   m_timestamp_calculator.add_timestamp(packet);
 
-  unsigned char *mp3_packet;
+  memory_cptr mp3_packet;
   mp3_header_t mp3header;
 
   m_byte_buffer.add(packet->data->get_buffer(), packet->data->get_size());
 
   while ((mp3_packet = get_mp3_packet(&mp3header))) {
     auto new_timestamp = m_timestamp_calculator.get_next_timestamp(m_samples_per_frame);
-    auto packet        = std::make_shared<packet_t>(memory_c::clone(mp3_packet, mp3header.framesize), new_timestamp.to_ns(), m_packet_duration);
+    auto packet        = std::make_shared<packet_t>(mp3_packet, new_timestamp.to_ns(), m_packet_duration);
 
     packet->add_extensions(m_packet_extensions);
 
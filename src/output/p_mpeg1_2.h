@@ -31,7 +31,8 @@ public:
   mpeg1_2_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int version, double fps, int width, int height, int dwidth, int dheight, bool framed);
   virtual ~mpeg1_2_video_packetizer_c();
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
+  virtual int64_t get_expected_header_growth() const;
 
   virtual translatable_string_c get_format_name() const {
     return YT("MPEG-1/2");
@@ -58,7 +58,7 @@ public:
   mpeg4_p2_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, double fps, int width, int height, bool input_is_native);
   virtual ~mpeg4_p2_video_packetizer_c();
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
 
   virtual translatable_string_c get_format_name() const {
     return YT("MPEG-4");
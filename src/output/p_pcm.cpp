@@ -91,26 +91,47 @@ pcm_packetizer_c::size_to_samples(int64_t size)
 }
 
 int
-pcm_packetizer_c::process(packet_cptr packet) {
+pcm_packetizer_c::process_impl(packet_cptr packet) {
   if (packet->has_timestamp() && (packet->data->get_size() >= m_min_packet_size))
     return process_packaged(packet);
 
-  m_buffer.add(packet->data->get_buffer(), packet->data->get_size());
+  auto data        = packet->data;
+  auto data_size   = data->get_size();
+  std::size_t used = 0;
 
-  while (m_buffer.get_size() >= m_packet_size) {
-    auto packet = std::make_shared<packet_t>(memory_c::clone(m_buffer.get_buffer(), m_packet_size), m_samples_output * m_s2ts, m_samples_per_packet * m_s2ts);
+  // Only the part completing a packet from data left over from
+  // previous calls has to be copied. Packets lying completely within
+  // the new data reference it instead.
+  if (m_buffer.get_size()) {
+    used = std::min<std::size_t>(m_packet_size - m_buffer.get_size(), data_size);
+    m_buffer.add(data->get_buffer(), used);
 
-    byte_swap_data(*packet->data);
-
-    add_packet(packet);
+    if (m_buffer.get_size() < m_packet_size)
+      return FILE_STATUS_MOREDATA;
 
+    add_pcm_packet(memory_c::clone(m_buffer.get_buffer(), m_packet_size));
     m_buffer.remove(m_packet_size);
-    m_samples_output += m_samples_per_packet;
   }
 
+  for (; (used + m_packet_size) <= data_size; used += m_packet_size)
+    add_pcm_packet(memory_c::slice(data, used, m_packet_size));
+
+  m_buffer.add(data->get_buffer() + used, data_size - used);
+
   return FILE_STATUS_MOREDATA;
 }
 
+void
+pcm_packetizer_c::add_pcm_packet(memory_cptr const &data) {
+  auto packet = std::make_shared<packet_t>(data, m_samples_output * m_s2ts, m_samples_per_packet * m_s2ts);
+
+  byte_swap_data(*packet->data);
+
+  add_packet(packet);
+
+  m_samples_output += m_samples_per_packet;
+}
+
 int
 pcm_packetizer_c::process_packaged(packet_cptr const &packet) {
   auto buffer_size = m_buffer.get_size();
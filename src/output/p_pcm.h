@@ -39,7 +39,7 @@ public:
   pcm_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int p_samples_per_sec, int channels, int bits_per_sample, pcm_format_e format = little_endian_integer);
   virtual ~pcm_packetizer_c();
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -53,4 +53,5 @@ protected:
   virtual int64_t size_to_samples(int64_t size) const;
   virtual int64_t samples_to_size(int64_t size) const;
   virtual void byte_swap_data(memory_c &data) const;
+  virtual void add_pcm_packet(memory_cptr const &data);
 };
@@ -38,7 +38,7 @@ theora_video_packetizer_c::set_headers() {
 }
 
 int
-theora_video_packetizer_c::process(packet_cptr packet) {
+theora_video_packetizer_c::process_impl(packet_cptr packet) {
   if (packet->data->get_size() && (0x00 == (packet->data->get_buffer()[0] & 0x40)))
     packet->bref = VFT_IFRAME;
   else
@@ -46,7 +46,7 @@ theora_video_packetizer_c::process(packet_cptr packet) {
 
   packet->fref   = VFT_NOBFRAME;
 
-  return generic_video_packetizer_c::process(packet);
+  return generic_video_packetizer_c::process_impl(packet);
 }
 
 void
@@ -113,7 +113,7 @@ vc1_video_packetizer_c::add_timestamps_to_parser(packet_cptr &packet) {
 }
 
 int
-vc1_video_packetizer_c::process(packet_cptr packet) {
+vc1_video_packetizer_c::process_impl(packet_cptr packet) {
   add_timestamps_to_parser(packet);
 
   m_parser.add_bytes(packet->data->get_buffer(), packet->data->get_size());
@@ -169,3 +169,10 @@ vc1_video_packetizer_c::can_connect_to(generic_packetizer_c *src,
 
   return CAN_CONNECT_YES;
 }
+
+int64_t
+vc1_video_packetizer_c::get_expected_header_growth()
+  const {
+  // The codec private data is only complete once the sequence and entry point headers have been found.
+  return generic_packetizer_c::get_expected_header_growth() + get_expected_codec_private_growth(256);
+}
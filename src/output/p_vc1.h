@@ -29,7 +29,8 @@ protected:
 public:
   vc1_video_packetizer_c(generic_reader_c *n_reader, track_info_c &n_ti);
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
+  virtual int64_t get_expected_header_growth() const;
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
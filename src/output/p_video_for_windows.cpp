@@ -68,11 +68,11 @@ video_for_windows_packetizer_c::set_headers() {
 }
 
 int
-video_for_windows_packetizer_c::process(packet_cptr packet) {
+video_for_windows_packetizer_c::process_impl(packet_cptr packet) {
   if (m_rederive_frame_types)
     rederive_frame_type(packet);
 
-  return generic_video_packetizer_c::process(packet);
+  return generic_video_packetizer_c::process_impl(packet);
 }
 
 void
@@ -52,7 +52,7 @@ public:
                       unsigned char *d_codecsetup, int l_codecsetup);
   virtual ~vorbis_packetizer_c();
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -39,7 +39,7 @@ vpx_video_packetizer_c::set_headers() {
 }
 
 int
-vpx_video_packetizer_c::process(packet_cptr packet) {
+vpx_video_packetizer_c::process_impl(packet_cptr packet) {
   packet->bref         = ivf::is_keyframe(packet->data, m_codec) ? -1 : m_previous_timestamp;
   m_previous_timestamp = packet->timestamp;
 
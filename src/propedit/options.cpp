@@ -29,9 +29,12 @@ options_c::options_c()
 
 void
 options_c::validate() {
-  if (m_file_name.empty())
+  if (m_file_name.empty() && !is_batch_mode())
     mxerror(Y("No file name given.\n"));
 
+  if (!m_file_name.empty() && is_batch_mode())
+    mxerror(boost::format(Y("A file name ('%1%') cannot be given in batch mode.\n")) % m_file_name);
+
   if (!has_changes())
     mxerror(Y("Nothing to do.\n"));
 
@@ -130,6 +133,19 @@ options_c::set_file_name(const std::string &file_name) {
   m_file_name = file_name;
 }
 
+void
+options_c::set_batch_file_list(std::string const &file_name) {
+  if (file_name.empty())
+    mxerror(Y("The file name for the list of files to process in batch mode is empty.\n"));
+
+  m_batch_file_list = file_name;
+}
+
+bool
+options_c::is_batch_mode() const {
+  return !m_batch_file_list.empty();
+}
+
 void
 options_c::set_parse_mode(const std::string &parse_mode) {
   if (parse_mode == "full")
@@ -24,6 +24,7 @@ public:
   std::vector<target_cptr> m_targets;
   bool m_show_progress;
   kax_analyzer_c::parse_mode_e m_parse_mode;
+  std::string m_batch_file_list;
 
 public:
   options_c();
@@ -38,6 +39,8 @@ public:
   void add_delete_track_statistics_tags(tag_target_c::tag_operation_mode_e operation_mode);
   void set_file_name(const std::string &file_name);
   void set_parse_mode(const std::string &parse_mode);
+  void set_batch_file_list(std::string const &file_name);
+  bool is_batch_mode() const;
   void dump_info() const;
   bool has_changes() const;
 
@@ -16,12 +16,55 @@
 #include <matroska/KaxTracks.h>
 
 #include "common/command_line.h"
+#include "common/json.h"
 #include "common/list_utils.h"
 #include "common/mm_io_x.h"
+#include "common/strings/editing.h"
 #include "common/unique_numbers.h"
 #include "common/version.h"
 #include "propedit/propedit_cli_parser.h"
 
+namespace {
+
+struct batch_file_result_t {
+  std::string m_file_name, m_error;
+  std::vector<std::string> m_warnings;
+  bool m_success{}, m_modified{};
+};
+
+class batch_file_failed_x: public mtx::exception {
+protected:
+  std::string m_message;
+
+public:
+  batch_file_failed_x(std::string const &message)
+    : m_message{message}
+  {
+  }
+  virtual ~batch_file_failed_x() throw() { }
+
+  virtual const char *what() const throw() {
+    return m_message.c_str();
+  }
+};
+
+// The result of the file currently being processed in batch mode;
+// nullptr outside of processing a file.
+batch_file_result_t *s_batch_result{};
+
+class batch_result_guard_c {
+public:
+  batch_result_guard_c(batch_file_result_t &result) {
+    s_batch_result = &result;
+  }
+
+  ~batch_result_guard_c() {
+    s_batch_result = nullptr;
+  }
+};
+
+}
+
 static void
 display_update_element_result(const EbmlCallbacks &callbacks,
                               kax_analyzer_c::update_element_result_e result) {
@@ -106,8 +149,8 @@ write_changes(options_cptr &options,
   }
 }
 
-static void
-run(options_cptr &options) {
+static bool
+process_file(options_cptr &options) {
   console_kax_analyzer_cptr analyzer;
 
   try {
@@ -148,19 +191,143 @@ run(options_cptr &options) {
 
   options->execute(*analyzer);
 
-  if (has_content_been_modified(options)) {
-    mxinfo(Y("The changes are written to the file.\n"));
+  if (!has_content_been_modified(options)) {
+    mxinfo(Y("No changes were made.\n"));
+    return false;
+  }
 
-    write_changes(options, analyzer.get());
+  mxinfo(Y("The changes are written to the file.\n"));
 
-    mxinfo(Y("Done.\n"));
+  write_changes(options, analyzer.get());
 
-  } else
-    mxinfo(Y("No changes were made.\n"));
+  mxinfo(Y("Done.\n"));
+
+  return true;
+}
+
+static void
+run(options_cptr &options) {
+  process_file(options);
 
   mxexit();
 }
 
+static void
+batch_message_handler(unsigned int level,
+                      std::string const &message) {
+  if (!s_batch_result) {
+    mxmsg(level, message);
+    if (MXMSG_ERROR == level)
+      mxexit(2);
+    return;
+  }
+
+  if (MXMSG_WARNING == level)
+    s_batch_result->m_warnings.push_back(strip_copy(message, true));
+
+  else if (MXMSG_ERROR == level)
+    // Aborts processing the current file only.
+    throw batch_file_failed_x{strip_copy(message, true)};
+}
+
+static std::vector<std::string>
+read_batch_file_list(std::string const &list_name) {
+  std::vector<std::string> file_names;
+  std::string line;
+
+  try {
+    if (list_name == "-") {
+      while (std::getline(std::cin, line))
+        file_names.emplace_back(line);
+
+    } else {
+      mm_text_io_c in(new mm_file_io_c(list_name));
+      while (in.getline2(line))
+        file_names.emplace_back(line);
+    }
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % list_name % ex);
+  }
+
+  for (auto &file_name : file_names)
+    strip(file_name, true);
+
+  boost::remove_erase_if(file_names, [](std::string const &file_name) { return file_name.empty(); });
+
+  return file_names;
+}
+
+static void
+process_batch_file(std::vector<std::string> const &args,
+                   batch_file_result_t &result) {
+  batch_result_guard_c guard{result};
+
+  try {
+    // The edit specification is parsed anew for each file as the
+    // targets store the elements of the file they're applied to.
+    auto options = propedit_cli_parser_c{args}.run();
+
+    options->m_batch_file_list.clear();
+    options->m_file_name     = result.m_file_name;
+    options->m_show_progress = false;
+
+    result.m_modified = process_file(options);
+    result.m_success  = true;
+
+  } catch (std::exception &ex) {
+    result.m_error = ex.what();
+  }
+}
+
+static void
+run_batch(std::vector<std::string> const &args,
+          options_cptr const &options) {
+  auto file_names = read_batch_file_list(options->m_batch_file_list);
+  if (file_names.empty())
+    mxerror(boost::format(Y("The list of files to process '%1%' is empty.\n")) % options->m_batch_file_list);
+
+  std::vector<batch_file_result_t> results(file_names.size());
+
+  for (auto idx = 0u; idx < file_names.size(); ++idx)
+    results[idx].m_file_name = file_names[idx];
+
+  set_mxmsg_handler(MXMSG_INFO,    batch_message_handler);
+  set_mxmsg_handler(MXMSG_WARNING, batch_message_handler);
+  set_mxmsg_handler(MXMSG_ERROR,   batch_message_handler);
+
+  // The files are processed one after the other: the message handlers,
+  // the debugging options and other global state are shared by all
+  // files.
+  for (auto &result : results)
+    process_batch_file(args, result);
+
+  auto json_files   = nlohmann::json::array();
+  auto num_failed   = 0u;
+  auto num_warnings = 0u;
+
+  for (auto const &result : results) {
+    json_files.push_back(nlohmann::json{
+      { "file_name", result.m_file_name  },
+      { "success",   result.m_success    },
+      { "modified",  result.m_modified   },
+      { "warnings",  result.m_warnings   },
+      { "error",     result.m_error.empty() ? nlohmann::json{} : nlohmann::json(result.m_error) },
+    });
+
+    num_failed   += result.m_success ? 0 : 1;
+    num_warnings += result.m_warnings.size();
+  }
+
+  mxinfo(boost::format("%1%\n") % mtx::json::dump(nlohmann::json{
+    { "files",      json_files         },
+    { "num_files",  results.size()     },
+    { "num_failed", num_failed         },
+  }, 2));
+
+  mxexit(num_failed ? 2 : num_warnings ? 1 : 0);
+}
+
 static
 void setup(char **argv) {
   mtx_common_init("mkvpropedit", argv[0]);
@@ -178,14 +345,18 @@ main(int argc,
      char **argv) {
   setup(argv);
 
-  options_cptr options = propedit_cli_parser_c(mtx::cli::args_in_utf8(argc, argv)).run();
+  auto args            = mtx::cli::args_in_utf8(argc, argv);
+  options_cptr options = propedit_cli_parser_c(args).run();
 
   if (debugging_c::requested("dump_options")) {
     mxinfo("\nDumping options after parsing the command line\n\n");
     options->dump_info();
   }
 
-  run(options);
+  if (options->is_batch_mode())
+    run_batch(args, options);
+  else
+    run(options);
 
   mxexit();
 }
@@ -199,15 +199,24 @@ propedit_cli_parser_c::set_file_name() {
   m_options->set_file_name(m_current_arg);
 }
 
+void
+propedit_cli_parser_c::set_batch_file_list() {
+  m_options->set_batch_file_list(m_next_arg);
+}
+
 #define OPT(spec, func, description) add_option(spec, std::bind(&propedit_cli_parser_c::func, this), description)
 
 void
 propedit_cli_parser_c::init_parser() {
   add_information(YT("mkvpropedit [options] <file> <actions>"));
+  add_information(YT("mkvpropedit [options] --batch <file-list> <actions>"));
 
   add_section_header(YT("Options"));
   OPT("l|list-property-names",      list_property_names, YT("List all valid property names and exit"));
   OPT("p|parse-mode=<mode>",        set_parse_mode,      YT("Sets the Matroska parser mode to 'fast' (default) or 'full'"));
+  OPT("batch=<file-list>",          set_batch_file_list, YT("Applies the actions to each file listed in 'file-list' (one file name per line; "
+                                                            "'-' reads the list from the standard input) instead of a single file "
+                                                            "and outputs a report in JSON format"));
 
   add_section_header(YT("Actions for handling properties"));
   OPT("e|edit=<selector>",          add_target,          YT("Sets the Matroska file section that all following add/set/delete "
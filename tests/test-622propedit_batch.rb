@@ -0,0 +1,38 @@
+#!/usr/bin/ruby -w
+
+# T_622propedit_batch
+describe "mkvpropedit / batch mode applying the same actions to several files"
+
+test "set the title of two files" do
+  files = (1..2).map { tmp_name }
+  files.each { |file| merge "data/subtitles/srt/ven.srt", :output => file, :no_result => true }
+
+  list = tmp_name
+  File.open(list, "w") { |out| out.puts(files.join("\n")) }
+
+  sys "../src/mkvpropedit --engage no_variable_data --batch #{list} --edit info --set title=batch", :no_result => true
+
+  files.map { |file| identify_json(file)["container"]["properties"]["title"] == "batch" ? "ok" : "failed" }.join("+")
+end
+
+test "continue after a file fails and report each file" do
+  files = (1..3).map { tmp_name }
+  [ files[0], files[2] ].each { |file| merge "data/subtitles/srt/ven.srt", :output => file, :no_result => true }
+  cp "data/subtitles/srt/ven.srt", files[1]
+
+  list = tmp_name
+  File.open(list, "w") { |out| out.puts(files.join("\n")) }
+
+  output, exit_code = sys "../src/mkvpropedit --engage no_variable_data --batch #{list} --edit info --set title=batch", :exit_code => :error, :no_result => true
+  report            = JSON.load(output.drop_while { |line| !%r{^\{}.match(line) }.join(''))
+
+  titles  = [ files[0], files[2] ].map { |file| identify_json(file)["container"]["properties"]["title"] == "batch" ? "ok" : "failed" }
+  results = report["files"].map { |file| "#{file["success"]}/#{file["error"].nil? ? "none" : "error"}" }
+
+  error "the valid files weren't modified: #{titles.join("+")}"        if titles != %w{ok ok}
+  error "unexpected exit code #{exit_code}"                           if exit_code != 2
+  error "unexpected number of failed files #{report["num_failed"]}"   if report["num_failed"] != 1
+  error "unexpected per-file results #{results.join("+")}"            if results != %w{true/none false/error true/none}
+
+  [ titles.join("+"), exit_code_string(exit_code), report["num_failed"], results.join("+") ].join("-")
+end
@@ -0,0 +1,91 @@
+#include "common/common_pch.h"
+
+#include "common/avc_es_parser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using nalus_t = std::vector<std::string>;
+
+// A tiny 32x32 baseline stream: SPS, PPS and an IDR slice followed
+// by two P slices. The slices only contain their headers and a few
+// bytes of filler.
+std::vector<nalus_t> const s_access_units{
+  { std::string{"\x67\x42\xc0\x1e\xda\x25\x90", 7},
+    std::string{"\x68\xce\x3c\x80",             4},
+    std::string{"\x65\x88\x86\x97\x0d\x68\xf2", 7} },
+  { std::string{"\x41\x9a\x34\xb8\x6b\x47\x90", 7} },
+  { std::string{"\x41\x9a\x54\xb8\x6b\x47\x90", 7} },
+};
+
+memory_cptr
+join_nalus(nalus_t const &nalus,
+           bool with_sizes) {
+  std::string buffer;
+
+  for (auto const &nalu : nalus) {
+    buffer += with_sizes ? std::string{"\x00\x00\x00", 3} + static_cast<char>(nalu.size()) : std::string{"\x00\x00\x00\x01", 4};
+    buffer += nalu;
+  }
+
+  return memory_c::clone(buffer);
+}
+
+std::vector<mtx::avc::frame_t>
+parse(bool framed,
+      memory_cptr &avcc) {
+  mtx::avc::es_parser_c parser;
+  std::vector<mtx::avc::frame_t> frames;
+  auto timestamp = int64_t{};
+
+  for (auto const &access_unit : s_access_units) {
+    auto buffer = join_nalus(access_unit, framed);
+
+    parser.add_timestamp(timestamp);
+    timestamp += 40000000;
+
+    if (framed) {
+      parser.add_bytes_framed(buffer, 4);
+      // Packetizers may re-use the packet's memory afterwards.
+      std::memset(buffer->get_buffer(), 0, buffer->get_size());
+
+    } else
+      parser.add_bytes(buffer);
+  }
+
+  parser.flush();
+
+  while (parser.frame_available())
+    frames.push_back(parser.get_frame());
+
+  avcc = parser.get_avcc();
+
+  return frames;
+}
+
+TEST(AvcEsParser, FramedNalusMatchStartCodes) {
+  memory_cptr avcc_start_codes, avcc_framed;
+
+  auto frames_start_codes = parse(false, avcc_start_codes);
+  auto frames_framed      = parse(true,  avcc_framed);
+
+  ASSERT_EQ(3u, frames_start_codes.size());
+  ASSERT_EQ(frames_start_codes.size(), frames_framed.size());
+
+  for (auto idx = 0u; idx < frames_framed.size(); ++idx) {
+    EXPECT_EQ(*frames_start_codes[idx].m_data, *frames_framed[idx].m_data);
+    EXPECT_EQ(frames_start_codes[idx].m_keyframe, frames_framed[idx].m_keyframe);
+    EXPECT_EQ(frames_start_codes[idx].m_start,    frames_framed[idx].m_start);
+    EXPECT_EQ(frames_start_codes[idx].m_end,      frames_framed[idx].m_end);
+  }
+
+  EXPECT_TRUE(frames_framed[0].m_keyframe);
+  EXPECT_FALSE(frames_framed[1].m_keyframe);
+
+  ASSERT_TRUE(!!avcc_start_codes);
+  ASSERT_TRUE(!!avcc_framed);
+  EXPECT_EQ(*avcc_start_codes, *avcc_framed);
+}
+
+}
@@ -74,4 +74,29 @@ TEST(ByteBuffer, Prepend) {
   ASSERT_EQ(std::string{"Hello world"}, s);
 }
 
+TEST(ByteBuffer, Slice) {
+  mtx::bytes::buffer_c b;
+
+  b.add(reinterpret_cast<unsigned char const *>("Hello world"), 11);
+  b.remove(2);
+
+  auto s1 = b.slice(0, 3);
+  auto s2 = b.slice(4, 5);
+
+  EXPECT_EQ(b.get_buffer(), s1->get_buffer());
+  EXPECT_TRUE(*s1 == "llo");
+  EXPECT_TRUE(*s2 == "world");
+
+  b.remove(4);
+  b.prepend(reinterpret_cast<unsigned char const *>("the "), 4);
+  b.add(reinterpret_cast<unsigned char const *>(" is big"), 7);
+  b.trim();
+
+  auto s = std::string{reinterpret_cast<char *>(b.get_buffer()), b.get_size()};
+
+  EXPECT_EQ(std::string{"the world is big"}, s);
+  EXPECT_TRUE(*s1 == "llo");
+  EXPECT_TRUE(*s2 == "world");
+}
+
 }
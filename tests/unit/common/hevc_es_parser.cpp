@@ -0,0 +1,92 @@
+#include "common/common_pch.h"
+
+#include "common/hevc_es_parser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using nalus_t = std::vector<std::string>;
+
+// A tiny 64x64 Main profile stream: VPS, SPS, PPS and an IDR slice
+// followed by two trailing slices. The slices only contain their
+// headers and a few bytes of filler.
+std::vector<nalus_t> const s_access_units{
+  { std::string{"\x40\x01\x0c\x01\xff\xff\x01\x60\x00\x00\x03\x00\x90\x00\x00\x03\x00\x00\x03\x00\x5d\xac\x09", 23},
+    std::string{"\x42\x01\x01\x01\x60\x00\x00\x03\x00\x90\x00\x00\x03\x00\x00\x03\x00\x5d\xa0\x20\x81\x05\x96\xba\xac\x12\xe0\x80", 28},
+    std::string{"\x44\x01\xc0\x71\x81\x12",                 6},
+    std::string{"\x26\x01\xae\x97\x0d\x68\xf2",             7} },
+  { std::string{"\x02\x01\xd0\x0d\x2e\x1a\xd1\xe4",         8} },
+  { std::string{"\x02\x01\xd0\x15\x2e\x1a\xd1\xe4",         8} },
+};
+
+memory_cptr
+join_nalus(nalus_t const &nalus,
+           bool with_sizes) {
+  std::string buffer;
+
+  for (auto const &nalu : nalus) {
+    buffer += with_sizes ? std::string{"\x00\x00\x00", 3} + static_cast<char>(nalu.size()) : std::string{"\x00\x00\x00\x01", 4};
+    buffer += nalu;
+  }
+
+  return memory_c::clone(buffer);
+}
+
+std::vector<mtx::hevc::frame_t>
+parse(bool framed,
+      memory_cptr &hevcc) {
+  mtx::hevc::es_parser_c parser;
+  std::vector<mtx::hevc::frame_t> frames;
+  auto timestamp = int64_t{};
+
+  for (auto const &access_unit : s_access_units) {
+    auto buffer = join_nalus(access_unit, framed);
+
+    parser.add_timestamp(timestamp);
+    timestamp += 40000000;
+
+    if (framed) {
+      parser.add_bytes_framed(buffer, 4);
+      // Packetizers may re-use the packet's memory afterwards.
+      std::memset(buffer->get_buffer(), 0, buffer->get_size());
+
+    } else
+      parser.add_bytes(buffer);
+  }
+
+  parser.flush();
+
+  while (parser.frame_available())
+    frames.push_back(parser.get_frame());
+
+  hevcc = parser.get_hevcc();
+
+  return frames;
+}
+
+TEST(HevcEsParser, FramedNalusMatchStartCodes) {
+  memory_cptr hevcc_start_codes, hevcc_framed;
+
+  auto frames_start_codes = parse(false, hevcc_start_codes);
+  auto frames_framed      = parse(true,  hevcc_framed);
+
+  ASSERT_EQ(3u, frames_start_codes.size());
+  ASSERT_EQ(frames_start_codes.size(), frames_framed.size());
+
+  for (auto idx = 0u; idx < frames_framed.size(); ++idx) {
+    EXPECT_EQ(*frames_start_codes[idx].m_data, *frames_framed[idx].m_data);
+    EXPECT_EQ(frames_start_codes[idx].m_keyframe, frames_framed[idx].m_keyframe);
+    EXPECT_EQ(frames_start_codes[idx].m_start,    frames_framed[idx].m_start);
+    EXPECT_EQ(frames_start_codes[idx].m_end,      frames_framed[idx].m_end);
+  }
+
+  EXPECT_TRUE(frames_framed[0].m_keyframe);
+  EXPECT_FALSE(frames_framed[1].m_keyframe);
+
+  ASSERT_TRUE(!!hevcc_start_codes);
+  ASSERT_TRUE(!!hevcc_framed);
+  EXPECT_EQ(*hevcc_start_codes, *hevcc_framed);
+}
+
+}
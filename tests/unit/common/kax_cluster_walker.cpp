@@ -0,0 +1,175 @@
+#include "common/common_pch.h"
+
+#include "common/kax_cluster_walker.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using bytes_t = std::vector<unsigned char>;
+
+bytes_t
+element(bytes_t const &id,
+        bytes_t const &content) {
+  auto result = id;
+  auto size   = content.size();
+
+  // Always use an eight-byte size so that the content can be of any size.
+  result.push_back(0x01);
+  for (auto shift = 48; shift >= 0; shift -= 8)
+    result.push_back((size >> shift) & 0xff);
+
+  result.insert(result.end(), content.begin(), content.end());
+
+  return result;
+}
+
+bytes_t
+operator +(bytes_t a,
+           bytes_t const &b) {
+  a.insert(a.end(), b.begin(), b.end());
+  return a;
+}
+
+std::string
+to_string(memory_cptr const &mem) {
+  return std::string{reinterpret_cast<char const *>(mem->get_buffer()), mem->get_size()};
+}
+
+bytes_t const s_cluster_id{ 0x1f, 0x43, 0xb6, 0x75 }, s_timestamp_id{ 0xe7 }, s_simple_block_id{ 0xa3 }, s_block_group_id{ 0xa0 },
+  s_block_id{ 0xa1 }, s_block_duration_id{ 0x9b }, s_reference_block_id{ 0xfb }, s_void_id{ 0xec };
+
+TEST(KaxClusterWalker, BlocksAndLacing) {
+  auto data = element(s_cluster_id,
+                        element(s_timestamp_id, { 0x03, 0xe8 })                                                    // 1000
+                      + element(s_void_id, { 0x00, 0x00 })
+                      + element(s_simple_block_id, { 0x81, 0x00, 0x05, 0x80, 'a', 'b', 'c' })                   // track 1, +5, key
+                      + element(s_simple_block_id, { 0x82, 0xff, 0xfe, 0x03, 0x02, 0x01, 0x02, 'd', 'e', 'f', 'g', 'h', 'i' }) // track 2, -2, Xiph lacing, discardable
+                      + element(s_simple_block_id, { 0x82, 0x00, 0x00, 0x06, 0x02, 0x81, 0xc0, 'j', 'k', 'l', 'm', 'n' })       // EBML lacing: 1, 2, 2
+                      + element(s_block_group_id,
+                                  element(s_block_id, { 0x81, 0x00, 0x0a, 0x04, 0x01, 'o', 'p', 'q', 'r' })      // fixed-size lacing: 2, 2
+                                + element(s_block_duration_id, { 0x28 })
+                                + element(s_reference_block_id, { 0xff, 0xf6 })));                                // -10
+
+  mm_mem_io_c in{data.data(), data.size()};
+  kax_cluster_walker_c walker{in};
+  walker.set_timestamp_scale(1000000);
+
+  ASSERT_TRUE(walker.read_cluster());
+  EXPECT_EQ(data.size(), in.getFilePointer());
+  EXPECT_EQ(1000u, walker.get_cluster_timestamp());
+
+  auto &blocks = walker.get_blocks();
+  ASSERT_EQ(4u, blocks.size());
+
+  EXPECT_TRUE(blocks[0].m_simple_block);
+  EXPECT_TRUE(blocks[0].m_key);
+  EXPECT_FALSE(blocks[0].m_discardable);
+  EXPECT_EQ(1u, blocks[0].m_track_number);
+  EXPECT_EQ(1005000000, blocks[0].m_timestamp);
+  ASSERT_EQ(1u, blocks[0].m_frames.size());
+  EXPECT_EQ("abc", to_string(blocks[0].m_frames[0]));
+
+  EXPECT_FALSE(blocks[1].m_key);
+  EXPECT_TRUE(blocks[1].m_discardable);
+  EXPECT_EQ(2u, blocks[1].m_track_number);
+  EXPECT_EQ(998000000, blocks[1].m_timestamp);
+  ASSERT_EQ(3u, blocks[1].m_frames.size());
+  EXPECT_EQ("d",   to_string(blocks[1].m_frames[0]));
+  EXPECT_EQ("ef",  to_string(blocks[1].m_frames[1]));
+  EXPECT_EQ("ghi", to_string(blocks[1].m_frames[2]));
+
+  ASSERT_EQ(3u, blocks[2].m_frames.size());
+  EXPECT_EQ("j",  to_string(blocks[2].m_frames[0]));
+  EXPECT_EQ("kl", to_string(blocks[2].m_frames[1]));
+  EXPECT_EQ("mn", to_string(blocks[2].m_frames[2]));
+
+  EXPECT_FALSE(blocks[3].m_simple_block);
+  EXPECT_EQ(1010000000, blocks[3].m_timestamp);
+  ASSERT_EQ(2u, blocks[3].m_frames.size());
+  EXPECT_EQ("op", to_string(blocks[3].m_frames[0]));
+  EXPECT_EQ("qr", to_string(blocks[3].m_frames[1]));
+  ASSERT_TRUE(!!blocks[3].m_duration);
+  EXPECT_EQ(40u, *blocks[3].m_duration);
+  ASSERT_EQ(1u, blocks[3].m_references.size());
+  EXPECT_EQ(-10, blocks[3].m_references[0]);
+}
+
+TEST(KaxClusterWalker, SkipsPayloadsOfFilteredTracks) {
+  auto data = element(s_cluster_id,
+                        element(s_timestamp_id, { 0x00 })
+                      + element(s_simple_block_id, { 0x81, 0x00, 0x01, 0x80, 'a', 'b' })
+                      + element(s_simple_block_id, { 0x82, 0x00, 0x02, 0x80, 'c', 'd', 'e' })
+                      + element(s_block_group_id,
+                                  element(s_block_id, { 0x82, 0x00, 0x03, 0x00, 'f' })
+                                + element(s_block_duration_id, { 0x28 }))
+                      + element(s_simple_block_id, { 0x81, 0x00, 0x04, 0x80, 'g' }));
+
+  mm_mem_io_c in{data.data(), data.size()};
+  kax_cluster_walker_c walker{in};
+  walker.set_track_filter([](uint64_t track_number) { return track_number != 2; });
+
+  ASSERT_TRUE(walker.read_cluster());
+  EXPECT_EQ(data.size(), in.getFilePointer());
+  EXPECT_EQ(4u, walker.get_num_bytes_skipped());
+
+  auto &blocks = walker.get_blocks();
+  ASSERT_EQ(4u, blocks.size());
+
+  EXPECT_FALSE(blocks[0].m_payload_skipped);
+  ASSERT_EQ(1u, blocks[0].m_frames.size());
+  EXPECT_EQ("ab", to_string(blocks[0].m_frames[0]));
+
+  EXPECT_TRUE(blocks[1].m_payload_skipped);
+  EXPECT_EQ(2u, blocks[1].m_track_number);
+  EXPECT_EQ(2000000, blocks[1].m_timestamp);
+  EXPECT_TRUE(blocks[1].m_frames.empty());
+
+  EXPECT_TRUE(blocks[2].m_payload_skipped);
+  EXPECT_FALSE(blocks[2].m_simple_block);
+  EXPECT_EQ(3000000, blocks[2].m_timestamp);
+  EXPECT_TRUE(blocks[2].m_frames.empty());
+
+  ASSERT_EQ(1u, blocks[3].m_frames.size());
+  EXPECT_EQ("g", to_string(blocks[3].m_frames[0]));
+}
+
+TEST(KaxClusterWalker, LeavesOtherElementsAlone) {
+  auto data = element(s_void_id, { 0x00 })
+            + element(s_cluster_id, element(s_timestamp_id, { 0x00 }));
+
+  mm_mem_io_c in{data.data(), data.size()};
+  kax_cluster_walker_c walker{in};
+
+  EXPECT_FALSE(walker.read_cluster());
+  EXPECT_EQ(0u, in.getFilePointer());
+
+  in.setFilePointer(10);
+
+  EXPECT_TRUE(walker.read_cluster());
+  EXPECT_EQ(data.size(), in.getFilePointer());
+  EXPECT_TRUE(walker.get_blocks().empty());
+}
+
+TEST(KaxClusterWalker, RestoresPositionForDamagedClusters) {
+  // The simple block claims to be larger than the cluster.
+  auto data = element(s_cluster_id, element(s_timestamp_id, { 0x00 }) + bytes_t{ 0xa3, 0x90, 0x81, 0x00, 0x00, 0x80 });
+
+  mm_mem_io_c in{data.data(), data.size()};
+  kax_cluster_walker_c walker{in};
+
+  EXPECT_FALSE(walker.read_cluster());
+  EXPECT_EQ(0u, in.getFilePointer());
+  EXPECT_TRUE(walker.get_blocks().empty());
+
+  // Blocks before the cluster timestamp cannot be handled either.
+  data = element(s_cluster_id, element(s_simple_block_id, { 0x81, 0x00, 0x00, 0x80, 'a' }) + element(s_timestamp_id, { 0x00 }));
+
+  mm_mem_io_c in2{data.data(), data.size()};
+  kax_cluster_walker_c walker2{in2};
+
+  EXPECT_FALSE(walker2.read_cluster());
+  EXPECT_EQ(0u, in2.getFilePointer());
+}
+
+}
@@ -33,6 +33,14 @@ TEST(Math, IntLog2) {
   EXPECT_EQ(63, mtx::math::int_log2(0x8000001230000000ull));
 }
 
+TEST(Math, RoundUp) {
+  EXPECT_EQ(0,    mtx::math::round_up(0,    4096));
+  EXPECT_EQ(4096, mtx::math::round_up(1,    4096));
+  EXPECT_EQ(4096, mtx::math::round_up(4096, 4096));
+  EXPECT_EQ(8192, mtx::math::round_up(4097, 4096));
+  EXPECT_EQ(15,   mtx::math::round_up(13,   5));
+}
+
 TEST(Math, ToSigned) {
   unsigned char big_endian_signed_numbers[] = {
     0x83,                                           // 0
@@ -30,4 +30,40 @@ TEST(Memory, OperatorNotEq) {
   EXPECT_TRUE(*m1 != "world");
 }
 
+TEST(Memory, Slice) {
+  auto m1 = memory_c::clone("hello world");
+  auto m2 = memory_c::slice(m1, 6, 5);
+
+  EXPECT_TRUE(m2->is_slice());
+  EXPECT_FALSE(m1->is_slice());
+  EXPECT_TRUE(*m2 == "world");
+  EXPECT_EQ(m1->get_buffer() + 6, m2->get_buffer());
+
+  m1.reset();
+
+  EXPECT_TRUE(*m2 == "world");
+
+  auto buffer = m2->get_buffer();
+  m2->grab();
+
+  EXPECT_EQ(buffer, m2->get_buffer());
+
+  m2->resize(6);
+
+  EXPECT_FALSE(m2->is_slice());
+  EXPECT_NE(buffer, m2->get_buffer());
+  EXPECT_EQ(0, std::memcmp(m2->get_buffer(), "world", 5));
+}
+
+TEST(Memory, SliceOfBorrowedMemory) {
+  unsigned char data[] = "hello";
+  auto m1 = std::make_shared<memory_c>(data, 5, false);
+  auto m2 = memory_c::slice(m1, 1, 3);
+
+  data[1] = 'a';
+
+  EXPECT_TRUE(m1->is_allocated());
+  EXPECT_TRUE(*m2 == "ell");
+}
+
 }
@@ -1,12 +1,129 @@
 #include "common/common_pch.h"
 
+#include <random>
+
 #include "gtest/gtest.h"
 #include "tests/unit/util.h"
 
 #include "common/mm_io_x.h"
+#include "common/mm_multi_file_io.h"
+#include "common/mm_read_buffer_io.h"
 
 namespace {
 
+// Exposes whether or not the background thread is reading ahead.
+class mm_multi_file_io_test_c: public mm_multi_file_io_c {
+public:
+  using mm_multi_file_io_c::mm_multi_file_io_c;
+
+  bool is_reading_ahead() const {
+    return m_read_ahead_running;
+  }
+};
+
+// Writes a set of numbered files whose sizes don't line up with the
+// read-ahead blocks. Reading ahead only starts after the first block
+// of 1 MiB, therefore the files can't be much smaller.
+class MmMultiFileIo: public ::testing::Test {
+protected:
+  bfs::path m_directory;
+  std::vector<bfs::path> m_file_names;
+  std::string m_content;
+
+  virtual void SetUp() override {
+    m_directory = bfs::temp_directory_path() / bfs::unique_path("mtx-unit-test-%%%%-%%%%-%%%%");
+    bfs::create_directories(m_directory);
+
+    std::minstd_rand generator;
+
+    for (auto size : std::vector<std::size_t>{ 700000, 1500000, 1, 0, 1300000 }) {
+      std::string data(size, '\0');
+      for (auto &c : data)
+        c = static_cast<char>(generator());
+
+      m_file_names.emplace_back(m_directory / (boost::format("part-%1%.bin") % (m_file_names.size() + 1)).str());
+      mm_file_io_c{m_file_names.back().string(), MODE_CREATE}.write(data);
+
+      m_content += data;
+    }
+  }
+
+  virtual void TearDown() override {
+    mm_multi_file_io_c::set_read_ahead_size(8 * 1024 * 1024);
+
+    boost::system::error_code ec;
+    bfs::remove_all(m_directory, ec);
+  }
+
+  std::string read(mm_io_c &in,
+                   std::size_t size) {
+    std::string buffer;
+    in.read(buffer, size);
+    return buffer;
+  }
+};
+
+TEST_F(MmMultiFileIo, SequentialReadAcrossFiles) {
+  auto in = mm_multi_file_io_c::open_multi(m_file_names.front().string());
+  std::string content;
+
+  ASSERT_EQ(m_file_names.size(), static_cast<mm_multi_file_io_c &>(*in).get_file_names().size());
+  EXPECT_EQ(m_content.size(), in->get_size());
+
+  while (!in->eof()) {
+    auto num_read = in->read(content, 99991, content.size());
+    ASSERT_NE(0u, num_read);
+  }
+
+  EXPECT_EQ(m_content.size(), content.size());
+  EXPECT_TRUE(m_content == content);
+  EXPECT_EQ(0u, in->read(content, 1, content.size()));
+}
+
+TEST_F(MmMultiFileIo, BackwardSeekWhileReadingAhead) {
+  // A window smaller than the files so that blocks are dropped and read
+  // again after seeking.
+  mm_multi_file_io_c::set_read_ahead_size(2 * 1024 * 1024);
+
+  mm_multi_file_io_test_c in{m_file_names, m_file_names.front().string()};
+
+  // Reading ahead starts with the first read past the first block.
+  ASSERT_TRUE(m_content.substr(0, 1200000) == read(in, 1200000));
+  EXPECT_FALSE(in.is_reading_ahead());
+  ASSERT_TRUE(m_content.substr(1200000, 1800000) == read(in, 1800000));
+  EXPECT_TRUE(in.is_reading_ahead());
+
+  in.setFilePointer(300000);
+  EXPECT_TRUE(in.is_reading_ahead());
+  EXPECT_TRUE(m_content.substr(300000, 1000000) == read(in, 1000000));
+
+  in.setFilePointer(2200000);
+  EXPECT_TRUE(m_content.substr(2200000, 5) == read(in, 5));
+
+  in.setFilePointer(-100000, seek_current);
+  EXPECT_TRUE(m_content.substr(2100005) == read(in, m_content.size()));
+  EXPECT_TRUE(in.eof());
+}
+
+TEST_F(MmMultiFileIo, ReadAfterReleasingFileHandle) {
+  mm_multi_file_io_test_c in{m_file_names, m_file_names.front().string()};
+
+  ASSERT_TRUE(m_content.substr(0,       1100000) == read(in, 1100000));
+  ASSERT_TRUE(m_content.substr(1100000, 1000)    == read(in, 1000));
+  EXPECT_TRUE(in.is_reading_ahead());
+
+  in.release_file_handle();
+  EXPECT_FALSE(in.is_reading_ahead());
+  EXPECT_EQ(1101000u, in.getFilePointer());
+
+  EXPECT_TRUE(m_content.substr(1101000) == read(in, m_content.size()));
+  EXPECT_TRUE(in.is_reading_ahead());
+
+  in.release_file_handle();
+  in.setFilePointer(650000);
+  EXPECT_TRUE(m_content.substr(650000, 100000) == read(in, 100000));
+}
+
 TEST(MmIo, Slurp) {
   memory_cptr m;
 
@@ -16,4 +133,136 @@ TEST(MmIo, Slurp) {
   ASSERT_THROW(mm_file_io_c::slurp("doesnotexist"), mtx::mm_io::exception);
 }
 
+TEST(MmOnDemandFileIo, ReleaseAndReopen) {
+  mm_on_demand_file_io_c in{"tests/unit/data/text/chunky_bacon.txt"};
+  unsigned char buffer[6];
+
+  EXPECT_TRUE(in.is_open());
+  EXPECT_EQ(13, in.get_size());
+  ASSERT_EQ(6u, in.read(buffer, 6));
+  EXPECT_EQ(std::string{"Chunky"}, std::string(reinterpret_cast<char *>(buffer), 6));
+
+  in.release_file_handle();
+  EXPECT_FALSE(in.is_open());
+  EXPECT_EQ(6u, in.getFilePointer());
+  EXPECT_EQ(13, in.get_size());
+
+  in.setFilePointer(1, seek_current);
+  EXPECT_FALSE(in.is_open());
+
+  ASSERT_EQ(5u, in.read(buffer, 5));
+  EXPECT_TRUE(in.is_open());
+  EXPECT_EQ(std::string{"Bacon"}, std::string(reinterpret_cast<char *>(buffer), 5));
+  EXPECT_EQ(12u, in.getFilePointer());
+
+  EXPECT_EQ(1u, in.read(buffer, 6));
+  EXPECT_TRUE(in.eof());
+}
+
+TEST(MmReadBufferIo, ReleaseFileHandleKeepsPosition) {
+  auto file = new mm_on_demand_file_io_c{"tests/unit/data/text/chunky_bacon.txt"};
+  mm_read_buffer_io_c in{file, 4};
+  unsigned char buffer[5];
+
+  ASSERT_EQ(2u, in.read(buffer, 2));
+  in.release_file_handle();
+  EXPECT_FALSE(file->is_open());
+  EXPECT_EQ(2u, in.getFilePointer());
+
+  in.setFilePointer(7);
+  ASSERT_EQ(5u, in.read(buffer, 5));
+  EXPECT_EQ(std::string{"Bacon"}, std::string(reinterpret_cast<char *>(buffer), 5));
+  EXPECT_TRUE(file->is_open());
+}
+
+TEST(MmTextIo, Lines) {
+  std::string content{"line 1\nline 2\n\nline 4"};
+  mm_text_io_c in(new mm_mem_io_c(reinterpret_cast<unsigned char const *>(content.c_str()), content.length()));
+  std::vector<std::string> lines;
+  std::string line;
+
+  while (in.getline2(line))
+    lines.push_back(line);
+
+  ASSERT_EQ(4u, lines.size());
+  EXPECT_EQ("line 1", lines[0]);
+  EXPECT_EQ("line 2", lines[1]);
+  EXPECT_EQ("",       lines[2]);
+  EXPECT_EQ("line 4", lines[3]);
+  EXPECT_TRUE(in.eof());
+}
+
+TEST(MmTextIo, TrailingNewline) {
+  std::string content{"line 1\nline 2\n"};
+  mm_text_io_c in(new mm_mem_io_c(reinterpret_cast<unsigned char const *>(content.c_str()), content.length()));
+  std::vector<std::string> lines;
+  std::string line;
+
+  while (in.getline2(line))
+    lines.push_back(line);
+
+  ASSERT_EQ(2u, lines.size());
+  EXPECT_EQ("line 1", lines[0]);
+  EXPECT_EQ("line 2", lines[1]);
+  EXPECT_TRUE(in.eof());
+
+  in.setFilePointer(0);
+  EXPECT_FALSE(in.eof());
+  EXPECT_EQ("line 1", in.getline());
+  EXPECT_EQ("line 2", in.getline());
+  EXPECT_THROW(in.getline(), mtx::mm_io::end_of_file_x);
+}
+
+TEST(MmTextIo, CarriageReturnsAndFilePosition) {
+  std::string content{"\xef\xbb\xbf" "a\r\nbc\r\n\r\nd"};
+  mm_text_io_c in(new mm_mem_io_c(reinterpret_cast<unsigned char const *>(content.c_str()), content.length()));
+
+  EXPECT_EQ(BO_UTF8, in.get_byte_order());
+  EXPECT_EQ("a",  in.getline());
+  EXPECT_EQ(6u,   in.getFilePointer());
+  EXPECT_EQ("bc", in.getline());
+  EXPECT_EQ("",   in.getline());
+  EXPECT_EQ("d",  in.getline());
+
+  in.setFilePointer(0);
+  EXPECT_EQ(3u,   in.getFilePointer());
+  EXPECT_EQ("a",  in.getline());
+}
+
+TEST(MmTextIo, MaximumNumberOfCharacters) {
+  std::string content{"\xef\xbb\xbf" "\xc3\xa4\xc3\xb6\xc3\xbc\n"};
+  mm_text_io_c in(new mm_mem_io_c(reinterpret_cast<unsigned char const *>(content.c_str()), content.length()));
+
+  EXPECT_EQ("\xc3\xa4\xc3\xb6", in.getline(2));
+  EXPECT_EQ("\xc3\xbc",         in.getline());
+}
+
+TEST(MmTextIo, Utf16) {
+  unsigned char const content[] = { 0xff, 0xfe, 'A', 0x00, 0x3d, 0xd8, 0x00, 0xde, '\r', 0x00, '\n', 0x00, 'B', 0x00 };
+  mm_text_io_c in(new mm_mem_io_c(content, sizeof(content)));
+
+  EXPECT_EQ(BO_UTF16_LE,          in.get_byte_order());
+  EXPECT_EQ("A\xf0\x9f\x98\x80", in.getline());
+  EXPECT_EQ(12u,                  in.getFilePointer());
+  EXPECT_EQ("B",                  in.getline());
+}
+
+TEST(MmTextIo, LinesSpanningReadBuffers) {
+  std::string content;
+  for (auto idx = 0; idx < 50000; ++idx)
+    content += (boost::format("line number %1%\r\n") % idx).str();
+
+  mm_text_io_c in(new mm_mem_io_c(reinterpret_cast<unsigned char const *>(content.c_str()), content.length()));
+  std::string line;
+
+  for (auto idx = 0; idx < 50000; ++idx) {
+    ASSERT_TRUE(in.getline2(line));
+    ASSERT_EQ((boost::format("line number %1%") % idx).str(), line);
+  }
+
+  EXPECT_EQ(content.length(), in.getFilePointer());
+  EXPECT_TRUE(in.eof());
+  EXPECT_FALSE(in.getline2(line));
+}
+
 }
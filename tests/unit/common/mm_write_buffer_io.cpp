@@ -0,0 +1,53 @@
+#include "common/common_pch.h"
+
+#include "common/mm_write_buffer_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string
+content_of(mm_mem_io_c &mem) {
+  return std::string(reinterpret_cast<char const *>(mem.get_buffer()), mem.get_size());
+}
+
+TEST(MmWriteBufferIo, BackgroundWrites) {
+  mm_mem_io_c mem{nullptr, 0, 16};
+  mm_write_buffer_io_c out{&mem, 4, false};
+
+  out.enable_background_writes(true);
+
+  out.puts("Chunky");
+  EXPECT_EQ(6u, out.getFilePointer());
+
+  out.puts(" Bacon and more");
+  EXPECT_EQ(21u, out.getFilePointer());
+
+  out.setFilePointer(0);
+  out.puts("Funky");
+  out.setFilePointer(0, seek_end);
+  EXPECT_EQ(21u, out.getFilePointer());
+
+  out.puts("!");
+  out.flush();
+
+  EXPECT_EQ(std::string{"Funkyy Bacon and more!"}, content_of(mem));
+}
+
+TEST(MmWriteBufferIo, DisablingBackgroundWritesFlushes) {
+  mm_mem_io_c mem{nullptr, 0, 16};
+  mm_write_buffer_io_c out{&mem, 8, false};
+
+  out.enable_background_writes(true);
+  out.puts("0123456789");
+  out.enable_background_writes(false);
+
+  EXPECT_EQ(std::string{"0123456789"}, content_of(mem));
+
+  out.puts("ab");
+  out.flush();
+
+  EXPECT_EQ(std::string{"0123456789ab"}, content_of(mem));
+}
+
+}
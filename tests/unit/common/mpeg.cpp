@@ -0,0 +1,59 @@
+#include "common/common_pch.h"
+
+#include "common/mpeg.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Mpeg, FindStartCodePrefix) {
+  unsigned char const buffer[] = { 0x47, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0xba, 0x00, 0x00, 0x01 };
+  auto end                     = buffer + sizeof(buffer);
+
+  EXPECT_EQ(buffer + 4, mtx::mpeg::find_start_code_prefix(buffer,     end));
+  EXPECT_EQ(buffer + 4, mtx::mpeg::find_start_code_prefix(buffer + 4, end));
+  EXPECT_EQ(buffer + 8, mtx::mpeg::find_start_code_prefix(buffer + 5, end));
+  EXPECT_EQ(end,        mtx::mpeg::find_start_code_prefix(buffer + 9, end));
+  EXPECT_EQ(buffer + 6, mtx::mpeg::find_start_code_prefix(buffer,     buffer + 6));
+}
+
+TEST(Mpeg, FindStartCodePrefixAfterOneByte) {
+  unsigned char const buffer[] = { 0x00, 0x01, 0x00, 0x00, 0x01 };
+  auto end                     = buffer + sizeof(buffer);
+
+  EXPECT_EQ(buffer + 2, mtx::mpeg::find_start_code_prefix(buffer, end));
+  EXPECT_EQ(buffer,     mtx::mpeg::find_start_code_prefix(buffer, buffer));
+}
+
+
+TEST(Mpeg, ForEachFramedNalu) {
+  unsigned char const bytes[] = {
+    0x00, 0x02, 0x41, 0x42,             // NALU at offset 0
+    0x00, 0x03, 0x43, 0x00, 0x00,       // trailing zero bytes are removed
+    0x00, 0x00,                         // empty NALU
+    0x00, 0x01, 0x44,                   // NALU at offset 11
+    0x00, 0x05, 0x45,                   // truncated
+  };
+  auto buffer = memory_c::clone(bytes, sizeof(bytes));
+  std::vector<std::pair<memory_cptr, uint64_t>> nalus;
+
+  mtx::mpeg::for_each_framed_nalu(buffer, 2, [&nalus](memory_cptr const &nalu, uint64_t offset) {
+    nalus.emplace_back(nalu, offset);
+  });
+
+  ASSERT_EQ(3u, nalus.size());
+
+  EXPECT_EQ(0u,  nalus[0].second);
+  EXPECT_EQ(4u,  nalus[1].second);
+  EXPECT_EQ(11u, nalus[2].second);
+
+  EXPECT_EQ(std::string{"AB"}, nalus[0].first->to_string());
+  EXPECT_EQ(std::string{"C"},  nalus[1].first->to_string());
+  EXPECT_EQ(std::string{"D"},  nalus[2].first->to_string());
+
+  // The NALUs refer to the buffer's memory instead of copies.
+  EXPECT_TRUE(nalus[0].first->is_slice());
+  EXPECT_EQ(buffer->get_buffer() + 2, nalus[0].first->get_buffer());
+}
+
+}
@@ -0,0 +1,62 @@
+#include "common/common_pch.h"
+
+#include "common/profiling.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using namespace mtx::profiling;
+
+TEST(Profiling, Counters) {
+  enable();
+
+  auto counter = get_counter("stage", "scope");
+
+  ASSERT_NE(nullptr, counter);
+  EXPECT_EQ(counter, get_counter("stage", "scope"));
+  EXPECT_NE(counter, get_counter("stage", "other scope"));
+  EXPECT_NE(counter, get_counter("other stage", "scope"));
+  EXPECT_EQ(std::string{"stage"}, counter->m_stage);
+  EXPECT_EQ(std::string{"scope"}, counter->m_scope);
+}
+
+TEST(Profiling, NestedScopes) {
+  enable();
+
+  auto outer = get_counter("nested: outer");
+  auto inner = get_counter("nested: inner");
+
+  {
+    scope_c outer_scope{outer};
+    scope_c unprofiled_scope{nullptr};
+
+    {
+      scope_c inner_scope{inner};
+    }
+    {
+      scope_c inner_scope{inner};
+    }
+  }
+
+  EXPECT_EQ(1, outer->m_num_calls.load());
+  EXPECT_EQ(2, inner->m_num_calls.load());
+  EXPECT_EQ(inner->m_total_ns.load(), inner->m_self_ns.load());
+  EXPECT_EQ(outer->m_total_ns.load(), outer->m_self_ns.load() + inner->m_total_ns.load());
+}
+
+TEST(Profiling, RecursiveScopes) {
+  enable();
+
+  auto counter = get_counter("recursive");
+
+  {
+    scope_c outer_scope{counter};
+    scope_c inner_scope{counter};
+  }
+
+  EXPECT_EQ(2, counter->m_num_calls.load());
+  EXPECT_EQ(counter->m_total_ns.load(), counter->m_self_ns.load());
+}
+
+}
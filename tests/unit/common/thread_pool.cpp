@@ -0,0 +1,51 @@
+#include "common/common_pch.h"
+
+#include <atomic>
+
+#include "common/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(ThreadPool, RunsAllJobs) {
+  std::atomic<int> sum{0};
+  std::vector<std::future<void>> results;
+
+  {
+    mtx::thread_pool_c pool{4};
+
+    EXPECT_EQ(4u, pool.get_num_threads());
+
+    for (auto idx = 1; idx <= 100; ++idx)
+      results.emplace_back(pool.enqueue([&sum, idx]() { sum += idx; }));
+
+    for (auto &result : results)
+      result.get();
+  }
+
+  EXPECT_EQ(5050, sum);
+}
+
+TEST(ThreadPool, PropagatesExceptions) {
+  mtx::thread_pool_c pool{1};
+
+  auto result = pool.enqueue([]() { throw std::runtime_error{"failure"}; });
+
+  EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+TEST(ThreadPool, FinishesQueuedJobsOnDestruction) {
+  std::atomic<int> num_run{0};
+
+  {
+    mtx::thread_pool_c pool{2};
+
+    for (auto idx = 0; idx < 50; ++idx)
+      pool.enqueue([&num_run]() { ++num_run; });
+  }
+
+  EXPECT_EQ(50, num_run);
+}
+
+}
@@ -0,0 +1,68 @@
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+#include "common/xml/element_reader.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::string>
+read_pieces(std::string const &document,
+            std::string &root_name) {
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(document.c_str()), document.size()};
+  mtx::xml::element_reader_c reader{in};
+  mtx::xml::element_reader_c::piece_t piece;
+  std::vector<std::string> pieces;
+
+  reader.read_root(piece);
+  root_name = reader.get_root_name();
+  pieces.push_back(piece.m_content);
+
+  while (reader.read_next_child(piece))
+    pieces.push_back(piece.m_content);
+
+  return pieces;
+}
+
+TEST(XmlElementReader, Splitting) {
+  auto document = std::string{"\xef\xbb\xbf<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                              "<!DOCTYPE Tags SYSTEM \"matroskatags.dtd\">\n"
+                              "<Tags>\n"
+                              "  <Tag><Simple><Name>a&gt;b</Name><!-- </Tag> --><String><![CDATA[</Tags>]]></String></Simple></Tag>\n"
+                              "  <?pi </Tags> ?>\n"
+                              "  <Tag attribute='>'/>\n"
+                              "</Tags>\n"};
+  std::string root_name;
+
+  auto pieces = read_pieces(document, root_name);
+
+  EXPECT_EQ("Tags", root_name);
+  ASSERT_EQ(3u, pieces.size());
+  EXPECT_EQ("<Tags/>", pieces[0]);
+  EXPECT_EQ("<Tag><Simple><Name>a&gt;b</Name><!-- </Tag> --><String><![CDATA[</Tags>]]></String></Simple></Tag>", pieces[1]);
+  EXPECT_EQ("<Tag attribute='>'/>", pieces[2]);
+}
+
+TEST(XmlElementReader, Errors) {
+  std::string root_name;
+
+  EXPECT_THROW(read_pieces("",                          root_name), mtx::xml::xml_parser_x);
+  EXPECT_THROW(read_pieces("<Tags><Tag>",               root_name), mtx::xml::xml_parser_x);
+  EXPECT_THROW(read_pieces("<Tags><Tag/></Chapters>",   root_name), mtx::xml::xml_parser_x);
+  EXPECT_THROW(read_pieces("<Tags><!-- <Tag/></Tags>", root_name), mtx::xml::xml_parser_x);
+}
+
+TEST(XmlElementReader, IsSupported) {
+  auto is_supported = [](std::string const &document) {
+    mm_mem_io_c in{reinterpret_cast<unsigned char const *>(document.c_str()), document.size()};
+    return mtx::xml::element_reader_c::is_supported(in);
+  };
+
+  EXPECT_TRUE(is_supported("<?xml version=\"1.0\" encoding=\"UTF-8\"?><Tags/>"));
+  EXPECT_TRUE(is_supported("\xef\xbb\xbf<Tags/>"));
+  EXPECT_FALSE(is_supported("<?xml version=\"1.0\" encoding=\"ISO-8859-15\"?><Tags/>"));
+  EXPECT_FALSE(is_supported(std::string{"\xff\xfe<\0T\0", 6}));
+}
+
+}
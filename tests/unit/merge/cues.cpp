@@ -0,0 +1,94 @@
+#include "common/common_pch.h"
+
+#include "merge/cues.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<cue_point_t>
+read_all(cue_point_column_c const &column) {
+  std::vector<cue_point_t> points;
+  cue_point_t point;
+  auto reader = column.get_reader();
+
+  while (reader.next(point))
+    points.push_back(point);
+
+  return points;
+}
+
+TEST(CuePointColumn, AddingAndReading) {
+  cue_point_column_c column{2};
+
+  column.add({ 0,           40000000, 1000,        2, 0   });
+  column.add({ 1000000000,  40000000, 1000,        2, 123 });
+  column.add({ 2000000000,  0,        12345678901, 2, 456 });
+
+  EXPECT_EQ(3u, column.get_num_points());
+  EXPECT_TRUE(column.is_sorted());
+
+  auto points = read_all(column);
+
+  ASSERT_EQ(3u, points.size());
+
+  EXPECT_EQ(0u,           points[0].timestamp);
+  EXPECT_EQ(40000000u,    points[0].duration);
+  EXPECT_EQ(1000u,        points[0].cluster_position);
+  EXPECT_EQ(2u,           points[0].track_num);
+  EXPECT_EQ(0u,           points[0].relative_position);
+
+  EXPECT_EQ(1000000000u,  points[1].timestamp);
+  EXPECT_EQ(123u,         points[1].relative_position);
+
+  EXPECT_EQ(2000000000u,  points[2].timestamp);
+  EXPECT_EQ(0u,           points[2].duration);
+  EXPECT_EQ(12345678901u, points[2].cluster_position);
+  EXPECT_EQ(456u,         points[2].relative_position);
+}
+
+TEST(CuePointColumn, SortingUnsortedTimestamps) {
+  cue_point_column_c column{1};
+
+  column.add({ 3000, 0, 100, 1, 1 });
+  column.add({ 1000, 0, 100, 1, 2 });
+  column.add({ 2000, 0, 200, 1, 3 });
+  column.add({ 1000, 0, 200, 1, 4 });
+
+  EXPECT_FALSE(column.is_sorted());
+
+  column.sort();
+
+  EXPECT_TRUE(column.is_sorted());
+
+  auto points = read_all(column);
+
+  ASSERT_EQ(4u, points.size());
+
+  EXPECT_EQ(1000u, points[0].timestamp);
+  EXPECT_EQ(2u,    points[0].relative_position);
+  EXPECT_EQ(1000u, points[1].timestamp);
+  EXPECT_EQ(4u,    points[1].relative_position);
+  EXPECT_EQ(2000u, points[2].timestamp);
+  EXPECT_EQ(3000u, points[3].timestamp);
+}
+
+TEST(CuePointColumn, AdjustingPositions) {
+  cue_point_column_c column{1};
+
+  column.add({ 1000, 0, 100, 1, 0 });
+  column.add({ 2000, 0, 200, 1, 0 });
+  column.add({ 3000, 0, 300, 1, 0 });
+
+  column.adjust_positions(200, 50);
+
+  auto points = read_all(column);
+
+  ASSERT_EQ(3u, points.size());
+
+  EXPECT_EQ(100u, points[0].cluster_position);
+  EXPECT_EQ(250u, points[1].cluster_position);
+  EXPECT_EQ(350u, points[2].cluster_position);
+}
+
+}
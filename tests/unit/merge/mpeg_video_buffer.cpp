@@ -0,0 +1,97 @@
+#include "common/common_pch.h"
+
+#include "mpegparser/MPEGVideoBuffer.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Garbage before the first start code is skipped. Start codes other
+// than sequence, GOP and picture start codes (here: a sequence
+// extension and slices) don't start new chunks.
+std::string const s_garbage{"\x12\x34", 2};
+std::vector<std::string> const s_chunks{
+  std::string{"\x00\x00\x01\xb3\x14\x00\xf0\x13\xff\xff\xe0\x18" "\x00\x00\x01\xb5\x14\x8a\x00\x01\x00\x00", 22},
+  std::string{"\x00\x00\x01\xb8\x00\x08\x00\x40",                                                          8},
+  std::string{"\x00\x00\x01\x00\x00\x0f\xff\xf8" "\x00\x00\x01\x01\x11\x22\x33\x44\x55",                   17},
+  std::string{"\x00\x00\x01\x00\x00\x57\xff\xf8" "\x00\x00\x01\x01\x66\x77\x88",                           15},
+};
+std::vector<uint8_t> const s_types{ MPEG_VIDEO_SEQUENCE_START_CODE, MPEG_VIDEO_GOP_START_CODE, MPEG_VIDEO_PICTURE_START_CODE, MPEG_VIDEO_PICTURE_START_CODE };
+
+std::string
+get_stream() {
+  return s_garbage + boost::accumulate(s_chunks, std::string{});
+}
+
+std::string
+chunk_content(MPEGChunk &chunk) {
+  return std::string(reinterpret_cast<char const *>(chunk.GetPointer()), chunk.GetSize());
+}
+
+void
+feed(MPEGVideoBuffer &buffer,
+     std::string const &data) {
+  ASSERT_EQ(0, buffer.Feed(reinterpret_cast<binary *>(const_cast<char *>(data.data())), data.size()));
+}
+
+TEST(MPEGVideoBuffer, ChunksFromSmallWrites) {
+  auto stream = get_stream();
+
+  for (auto write_size : std::vector<std::size_t>{ 1, 2, 3, 5, 7, 11 }) {
+    // The buffer is smaller than the stream so that the unread data
+    // has to be moved. The chunks are kept alive while doing so.
+    MPEGVideoBuffer buffer{40};
+    std::vector<std::shared_ptr<MPEGChunk>> chunks;
+
+    for (auto offset = 0u; offset < stream.size(); offset += write_size) {
+      feed(buffer, stream.substr(offset, write_size));
+
+      while (buffer.GetState() == MPEG2_BUFFER_STATE_CHUNK_READY)
+        chunks.emplace_back(buffer.ReadChunk());
+    }
+
+    EXPECT_EQ(s_chunks.size() - 1, chunks.size()) << "write size " << write_size;
+
+    buffer.ForceFinal();
+    chunks.emplace_back(buffer.ReadChunk());
+
+    ASSERT_EQ(s_chunks.size(), chunks.size()) << "write size " << write_size;
+
+    for (auto idx = 0u; idx < chunks.size(); ++idx) {
+      ASSERT_TRUE(!!chunks[idx]);
+      EXPECT_EQ(s_types[idx],  chunks[idx]->GetType())       << "write size " << write_size << " chunk " << idx;
+      EXPECT_EQ(s_chunks[idx], chunk_content(*chunks[idx])) << "write size " << write_size << " chunk " << idx;
+    }
+
+    EXPECT_EQ(nullptr, buffer.ReadChunk());
+  }
+}
+
+TEST(MPEGVideoBuffer, StartCodeSplitAcrossWrites) {
+  auto stream    = get_stream();
+  auto gop_start = s_garbage.size() + s_chunks[0].size();
+
+  // Split the GOP start code ending the first chunk after each of its
+  // first three bytes.
+  for (auto split = gop_start + 1; split < gop_start + 4; ++split) {
+    MPEGVideoBuffer buffer{64};
+
+    feed(buffer, stream.substr(0, split));
+
+    EXPECT_EQ(MPEG2_BUFFER_STATE_NEED_MORE_DATA, buffer.GetState()) << "split at " << split;
+    EXPECT_EQ(nullptr, buffer.ReadChunk());
+
+    feed(buffer, stream.substr(split, gop_start + 8 - split));
+
+    ASSERT_EQ(MPEG2_BUFFER_STATE_CHUNK_READY, buffer.GetState()) << "split at " << split;
+
+    std::unique_ptr<MPEGChunk> chunk{buffer.ReadChunk()};
+
+    ASSERT_TRUE(!!chunk);
+    EXPECT_EQ(MPEG_VIDEO_SEQUENCE_START_CODE, chunk->GetType());
+    EXPECT_EQ(s_chunks[0],                    chunk_content(*chunk));
+    EXPECT_EQ(MPEG2_BUFFER_STATE_NEED_MORE_DATA, buffer.GetState());
+  }
+}
+
+}
@@ -0,0 +1,45 @@
+#include "common/common_pch.h"
+
+#include "merge/mux_server.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(MuxServer, ParseJobArray) {
+  auto job = mux_server_job_t{};
+  job.m_id = 42;
+
+  parse_mux_server_job("[\"-o\", \"out.mkv\", \"in.mp4\"]", job);
+
+  EXPECT_EQ(42, job.m_id.get<int>());
+  EXPECT_EQ((std::vector<std::string>{ "-o", "out.mkv", "in.mp4" }), job.m_args);
+}
+
+TEST(MuxServer, ParseJobObject) {
+  auto job = mux_server_job_t{};
+  job.m_id = 1;
+
+  parse_mux_server_job("{ \"id\": \"episode-1\", \"arguments\": [\"-o\", \"out.mkv\", \"in.mp4\"] }", job);
+
+  EXPECT_EQ("episode-1", job.m_id.get<std::string>());
+  EXPECT_EQ((std::vector<std::string>{ "-o", "out.mkv", "in.mp4" }), job.m_args);
+
+  parse_mux_server_job("{ \"arguments\": [\"in.mp4\"] }", job);
+
+  EXPECT_EQ("episode-1", job.m_id.get<std::string>());
+  EXPECT_EQ(std::vector<std::string>{ "in.mp4" }, job.m_args);
+}
+
+TEST(MuxServer, ParseJobInvalid) {
+  auto job = mux_server_job_t{};
+
+  EXPECT_THROW(parse_mux_server_job("[\"-o\", ",                    job), mux_server_job_failed_x);
+  EXPECT_THROW(parse_mux_server_job("[]",                           job), mux_server_job_failed_x);
+  EXPECT_THROW(parse_mux_server_job("[\"-o\", 42]",                 job), mux_server_job_failed_x);
+  EXPECT_THROW(parse_mux_server_job("{ \"id\": 1 }",                job), mux_server_job_failed_x);
+  EXPECT_THROW(parse_mux_server_job("{ \"arguments\": \"in.mp4\" }", job), mux_server_job_failed_x);
+  EXPECT_THROW(parse_mux_server_job("\"in.mp4\"",                   job), mux_server_job_failed_x);
+}
+
+}
@@ -0,0 +1,73 @@
+#include "common/common_pch.h"
+
+#include "merge/progress.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+progress_statistics_c::sample_t
+sample(int64_t time_ms,
+       int64_t bytes_read,
+       int64_t bytes_written,
+       int64_t num_packets,
+       int percentage) {
+  auto result            = progress_statistics_c::sample_t{};
+  result.m_time_ms       = time_ms;
+  result.m_bytes_read    = bytes_read;
+  result.m_bytes_written = bytes_written;
+  result.m_num_packets   = num_packets;
+  result.m_percentage    = percentage;
+
+  return result;
+}
+
+TEST(ProgressStatistics, NoSamples) {
+  progress_statistics_c stats;
+
+  EXPECT_EQ(0u, stats.get_num_samples());
+  EXPECT_EQ(0,  stats.get_elapsed_ms());
+  EXPECT_FALSE(stats.get_remaining_ms());
+  EXPECT_EQ(0.0, stats.get_read_rate());
+  EXPECT_EQ(0.0, stats.get_average_read_rate());
+}
+
+TEST(ProgressStatistics, RatesAndRemainingTime) {
+  progress_statistics_c stats;
+
+  stats.add_sample(sample(1000, 0, 0, 0, 0));
+  EXPECT_FALSE(stats.get_remaining_ms());
+
+  stats.add_sample(sample(3000, 4000, 2000, 100, 20));
+
+  EXPECT_EQ(2000, stats.get_elapsed_ms());
+  EXPECT_EQ(2000, stats.get_read_rate());
+  EXPECT_EQ(1000, stats.get_write_rate());
+  EXPECT_EQ(50,   stats.get_packet_rate());
+  ASSERT_TRUE(!!stats.get_remaining_ms());
+  EXPECT_EQ(8000, *stats.get_remaining_ms());
+
+  // The current rates are smoothed while the averages aren't.
+  stats.add_sample(sample(4000, 4000, 2000, 100, 40));
+
+  EXPECT_LT(0.0,  stats.get_read_rate());
+  EXPECT_GT(2000, stats.get_read_rate());
+  EXPECT_DOUBLE_EQ(4000.0 / 3, stats.get_average_read_rate());
+  EXPECT_DOUBLE_EQ(2000.0 / 3, stats.get_average_write_rate());
+  EXPECT_EQ(4500, *stats.get_remaining_ms());
+
+  stats.add_sample(sample(5000, 8000, 4000, 200, 100));
+
+  EXPECT_EQ(0, *stats.get_remaining_ms());
+}
+
+TEST(ProgressStatistics, FormatForGUI) {
+  progress_statistics_c stats;
+
+  stats.add_sample(sample(0,    0,    0,    0,   0));
+  stats.add_sample(sample(1000, 2048, 1024, 25, 50));
+
+  EXPECT_EQ(std::string{"#GUI#progress_statistics#elapsed=1000#bytes_read=2048#bytes_written=1024#packets=25#read_rate=2048#write_rate=1024#packet_rate=25#remaining=1000"}, stats.format_for_gui());
+}
+
+}